@@ -0,0 +1,212 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// multi-threaded variant of autoecho.cpp: each thread runs its own
+// io_service, fibers (server, sessions and clients) are stolen between the
+// threads; measures the echo round trips per second
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include <boost/fiber/all.hpp>
+
+#include "../barrier.hpp"
+#include "work_stealing.hpp"
+#include "yield.hpp"
+
+using boost::asio::ip::tcp;
+
+typedef std::shared_ptr< boost::asio::io_service >  io_service_ptr;
+typedef std::shared_ptr< tcp::socket >              socket_ptr;
+typedef std::chrono::steady_clock                   clock_type;
+
+const std::size_t max_length = 64;
+
+// io_service of the thread the fiber started on
+static thread_local io_service_ptr io_svc;
+
+/*****************************************************************************
+*   termination
+*****************************************************************************/
+// counts server and session fibers
+static std::atomic< std::size_t > running{ 0 };
+static boost::fibers::mutex mtx;
+static boost::fibers::condition_variable_any cnd;
+static bool fini{ false };
+
+void finished() {
+    if ( 1 == running.fetch_sub( 1) ) {
+        std::unique_lock< boost::fibers::mutex > lk( mtx);
+        lk.unlock();
+        cnd.notify_all();
+    }
+}
+
+/*****************************************************************************
+*   fiber function per server connection
+*****************************************************************************/
+void session( socket_ptr sock) {
+    char data[max_length];
+    for (;;) {
+        boost::system::error_code ec;
+        std::size_t length = sock->async_read_some(
+                boost::asio::buffer( data),
+                boost::fibers::asio::yield[ec]);
+        if ( ec) {
+            break; // eof or error
+        }
+        boost::asio::async_write(
+                * sock,
+                boost::asio::buffer( data, length),
+                boost::fibers::asio::yield[ec]);
+        if ( ec) {
+            break;
+        }
+    }
+    finished();
+}
+
+/*****************************************************************************
+*   listening server
+*****************************************************************************/
+void server( tcp::acceptor & a) {
+    for (;;) {
+        // the socket is bound to the io_service of the thread the
+        // server fiber currently runs on
+        socket_ptr socket( new tcp::socket( * io_svc) );
+        boost::system::error_code ec;
+        a.async_accept(
+                * socket,
+                boost::fibers::asio::yield[ec]);
+        if ( ec) {
+            break; // acceptor closed
+        }
+        ++running;
+        boost::fibers::fiber( session, socket).detach();
+    }
+    finished();
+}
+
+/*****************************************************************************
+*   fiber function per client
+*****************************************************************************/
+void client( tcp::endpoint const& ep, std::size_t iterations) {
+    tcp::socket s( * io_svc);
+    boost::system::error_code ec;
+    s.async_connect( ep, boost::fibers::asio::yield[ec]);
+    if ( ec) {
+        throw boost::system::system_error( ec);
+    }
+    char msg[max_length] = { 'x' };
+    char reply[max_length];
+    for ( std::size_t i = 0; i < iterations; ++i) {
+        boost::asio::async_write(
+                s,
+                boost::asio::buffer( msg),
+                boost::fibers::asio::yield[ec]);
+        if ( ec) {
+            throw boost::system::system_error( ec);
+        }
+        boost::asio::async_read(
+                s,
+                boost::asio::buffer( reply),
+                boost::fibers::asio::yield[ec]);
+        if ( ec) {
+            throw boost::system::system_error( ec);
+        }
+    }
+}
+
+/*****************************************************************************
+*   worker thread
+*****************************************************************************/
+void thread( std::size_t max_idx, std::size_t idx, barrier * b) {
+    io_svc = std::make_shared< boost::asio::io_service >();
+    boost::fibers::use_scheduling_algorithm< boost::fibers::asio::work_stealing >(
+            io_svc, max_idx, idx, true);
+    b->wait();
+    // the main fiber of this thread sleeps till all fibers are done,
+    // meanwhile the dispatcher runs the io_service and steals fibers
+    std::unique_lock< boost::fibers::mutex > lk( mtx);
+    cnd.wait( lk, [](){ return fini; });
+}
+
+/*****************************************************************************
+*   main
+*****************************************************************************/
+int main( int argc, char* argv[]) {
+    try {
+        std::size_t threads = 4;
+        std::size_t clients = 100;
+        std::size_t iterations = 1000;
+        if ( 1 < argc) {
+            threads = std::strtoul( argv[1], nullptr, 10);
+        }
+        if ( 2 < argc) {
+            clients = std::strtoul( argv[2], nullptr, 10);
+        }
+        if ( 3 < argc) {
+            iterations = std::strtoul( argv[3], nullptr, 10);
+        }
+        std::size_t max_idx = threads - 1;
+        io_svc = std::make_shared< boost::asio::io_service >();
+        boost::fibers::use_scheduling_algorithm< boost::fibers::asio::work_stealing >(
+                io_svc, max_idx, max_idx, true);
+        barrier b( threads);
+        std::vector< std::thread > workers;
+        for ( std::size_t idx = 0; idx < max_idx; ++idx) {
+            workers.emplace_back( thread, max_idx, idx, & b);
+        }
+        b.wait();
+        tcp::acceptor a( * io_svc, tcp::endpoint( tcp::v4(), 0) );
+        tcp::endpoint ep( boost::asio::ip::address_v4::loopback(), a.local_endpoint().port() );
+        ++running;
+        // the acceptor is bound to this thread's io_service; its completion
+        // handlers run on this thread, even if the server fiber was stolen
+        boost::fibers::fiber srv( server, std::ref( a) );
+        clock_type::time_point start = clock_type::now();
+        std::vector< boost::fibers::fiber > fibers;
+        for ( std::size_t i = 0; i < clients; ++i) {
+            fibers.emplace_back( client, std::cref( ep), iterations);
+        }
+        for ( boost::fibers::fiber & f : fibers) {
+            f.join();
+        }
+        clock_type::duration duration = clock_type::now() - start;
+        // aborts the pending async_accept()
+        a.close();
+        srv.join();
+        {
+            std::unique_lock< boost::fibers::mutex > lk( mtx);
+            cnd.wait( lk, [](){ return 0 == running.load(); });
+            fini = true;
+        }
+        cnd.notify_all();
+        for ( std::thread & t : workers) {
+            t.join();
+        }
+        std::uint64_t total = clients * iterations;
+        std::uint64_t ms = std::chrono::duration_cast< std::chrono::milliseconds >( duration).count();
+        std::cout << threads << " threads, " << clients << " clients: "
+                  << total << " round trips in " << ms << " ms ("
+                  << ( 0 < ms ? total * 1000 / ms : total) << " round trips/s)" << std::endl;
+        std::cout << "done." << std::endl;
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    }
+    return EXIT_FAILURE;
+}
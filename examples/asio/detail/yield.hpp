@@ -16,7 +16,10 @@
 
 #include <boost/fiber/all.hpp>
 
-#include <mutex>                    // std::unique_lock
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
 
 #ifdef BOOST_HAS_ABI_HEADERS
 #  include BOOST_ABI_PREFIX
@@ -28,29 +31,80 @@ namespace asio {
 namespace detail {
 
 //[fibers_asio_yield_completion
-// Bundle a completion bool flag with a spinlock to protect it.
+// Completion flag shared by the waiting fiber and the completion handler.
+// No lock is required: whichever side comes second observes the state
+// written by the other one. A fiber that suspended in wait() is resumed
+// by the handler only after it has been switched out: a handler running on
+// the same thread can not run before, a handler running on another thread
+// passes the fiber through the remote ready-queue, which is drained by the
+// fiber's own thread.
 struct yield_completion {
-    typedef fibers::detail::spinlock    mutex_t;
-    typedef std::unique_lock< mutex_t > lock_t;
+    enum state_t {
+        init,       // neither wait() nor the handler has been called
+        waiting,    // fiber suspended in wait()
+        complete    // handler has been called
+    };
 
-    mutex_t mtx_{};
-    bool    completed_{ false };
+    std::atomic< state_t >  state_{ init };
 
     void wait() {
-        // yield_handler_base::operator()() will set completed_ true and
-        // attempt to wake a suspended fiber. It would be Bad if that call
-        // happened between our detecting (! completed_) and suspending.
-        lock_t lk{ mtx_ };
-        // If completed_ is already set, we're done here: don't suspend.
-        if ( ! completed_) {
-            // suspend(unique_lock<spinlock>) unlocks the lock in the act of
-            // resuming another fiber
-            fibers::context::active()->suspend( lk);
+        state_t expected = init;
+        // If the handler has already been called, we're done here: don't
+        // suspend.
+        if ( state_.compare_exchange_strong( expected, waiting,
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_acquire) ) {
+            // the handler resumes this fiber
+            fibers::context::active()->suspend();
         }
+        BOOST_ASSERT( complete == state_.load( std::memory_order_acquire) );
+    }
+
+    // returns true if a fiber is suspended in wait()
+    bool set_complete() noexcept {
+        return waiting == state_.exchange( complete, std::memory_order_acq_rel);
     }
 };
 //]
 
+//[fibers_asio_handler_memory
+// asio allocates each asynchronous operation, including a copy of the
+// handler, via the asio_handler_allocate() hook. The originating fiber
+// waits till the operation has completed, so a slot owned by the
+// async_result<> on the fiber's stack can be reused by successive
+// (intermediate) operations. Allocations larger than the slot or made
+// while it is in use fall back to operator new.
+class handler_memory {
+public:
+    static constexpr std::size_t    size = 512;
+
+    handler_memory() = default;
+
+    handler_memory( handler_memory const&) = delete;
+    handler_memory & operator=( handler_memory const&) = delete;
+
+    void * allocate( std::size_t n) {
+        if ( ! in_use_ && size >= n) {
+            in_use_ = true;
+            return & storage_;
+        }
+        return ::operator new( n);
+    }
+
+    void deallocate( void * p) noexcept {
+        if ( & storage_ == p) {
+            in_use_ = false;
+        } else {
+            ::operator delete( p);
+        }
+    }
+
+private:
+    typename std::aligned_storage< size >::type storage_;
+    bool                                        in_use_{ false };
+};
+//]
+
 //[fibers_asio_yield_handler_base
 // This class encapsulates common elements between yield_handler<T> (capturing
 // a value to return from asio async function) and yield_handler<void> (no
@@ -77,20 +131,20 @@ public:
         BOOST_ASSERT_MSG( yt_.ec_,
                           "Must inject boost::system::error_code* "
                           "before calling yield_handler_base::operator()()");
-        // If originating fiber is busy testing completed_ flag, wait until it
-        // has observed (! completed_).
-        yield_completion::lock_t lk{ ycomp_->mtx_ };
-        // Notify a subsequent yield_completion::wait() call that it need not
-        // suspend.
-        ycomp_->completed_ = true;
         // set the error_code bound by yield_t
         * yt_.ec_ = ec;
-        // If ctx_ is still active, e.g. because the async operation
-        // immediately called its callback (this method!) before the asio
-        // async function called async_result_base::get(), we must not set it
-        // ready.
-        if ( fibers::context::active() != ctx_ ) {
-            // wake the fiber
+        // Notify a subsequent yield_completion::wait() call that it need not
+        // suspend. If the fiber is still active, e.g. because the async
+        // operation immediately called its callback (this method!) before
+        // the asio async function called async_result_base::get(), we must
+        // not resume it. Once set_complete() returned, *ycomp_ might
+        // already be gone.
+        if ( ycomp_->set_complete() ) {
+            // Never switch to the fiber from inside the handler: it runs
+            // within io_service::poll()/run_one(), called by the scheduler
+            // adapter; let the scheduler pick the fiber up. set_ready()
+            // uses the remote ready-queue if the handler runs on another
+            // thread.
             fibers::context::active()->set_ready( ctx_);
         }
     }
@@ -101,6 +155,8 @@ public:
     // We depend on this pointer to yield_completion, which will be injected
     // by async_result.
     yield_completion            *   ycomp_{ nullptr };
+    // handler memory owned by async_result, injected as well
+    handler_memory              *   hmem_{ nullptr };
 };
 //]
 
@@ -170,15 +226,33 @@ void asio_handler_invoke( Fn fn, yield_handler< T > * h) {
         fn();
 }
 
+//[fibers_asio_handler_alloc
+// Handler allocation hooks: serve the operation memory from the slot
+// owned by async_result<> instead of the heap.
+template< typename T >
+void * asio_handler_allocate( std::size_t size, yield_handler< T > * h) {
+    BOOST_ASSERT_MSG( h->hmem_,
+                      "Must inject handler_memory* "
+                      "before the operation is initiated");
+    return h->hmem_->allocate( size);
+}
+
+template< typename T >
+void asio_handler_deallocate( void * p, std::size_t, yield_handler< T > * h) {
+    h->hmem_->deallocate( p);
+}
+//]
+
 //[fibers_asio_async_result_base
 // Factor out commonality between async_result<yield_handler<T>> and
 // async_result<yield_handler<void>>
 class async_result_base {
 public:
     explicit async_result_base( yield_handler_base & h) {
-        // Inject ptr to our yield_completion instance into this
-        // yield_handler<>.
+        // Inject ptr to our yield_completion and handler_memory instances
+        // into this yield_handler<>.
         h.ycomp_ = & this->ycomp_;
+        h.hmem_ = & this->hmem_;
         // if yield_t didn't bind an error_code, make yield_handler_base's
         // error_code* point to an error_code local to this object so
         // yield_handler_base::operator() can unconditionally store through
@@ -206,6 +280,8 @@ private:
     // async_result_base owns the yield_completion because, unlike
     // yield_handler<>, async_result<> is only instantiated once.
     yield_completion                ycomp_{};
+    // memory for the operation (and the copy of the handler it contains)
+    handler_memory                  hmem_{};
 };
 //]
 
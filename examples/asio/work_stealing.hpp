@@ -0,0 +1,290 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_ASIO_WORK_STEALING_H
+#define BOOST_FIBERS_ASIO_WORK_STEALING_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/assert.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/config.hpp>
+
+#include <boost/fiber/algo/algorithm.hpp>
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/context_spmc_queue.hpp>
+#include <boost/fiber/scheduler.hpp>
+#include <boost/fiber/type.hpp>
+
+#include "yield.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace asio {
+
+// Each thread runs its own io_service; the io_service is driven by the
+// dispatcher context of the thread's fiber manager, fibers are stolen
+// between the threads.
+// Completion handlers run inside the dispatcher context: a handler
+// resuming a fiber of this thread enqueues it directly via awakened(),
+// a fiber owned by another thread is passed through that thread's remote
+// ready-queue and notify() posts a wakeup to its io_service.
+class work_stealing : public algo::algorithm {
+private:
+    typedef scheduler::ready_queue_t                        lqueue_t;
+
+    // per-thread state visible to the other threads; it is kept alive
+    // after the thread terminated so that a thief never accesses a
+    // destroyed queue or io_service
+    struct peer {
+        fibers::detail::context_spmc_queue              rqueue{};
+        std::shared_ptr< boost::asio::io_service >      io_svc;
+        // thread blocks in io_service::run_one()
+        std::atomic_bool                                idle{ false };
+        // a wakeup handler is pending
+        std::atomic_bool                                notified{ false };
+
+        peer( std::shared_ptr< boost::asio::io_service > const& io_svc_) :
+            io_svc( io_svc_) {
+        }
+
+        void wakeup() noexcept {
+            // at most one wakeup handler is pending at a time
+            if ( ! notified.exchange( true, std::memory_order_acq_rel) ) {
+                io_svc->post([this](){
+                    notified.store( false, std::memory_order_release);
+                });
+            }
+        }
+    };
+
+    typedef std::shared_ptr< peer >                         peer_ptr;
+
+    // maximal number of fibers picked before the dispatcher
+    // is resumed to run ready completion handlers
+    static constexpr std::size_t                    max_picks = 32;
+
+    std::shared_ptr< boost::asio::io_service >      io_svc_;
+    boost::asio::steady_timer                       suspend_timer_;
+    std::size_t                                     idx_;
+    std::size_t                                     max_idx_;
+    peer_ptr                                        self_;
+    lqueue_t                                        lqueue_{};
+    std::size_t                                     counter_{ 0 };
+    bool                                            suspend_;
+
+    static std::vector< peer_ptr > & peers_() {
+        static std::vector< peer_ptr > peers;
+        return peers;
+    }
+
+    // number of threads blocked in io_service::run_one()
+    static std::atomic< std::size_t > & idle_() {
+        static std::atomic< std::size_t > idle{ 0 };
+        return idle;
+    }
+
+    static void init_( std::size_t max_idx) {
+        peers_().resize( max_idx + 1);
+    }
+
+    peer_ptr peer_( std::size_t idx) const noexcept {
+        return std::atomic_load( & peers_()[idx]);
+    }
+
+    void poll_() noexcept {
+        // completion handlers must not throw
+        boost::system::error_code ec;
+        io_svc_->poll( ec);
+    }
+
+    context * steal_() noexcept {
+        if ( 0 == max_idx_) {
+            return nullptr;
+        }
+        static thread_local std::minstd_rand generator;
+        std::size_t idx = 0;
+        do {
+            idx = std::uniform_int_distribution< std::size_t >{ 0, max_idx_ }( generator);
+        } while ( idx == idx_);
+        peer_ptr victim = peer_( idx);
+        return nullptr != victim ? victim->rqueue.pop() : nullptr;
+    }
+
+    bool work_available_() const noexcept {
+        for ( std::size_t idx = 0; idx <= max_idx_; ++idx) {
+            peer_ptr p = peer_( idx);
+            if ( nullptr != p && ! p->rqueue.empty() ) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void wakeup_thief_() noexcept {
+        // pairs with the fence in suspend_until(): either the idle thread
+        // sees the pushed context or we see its idle flag
+        std::atomic_thread_fence( std::memory_order_seq_cst);
+        if ( 0 == idle_().load( std::memory_order_relaxed) ) {
+            return;
+        }
+        for ( std::size_t idx = 0; idx <= max_idx_; ++idx) {
+            peer_ptr p = peer_( idx);
+            if ( nullptr != p && idx != idx_ && p->idle.load( std::memory_order_relaxed) ) {
+                p->wakeup();
+                return;
+            }
+        }
+    }
+
+public:
+    struct service : public boost::asio::io_service::service {
+        static boost::asio::io_service::id                  id;
+
+        std::unique_ptr< boost::asio::io_service::work >    work_;
+
+        service( boost::asio::io_service & io_svc) :
+            boost::asio::io_service::service( io_svc),
+            work_{ new boost::asio::io_service::work( io_svc) } {
+        }
+
+        virtual ~service() {}
+
+        service( service const&) = delete;
+        service & operator=( service const&) = delete;
+
+        void shutdown_service() override final {
+            work_.reset();
+        }
+    };
+
+    // max_idx + 1 threads take part in work stealing, idx identifies the
+    // calling thread; each thread must pass its own io_service
+    // if suspend is false, an idle thread polls its io_service and
+    // continues stealing; otherwise it blocks in io_service::run_one()
+    // till a completion handler, a sleep deadline, notify() or another
+    // thread having fibers to steal wakes it
+    work_stealing( std::shared_ptr< boost::asio::io_service > const& io_svc,
+                   std::size_t max_idx, std::size_t idx, bool suspend = false) :
+        io_svc_( io_svc),
+        suspend_timer_( * io_svc_),
+        idx_{ idx },
+        max_idx_{ max_idx },
+        self_{ std::make_shared< peer >( io_svc) },
+        suspend_{ suspend } {
+        BOOST_ASSERT( idx_ <= max_idx_);
+        // throws service_already_exists if the io_service is already
+        // used by another scheduler
+        boost::asio::add_service( * io_svc_, new service( * io_svc_) );
+        static std::once_flag flag;
+        std::call_once( flag, & work_stealing::init_, max_idx_);
+        std::atomic_store( & peers_()[idx_], self_);
+    }
+
+    work_stealing( work_stealing const&) = delete;
+    work_stealing & operator=( work_stealing const&) = delete;
+
+    void awakened( context * ctx) noexcept {
+        BOOST_ASSERT( nullptr != ctx);
+        if ( ! ctx->is_context( type::pinned_context) ) {
+            ctx->detach();
+            self_->rqueue.push( ctx);
+            if ( suspend_) {
+                wakeup_thief_();
+            }
+        } else {
+            ctx->ready_link( lqueue_);
+        }
+    }
+
+    context * pick_next() noexcept {
+        context * ctx = nullptr;
+        if ( context::active()->is_context( type::dispatcher_context) ) {
+            // the dispatcher holds no lock: run the completion handlers
+            // that are ready; resumed fibers are enqueued by awakened()
+            counter_ = 0;
+            poll_();
+        } else if ( max_picks <= ++counter_ && ! lqueue_.empty() ) {
+            // prefer the pinned contexts (the dispatcher among them) from
+            // time to time, otherwise a busy thread never runs its handlers
+            counter_ = 0;
+            ctx = & lqueue_.front();
+            lqueue_.pop_front();
+            return ctx;
+        }
+        ctx = self_->rqueue.pop();
+        if ( nullptr != ctx) {
+            context::active()->attach( ctx);
+        } else if ( ! lqueue_.empty() ) {
+            ctx = & lqueue_.front();
+            lqueue_.pop_front();
+        } else {
+            ctx = steal_();
+            if ( nullptr != ctx) {
+                context::active()->attach( ctx);
+            }
+        }
+        return ctx;
+    }
+
+    bool has_ready_fibers() const noexcept {
+        return ! self_->rqueue.empty() || ! lqueue_.empty();
+    }
+
+    void suspend_until( std::chrono::steady_clock::time_point const& abs_time) noexcept {
+        if ( ! suspend_) {
+            // return to the dispatcher, which polls again and tries to steal
+            return;
+        }
+        // set a timer so that run_one() returns at the latest at abs_time
+        // only re-arm if the deadline has changed, re-arming cancels the
+        // pending wait and would wake run_one() immediately
+        if ( (std::chrono::steady_clock::time_point::max)() != abs_time &&
+             suspend_timer_.expires_at() != abs_time) {
+            suspend_timer_.expires_at( abs_time);
+            suspend_timer_.async_wait([](boost::system::error_code const&){});
+        }
+        self_->idle.store( true, std::memory_order_relaxed);
+        idle_().fetch_add( 1, std::memory_order_relaxed);
+        std::atomic_thread_fence( std::memory_order_seq_cst);
+        boost::system::error_code ec;
+        if ( ! work_available_() ) {
+            io_svc_->run_one( ec);
+        }
+        idle_().fetch_sub( 1, std::memory_order_relaxed);
+        self_->idle.store( false, std::memory_order_relaxed);
+        // run the remaining handlers that became ready meanwhile
+        io_svc_->poll( ec);
+    }
+
+    void notify() noexcept {
+        // a context has been pushed to the remote ready-queue (or the
+        // scheduler shuts down): unblock run_one()
+        if ( suspend_) {
+            self_->wakeup();
+        }
+    }
+};
+
+boost::asio::io_service::id work_stealing::service::id;
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_ASIO_WORK_STEALING_H
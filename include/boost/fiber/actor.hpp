@@ -0,0 +1,208 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_ACTOR_H
+#define BOOST_FIBERS_ACTOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <system_error>
+#include <utility>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/intrusive_ptr.hpp>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/mailbox.hpp>
+#include <boost/fiber/exceptions.hpp>
+#include <boost/fiber/fixedsize_stack.hpp>
+#include <boost/fiber/operations.hpp>
+#include <boost/fiber/policy.hpp>
+#include <boost/fiber/scheduler.hpp>
+#include <boost/fiber/scheduler_handle.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+// a fiber processing the messages sent to its mailbox one after another
+// sending is lock-free (one atomic exchange), the actor is only woken up
+// if it waits for messages
+template< typename T >
+class actor {
+public:
+    typedef T                                       value_type;
+    typedef std::function< void( value_type &&) >   handler_type;
+
+    // maximal number of messages processed before the actor yields
+    static constexpr std::size_t                    default_batch = 64;
+
+private:
+    struct node : public detail::mailbox_node {
+        value_type  value;
+
+        template< typename ... Args >
+        node( Args && ... args) :
+            value( std::forward< Args >( args) ... ) {
+        }
+    };
+
+    detail::mailbox                 mailbox_{};
+    // pushed by close(), terminates the actor
+    detail::mailbox_node            close_node_{};
+    std::atomic< bool >             closed_{ false };
+    handler_type                    fn_;
+    std::size_t                     batch_;
+    context                     *   ctx_{ nullptr };
+    intrusive_ptr< context >        impl_{};
+
+    void push_( detail::mailbox_node * n) noexcept {
+        if ( mailbox_.push( n) ) {
+            // the actor waits for messages
+            context::active()->set_ready( ctx_);
+        }
+    }
+
+    void run_() {
+        ctx_ = context::active();
+        for (;;) {
+            std::size_t count = 0;
+            detail::mailbox_node * n = nullptr;
+            // process a batch of messages
+            while ( count < batch_ && nullptr != ( n = mailbox_.pop() ) ) {
+                if ( & close_node_ == n) {
+                    return;
+                }
+                std::unique_ptr< node > msg{ static_cast< node * >( n) };
+                fn_( std::move( msg->value) );
+                ++count;
+            }
+            if ( batch_ == count) {
+                // let other fibers run
+                this_fiber::yield();
+            } else if ( mailbox_.try_idle() ) {
+                // mailbox is empty, wait for the next message
+                // a sender of another thread passes the actor to the
+                // remote ready-queue, drained after the switch
+                ctx_->suspend();
+            } else {
+                // a sender has not yet linked its message
+                this_fiber::yield();
+            }
+        }
+    }
+
+    template< typename StackAllocator >
+    intrusive_ptr< context > make_context_( StackAllocator salloc) {
+        return make_worker_context( launch::post, salloc, [this](){ run_(); });
+    }
+
+public:
+    template< typename Fn >
+    explicit actor( Fn && fn, std::size_t batch = default_batch) :
+        actor{ std::allocator_arg, default_stack(), std::forward< Fn >( fn), batch } {
+    }
+
+    // the actor runs in the calling thread, work-stealing algorithms
+    // might migrate it
+    template< typename StackAllocator, typename Fn >
+    actor( std::allocator_arg_t, StackAllocator salloc, Fn && fn,
+           std::size_t batch = default_batch) :
+        fn_( std::forward< Fn >( fn) ),
+        batch_{ batch } {
+        BOOST_ASSERT( 0 < batch_);
+        impl_ = make_context_( salloc);
+        context * active_ctx = context::active();
+        active_ctx->attach( impl_.get() );
+        active_ctx->get_scheduler()->set_ready( impl_.get() );
+    }
+
+    template< typename Fn >
+    actor( scheduler_handle const& h, Fn && fn, std::size_t batch = default_batch) :
+        actor{ h, std::allocator_arg, default_stack(), std::forward< Fn >( fn), batch } {
+    }
+
+    // the actor is pinned to the scheduler referenced by h; it is never
+    // migrated to another thread
+    template< typename StackAllocator, typename Fn >
+    actor( scheduler_handle const& h, std::allocator_arg_t, StackAllocator salloc, Fn && fn,
+           std::size_t batch = default_batch) :
+        fn_( std::forward< Fn >( fn) ),
+        batch_{ batch } {
+        BOOST_ASSERT( h);
+        BOOST_ASSERT( 0 < batch_);
+        impl_ = make_context_( salloc);
+        impl_->pin();
+        h.get_scheduler()->remote_post( impl_.get(), impl_.get() );
+    }
+
+    actor( actor const&) = delete;
+    actor & operator=( actor const&) = delete;
+
+    // closes the mailbox and waits till the actor has processed the
+    // messages sent before
+    ~actor() {
+        close();
+        join();
+        // messages sent after close()
+        detail::mailbox_node * n = nullptr;
+        while ( nullptr != ( n = mailbox_.pop() ) ) {
+            delete static_cast< node * >( n);
+        }
+    }
+
+    void send( value_type const& value) {
+        emplace( value);
+    }
+
+    void send( value_type && value) {
+        emplace( std::move( value) );
+    }
+
+    template< typename ... Args >
+    void emplace( Args && ... args) {
+        if ( closed_.load( std::memory_order_relaxed) ) {
+            throw fiber_error{
+                    std::make_error_code( std::errc::operation_not_permitted),
+                    "boost fiber: actor is closed" };
+        }
+        push_( new node( std::forward< Args >( args) ... ) );
+    }
+
+    // the actor terminates after the messages sent before
+    void close() noexcept {
+        if ( ! closed_.exchange( true, std::memory_order_acq_rel) ) {
+            push_( & close_node_);
+        }
+    }
+
+    bool is_closed() const noexcept {
+        return closed_.load( std::memory_order_relaxed);
+    }
+
+    // waits for the termination of the actor (after close())
+    void join() {
+        if ( impl_) {
+            impl_->join( BOOST_FIBERS_CALLER);
+            impl_.reset();
+        }
+    }
+};
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_ACTOR_H
@@ -38,6 +38,19 @@ struct BOOST_FIBERS_DECL algorithm {
     virtual void suspend_until( std::chrono::steady_clock::time_point const&) noexcept = 0;
 
     virtual void notify() noexcept = 0;
+
+    // called from other threads, e.g. by class monitor to hand the ready
+    // fibers of a blocked thread over to another thread; an algorithm
+    // supporting this returns a ready, detached context
+    virtual context * steal() noexcept {
+        return nullptr;
+    }
+
+    // the clock of the scheduler, used for the deadlines of the fibers;
+    // an algorithm running the fibers in virtual time overrides it
+    virtual std::chrono::steady_clock::time_point now() const noexcept {
+        return std::chrono::steady_clock::now();
+    }
 };
 
 class BOOST_FIBERS_DECL algorithm_with_properties_base : public algorithm {
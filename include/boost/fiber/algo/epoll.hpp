@@ -0,0 +1,104 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_ALGO_EPOLL_H
+#define BOOST_FIBERS_ALGO_EPOLL_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/algo/algorithm.hpp>
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/scheduler.hpp>
+
+#if ! BOOST_OS_LINUX
+# error "epoll scheduling algorithm requires Linux"
+#endif
+
+#include <sys/epoll.h>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace algo {
+
+// round-robin scheduling of the ready fibers; if no fiber is ready
+// the thread blocks in epoll_wait() until a registered file descriptor
+// becomes ready, the next sleep deadline is reached or notify() is called
+class BOOST_FIBERS_DECL epoll : public algorithm {
+private:
+    typedef scheduler::ready_queue_t rqueue_t;
+
+    static constexpr std::size_t    max_events = 64;
+
+    struct fd_entry {
+        context     *   reader{ nullptr };
+        context     *   writer{ nullptr };
+        // edge-triggered readiness observed while no fiber was waiting
+        bool            readable{ false };
+        bool            writable{ false };
+        bool            registered{ false };
+    };
+
+    rqueue_t                    rqueue_{};
+    std::vector< fd_entry >     entries_{};
+    int                         epfd_{ -1 };
+    int                         evfd_{ -1 };
+    std::atomic_bool            notified_{ false };
+    ::epoll_event               events_[max_events];
+
+    fd_entry & entry_( int);
+
+    void wakeup_( int, std::uint32_t) noexcept;
+
+public:
+    epoll();
+
+    epoll( epoll const&) = delete;
+    epoll & operator=( epoll const&) = delete;
+
+    virtual ~epoll();
+
+    virtual void awakened( context *) noexcept;
+
+    virtual context * pick_next() noexcept;
+
+    virtual bool has_ready_fibers() const noexcept;
+
+    virtual void suspend_until( std::chrono::steady_clock::time_point const&) noexcept;
+
+    virtual void notify() noexcept;
+
+    // suspends the active fiber till fd becomes ready for events
+    // (EPOLLIN or EPOLLOUT) or the time-point has been reached;
+    // returns false on timeout
+    bool wait( int fd, std::uint32_t events,
+               std::chrono::steady_clock::time_point const&);
+
+    // removes fd from the interest list, must be called before fd is closed
+    void forget( int fd) noexcept;
+
+    // epoll instance scheduling the fibers of the calling thread,
+    // nullptr if another algorithm is in use
+    static epoll * instance() noexcept;
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_ALGO_EPOLL_H
@@ -0,0 +1,83 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_ALGO_SIMULATION_H
+#define BOOST_FIBERS_ALGO_SIMULATION_H
+
+#include <condition_variable>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <random>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/algo/algorithm.hpp>
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/scheduler.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+namespace algo {
+
+// runs the fibers of a thread in virtual time: the clock stands still while
+// fibers run and jumps to the next deadline if all fibers are blocked;
+// the next fiber is picked from the ready fibers by a seeded generator
+class BOOST_FIBERS_DECL simulation : public algorithm {
+private:
+    typedef scheduler::ready_queue_t rqueue_t;
+
+    rqueue_t                                rqueue_{};
+    std::size_t                             size_{ 0 };
+    std::mt19937_64                         generator_;
+    std::chrono::steady_clock::time_point   now_;
+    std::mutex                              mtx_{};
+    std::condition_variable                 cnd_{};
+    bool                                    flag_{ false };
+
+public:
+    explicit simulation( std::uint64_t seed = 0);
+
+    simulation( simulation const&) = delete;
+    simulation & operator=( simulation const&) = delete;
+
+    virtual void awakened( context *) noexcept;
+
+    virtual context * pick_next() noexcept;
+
+    virtual bool has_ready_fibers() const noexcept;
+
+    virtual void suspend_until( std::chrono::steady_clock::time_point const&) noexcept;
+
+    virtual void notify() noexcept;
+
+    virtual std::chrono::steady_clock::time_point now() const noexcept;
+
+    void advance( std::chrono::steady_clock::duration const&) noexcept;
+};
+
+}}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_ALGO_SIMULATION_H
@@ -8,15 +8,18 @@
 #ifndef BOOST_FIBERS_ALGO_WORK_STEALING_H
 #define BOOST_FIBERS_ALGO_WORK_STEALING_H
 
+#include <atomic>
 #include <condition_variable>
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <mutex>
-#include <vector>
 
 #include <boost/config.hpp>
 
 #include <boost/fiber/algo/algorithm.hpp>
+#include <boost/fiber/detail/cache_aligned.hpp>
 #include <boost/fiber/detail/context_spmc_queue.hpp>
 #include <boost/fiber/context.hpp>
 #include <boost/fiber/detail/config.hpp>
@@ -30,32 +33,67 @@ namespace boost {
 namespace fibers {
 namespace algo {
 
-class work_stealing : public algorithm {
+// the threads running work_stealing form a group; a thread might join
+// (construct work_stealing) or leave (retire(), destruct) the group at any
+// time; fibers are stolen only between threads of the same group
+class BOOST_FIBERS_DECL work_stealing : public algorithm,
+                                         public detail::cache_aligned {
+public:
+    class group;
+
 private:
     typedef scheduler::ready_queue_t lqueue_t;
 
-    static std::vector< work_stealing * >        schedulers_;
-
+    // shared by the members, so that the group outlives them
+    std::shared_ptr< group >                        group_;
     std::size_t                                     idx_;
     std::size_t                                     max_idx_;
+    scheduler                                   *   sched_;
     detail::context_spmc_queue                      rqueue_{};
     lqueue_t                                        lqueue_{};
     std::mutex                                      mtx_{};
     std::condition_variable                         cnd_{};
     bool                                            flag_{ false };
     bool                                            suspend_;
+    bool                                            retiring_{ false };
+    // next peer a retiring thread passes ready fibers to
+    std::size_t                                     peer_idx_{ 0 };
+    // time spent in suspend_until()
+    std::atomic< std::uint64_t >                    idle_ns_{ 0 };
+    // start of the current wait in suspend_until(), zero if not waiting
+    std::atomic< std::chrono::steady_clock::rep >   idle_since_{ 0 };
 
-    static void init_( std::size_t max_idx);
+    bool post_to_peer_( context *) noexcept;
 
 public:
+    // creates a group of its own, e.g. for a thread pool which must not
+    // share fibers with other work_stealing threads of the process
+    static std::shared_ptr< group > make_group();
+
+    // joins the process-wide group at index idx; idx <= max_idx
     work_stealing( std::size_t max_idx, std::size_t idx, bool suspend = false);
 
+    // joins the process-wide group at the first free index
+    explicit work_stealing( bool suspend);
+
+    // joins group g at index idx; idx <= max_idx
+    // throws fiber_error if idx has been taken by a thread joining
+    // at the first free index
+    work_stealing( std::shared_ptr< group > g,
+                   std::size_t max_idx, std::size_t idx, bool suspend = false);
+
+    // joins group g at the first free index
+    work_stealing( std::shared_ptr< group > g, bool suspend);
+
     work_stealing( work_stealing const&) = delete;
     work_stealing( work_stealing &&) = delete;
 
     work_stealing & operator=( work_stealing const&) = delete;
     work_stealing & operator=( work_stealing &&) = delete;
 
+    // leaves the group if not already retired
+    ~work_stealing();
+
     void awakened( context * ctx) noexcept;
 
     context * pick_next() noexcept;
@@ -71,8 +109,27 @@ public:
     void suspend_until( std::chrono::steady_clock::time_point const& time_point) noexcept;
 
     void notify() noexcept;
-};
 
+    // leaves the group: the thread neither steals nor is stolen from any
+    // longer, ready fibers (except pinned fibers) are passed to the other
+    // threads of the group; runs them itself if no other thread is left
+    // must be called by the thread running this algorithm
+    void retire() noexcept;
+
+    std::size_t index() const noexcept {
+        return idx_;
+    }
+
+    // approximate number of ready fibers which might be stolen;
+    // might be read by any thread
+    std::size_t ready_count() const noexcept {
+        return rqueue_.size();
+    }
+
+    // accumulated time the thread waited in suspend_until(), including
+    // the current wait; might be read by any thread
+    std::chrono::nanoseconds idle_time() const noexcept;
+};
 }}}
 
 #ifdef BOOST_HAS_ABI_HEADERS
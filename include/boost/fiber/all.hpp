@@ -7,21 +7,37 @@
 #ifndef BOOST_FIBERS_H
 #define BOOST_FIBERS_H
 
+#include <boost/fiber/actor.hpp>
 #include <boost/fiber/algo/algorithm.hpp>
+#if BOOST_OS_LINUX
+# include <boost/fiber/algo/epoll.hpp>
+#endif
 #include <boost/fiber/algo/round_robin.hpp>
 #include <boost/fiber/algo/shared_work.hpp>
+#include <boost/fiber/algo/simulation.hpp>
 #include <boost/fiber/algo/work_stealing.hpp>
 #include <boost/fiber/barrier.hpp>
+#include <boost/fiber/blocking.hpp>
 #include <boost/fiber/buffered_channel.hpp>
 #include <boost/fiber/channel_op_status.hpp>
 #include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/contention_profiler.hpp>
 #include <boost/fiber/context.hpp>
+#include <boost/fiber/coroutine.hpp>
+#include <boost/fiber/elastic_pool.hpp>
 #include <boost/fiber/exceptions.hpp>
 #include <boost/fiber/fiber.hpp>
+#include <boost/fiber/fiber_dump.hpp>
 #include <boost/fiber/fixedsize_stack.hpp>
 #include <boost/fiber/fss.hpp>
+#if BOOST_OS_LINUX
+# include <boost/fiber/io.hpp>
+#endif
 #include <boost/fiber/future.hpp>
+#include <boost/fiber/latency_histogram.hpp>
+#include <boost/fiber/monitor.hpp>
 #include <boost/fiber/mutex.hpp>
+#include <boost/fiber/observer.hpp>
 #include <boost/fiber/operations.hpp>
 #include <boost/fiber/policy.hpp>
 #include <boost/fiber/pooled_fixedsize_stack.hpp>
@@ -30,8 +46,12 @@
 #include <boost/fiber/recursive_mutex.hpp>
 #include <boost/fiber/recursive_timed_mutex.hpp>
 #include <boost/fiber/scheduler.hpp>
+#include <boost/fiber/scheduler_handle.hpp>
+#include <boost/fiber/scheduler_stats.hpp>
 #include <boost/fiber/segmented_stack.hpp>
+#include <boost/fiber/sharded.hpp>
 #include <boost/fiber/timed_mutex.hpp>
+#include <boost/fiber/tracer.hpp>
 #include <boost/fiber/type.hpp>
 #include <boost/fiber/unbuffered_channel.hpp>
 
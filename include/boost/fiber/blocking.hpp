@@ -0,0 +1,171 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_BLOCKING_H
+#define BOOST_FIBERS_BLOCKING_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/scheduler.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// unit of work executed by the offload pool
+// lives on the stack of the waiting fiber, no allocation required
+class BOOST_FIBERS_DECL blocking_task {
+private:
+    enum state_t {
+        state_init,         // fiber did not yet try to suspend
+        state_waiting,      // fiber suspended
+        state_complete      // task has been executed
+    };
+
+    std::atomic< state_t >      state_{ state_init };
+    context                 *   ctx_;
+
+public:
+    blocking_task           *   nxt_{ nullptr };
+
+    blocking_task() noexcept :
+        ctx_{ context::active() } {
+    }
+
+    virtual ~blocking_task() {}
+
+    blocking_task( blocking_task const&) = delete;
+    blocking_task & operator=( blocking_task const&) = delete;
+
+    virtual void run() noexcept = 0;
+
+    // called by the pool thread after run()
+    void complete() noexcept;
+
+    // suspends the calling fiber till complete() has been called
+    void wait() noexcept;
+};
+
+template< typename R, typename Fn >
+class blocking_task_impl : public blocking_task {
+private:
+    Fn                                                      fn_;
+    typename std::aligned_storage<
+        sizeof( R), alignof( R) >::type                     storage_;
+    bool                                                    has_value_{ false };
+    std::exception_ptr                                      except_{};
+
+public:
+    explicit blocking_task_impl( Fn && fn) :
+        fn_( std::forward< Fn >( fn) ) {
+    }
+
+    ~blocking_task_impl() {
+        if ( has_value_) {
+            reinterpret_cast< R * >( & storage_)->~R();
+        }
+    }
+
+    void run() noexcept override final {
+        try {
+            ::new ( static_cast< void * >( & storage_) ) R( fn_() );
+            has_value_ = true;
+        } catch (...) {
+            except_ = std::current_exception();
+        }
+    }
+
+    R get() {
+        if ( except_) {
+            std::rethrow_exception( except_);
+        }
+        BOOST_ASSERT( has_value_);
+        return std::move( * reinterpret_cast< R * >( & storage_) );
+    }
+};
+
+template< typename Fn >
+class blocking_task_impl< void, Fn > : public blocking_task {
+private:
+    Fn                          fn_;
+    std::exception_ptr          except_{};
+
+public:
+    explicit blocking_task_impl( Fn && fn) :
+        fn_( std::forward< Fn >( fn) ) {
+    }
+
+    void run() noexcept override final {
+        try {
+            fn_();
+        } catch (...) {
+            except_ = std::current_exception();
+        }
+    }
+
+    void get() {
+        if ( except_) {
+            std::rethrow_exception( except_);
+        }
+    }
+};
+
+// hands the task over to the offload pool
+BOOST_FIBERS_DECL
+void blocking_submit( blocking_task *);
+
+}
+
+// upper limit of threads of the offload pool (default: 64)
+// if all threads are busy, further calls to blocking() are queued
+BOOST_FIBERS_DECL
+void set_blocking_max_threads( std::size_t);
+
+// idle threads of the offload pool terminate after this period (default: 10s)
+BOOST_FIBERS_DECL
+void set_blocking_idle_timeout( std::chrono::steady_clock::duration const&);
+
+// executes fn( args...) on a thread of the offload pool; only the calling
+// fiber is suspended, other fibers of the thread continue to run
+// the result (or the exception thrown by fn) is handed back to the caller
+template< typename Fn, typename ... Args >
+typename std::decay< typename std::result_of< Fn&&( Args&& ...) >::type >::type
+blocking( Fn && fn, Args && ... args) {
+    typedef typename std::decay<
+        typename std::result_of< Fn&&( Args&& ...) >::type
+    >::type result_type;
+    // fn and args outlive the task: the calling fiber waits for its completion
+    auto wrapper = [&fn,&args...]() -> result_type {
+        return std::forward< Fn >( fn)( std::forward< Args >( args) ...);
+    };
+    detail::blocking_task_impl< result_type, decltype( wrapper) > task{ std::move( wrapper) };
+    detail::blocking_submit( & task);
+    task.wait();
+    return task.get();
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_BLOCKING_H
@@ -8,7 +8,11 @@
 #ifndef BOOST_FIBERS_BOUNDED_CHANNEL_H
 #define BOOST_FIBERS_BOUNDED_CHANNEL_H
 
-#warn "template bounded_channel is deprecated"
+#if defined(_MSC_VER)
+# pragma message("template bounded_channel is deprecated")
+#else
+# warning "template bounded_channel is deprecated"
+#endif
 
 #include <algorithm>
 #include <atomic>
@@ -285,14 +289,14 @@ public:
     channel_op_status push_wait_for( value_type const& va,
                                      std::chrono::duration< Rep, Period > const& timeout_duration) {
         return push_wait_until( va,
-                                std::chrono::steady_clock::now() + timeout_duration);
+                                detail::now() + timeout_duration);
     }
 
     template< typename Rep, typename Period >
     channel_op_status push_wait_for( value_type && va,
                                      std::chrono::duration< Rep, Period > const& timeout_duration) {
         return push_wait_until( std::forward< value_type >( va),
-                                std::chrono::steady_clock::now() + timeout_duration);
+                                detail::now() + timeout_duration);
     }
 
     template< typename Clock, typename Duration >
@@ -402,7 +406,7 @@ public:
     channel_op_status pop_wait_for( value_type & va,
                                     std::chrono::duration< Rep, Period > const& timeout_duration) {
         return pop_wait_until( va,
-                               std::chrono::steady_clock::now() + timeout_duration);
+                               detail::now() + timeout_duration);
     }
 
     template< typename Clock, typename Duration >
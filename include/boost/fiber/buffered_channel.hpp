@@ -21,10 +21,12 @@
 
 #include <boost/fiber/channel_op_status.hpp>
 #include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/channel_slots.hpp>
 #include <boost/fiber/detail/config.hpp>
 #include <boost/fiber/detail/convert.hpp>
 #include <boost/fiber/detail/spinlock.hpp>
 #include <boost/fiber/exceptions.hpp>
+#include <boost/fiber/observer.hpp>
 
 #ifdef BOOST_HAS_ABI_HEADERS
 #  include BOOST_ABI_PREFIX
@@ -33,22 +35,63 @@
 namespace boost {
 namespace fibers {
 
-template< typename T >
+namespace detail {
+
+template< typename Channel >
+struct pop_awaiter;
+
+}
+
+// layout of the ring buffer of a buffered_channel
+enum class slot_layout {
+    // each slot on a cacheline of its own, no false sharing between
+    // producers and consumers
+    padded,
+    // slots packed densely, for small values and small capacities
+    dense
+};
+
+// capacity N == 0: the capacity is passed to the constructor and the ring
+// buffer is allocated; otherwise the ring buffer is embedded
+template< typename T, std::size_t N = 0, slot_layout Layout = slot_layout::padded >
 class buffered_channel {
 public:
     typedef T   value_type;
 
 private:
+    template< typename Channel >
+    friend struct detail::pop_awaiter;
+
     typedef typename std::aligned_storage< sizeof( T), alignof( T) >::type  storage_type;
     typedef context::wait_queue_t                                           wait_queue_type;
 
-    struct alignas(cache_alignment) slot {
+    // a C++20 coroutine waiting in async_pop() (see coroutine.hpp); it is
+    // passed a value (or closed) by the channel and resumed by calling fn
+    struct pop_waiter {
+        pop_waiter          *   next{ nullptr };
+        value_type          *   value{ nullptr };
+        channel_op_status       status{ channel_op_status::empty };
+        void                ( * fn)( pop_waiter *){ nullptr };
+    };
+
+    struct alignas(cache_alignment) padded_slot {
         std::atomic< std::size_t >  cycle{ 0 };
-        storage_type                storage{};
+        storage_type                storage;
 
-        slot() = default;
+        padded_slot() = default;
     };
 
+    struct dense_slot {
+        std::atomic< std::size_t >  cycle{ 0 };
+        storage_type                storage;
+
+        dense_slot() = default;
+    };
+
+    typedef typename std::conditional<
+        slot_layout::padded == Layout, padded_slot, dense_slot
+    >::type                                                                 slot;
+
     // procuder cacheline
     alignas(cache_alignment) std::atomic< std::size_t >     producer_idx_{ 0 };
     // consumer cacheline
@@ -58,19 +101,20 @@ private:
     mutable detail::spinlock                                splk_{};
     wait_queue_type                                         waiting_producers_{};
     wait_queue_type                                         waiting_consumers_{};
+    pop_waiter                                          *   awaiting_head_{ nullptr };
+    pop_waiter                                          **  awaiting_tail_{ & awaiting_head_ };
     // shared read cacheline
-    alignas(cache_alignment) slot                        *  slots_{ nullptr };
-    std::size_t                                             capacity_;
+    alignas(cache_alignment) detail::channel_slots< slot, N > slots_;
     char                                                    pad_[cacheline_length];
 
     bool is_full_() {
         std::size_t idx{ producer_idx_.load( std::memory_order_relaxed) };
-        return 0 > static_cast< std::intptr_t >( slots_[idx & (capacity_ - 1)].cycle.load( std::memory_order_acquire) ) - static_cast< std::intptr_t >( idx);
+        return 0 > static_cast< std::intptr_t >( slots_[idx].cycle.load( std::memory_order_acquire) ) - static_cast< std::intptr_t >( idx);
     }
 
     bool is_empty_() {
         std::size_t idx{ consumer_idx_.load( std::memory_order_relaxed) };
-        return 0 > static_cast< std::intptr_t >( slots_[idx & (capacity_ - 1)].cycle.load( std::memory_order_acquire) ) - static_cast< std::intptr_t >( idx + 1);
+        return 0 > static_cast< std::intptr_t >( slots_[idx].cycle.load( std::memory_order_acquire) ) - static_cast< std::intptr_t >( idx + 1);
     }
 
     template< typename ValueType >
@@ -78,7 +122,7 @@ private:
         slot * s{ nullptr };
         std::size_t idx{ producer_idx_.load( std::memory_order_relaxed) };
         for (;;) {
-            s = & slots_[idx & (capacity_ - 1)];
+            s = & slots_[idx];
             std::size_t cycle{ s->cycle.load( std::memory_order_acquire) };
             std::intptr_t diff{ static_cast< std::intptr_t >( cycle) - static_cast< std::intptr_t >( idx) };
             if ( 0 == diff) {
@@ -99,7 +143,7 @@ private:
     channel_op_status try_value_pop_( slot *& s, std::size_t & idx) {
         idx = consumer_idx_.load( std::memory_order_relaxed);
         for (;;) {
-            s = & slots_[idx & (capacity_ - 1)];
+            s = & slots_[idx];
             std::size_t cycle = s->cycle.load( std::memory_order_acquire);
             std::intptr_t diff{ static_cast< std::intptr_t >( cycle) - static_cast< std::intptr_t >( idx + 1) };
             if ( 0 == diff) {
@@ -123,24 +167,106 @@ private:
         channel_op_status status{ try_value_pop_( s, idx) };
         if ( channel_op_status::success == status) {
             value = std::move( * reinterpret_cast< value_type * >( std::addressof( s->storage) ) );
-            s->cycle.store( idx + capacity_, std::memory_order_release);
+            s->cycle.store( idx + slots_.capacity(), std::memory_order_release);
         }
         return status;
     }
 
-public:
-    explicit buffered_channel( std::size_t capacity) :
-        capacity_{ capacity } {
-        if ( 2 > capacity_ || 0 != ( capacity_ & (capacity_ - 1) ) ) { 
-            throw fiber_error( std::make_error_code( std::errc::invalid_argument),
-                               "boost fiber: buffer capacity is invalid");
+    void notify_consumer_() noexcept {
+        detail::spinlock_lock lk{ splk_ };
+        if ( nullptr != awaiting_head_) {
+            // the value is claimed under the lock: a coroutine, unlike a
+            // fiber, can not check again for a value when resumed
+            slot * s{ nullptr };
+            std::size_t idx{ 0 };
+            if ( channel_op_status::success == try_value_pop_( s, idx) ) {
+                pop_waiter * w{ awaiting_head_ };
+                if ( nullptr == ( awaiting_head_ = w->next) ) {
+                    awaiting_tail_ = & awaiting_head_;
+                }
+                lk.unlock();
+                pass_( w, s, idx);
+            }
+            // otherwise another consumer took the value
+            return;
+        }
+        if ( ! waiting_consumers_.empty() ) {
+            context * consumer_ctx{ & waiting_consumers_.front() };
+            waiting_consumers_.pop_front();
+            lk.unlock();
+            context::active()->set_ready( consumer_ctx);
+        }
+    }
+
+    // moves the value of the claimed slot to w and resumes it
+    void pass_( pop_waiter * w, slot * s, std::size_t idx) noexcept {
+        * w->value = std::move( * reinterpret_cast< value_type * >( std::addressof( s->storage) ) );
+        s->cycle.store( idx + slots_.capacity(), std::memory_order_release);
+        w->status = channel_op_status::success;
+        w->fn( w);
+        // notify one waiting producer
+        notify_producer_();
+    }
+
+    // passes a value or closed to w, or links w if the channel is empty;
+    // returns false if w has not been linked
+    bool await_pop_( pop_waiter * w) noexcept {
+        detail::spinlock_lock lk{ splk_ };
+        slot * s{ nullptr };
+        std::size_t idx{ 0 };
+        if ( channel_op_status::success == try_value_pop_( s, idx) ) {
+            lk.unlock();
+            * w->value = std::move( * reinterpret_cast< value_type * >( std::addressof( s->storage) ) );
+            s->cycle.store( idx + slots_.capacity(), std::memory_order_release);
+            w->status = channel_op_status::success;
+            notify_producer_();
+            return false;
+        }
+        if ( is_closed() ) {
+            w->status = channel_op_status::closed;
+            return false;
+        }
+        w->next = nullptr;
+        * awaiting_tail_ = w;
+        awaiting_tail_ = & w->next;
+        return true;
+    }
+
+    // unlinks w if it has not been passed a value yet, e.g. if the
+    // awaiting coroutine is destroyed
+    void cancel_pop_( pop_waiter * w) noexcept {
+        detail::spinlock_lock lk{ splk_ };
+        for ( pop_waiter ** i{ & awaiting_head_ }; nullptr != * i; i = & ( * i)->next) {
+            if ( w == * i) {
+                if ( nullptr == ( * i = w->next) ) {
+                    awaiting_tail_ = i;
+                }
+                return;
+            }
         }
-        slots_ = new slot[capacity_]();
-        for ( std::size_t i = 0; i < capacity_; ++i) {
-            slots_[i].cycle.store( i, std::memory_order_relaxed);
+    }
+
+    void notify_producer_() noexcept {
+        detail::spinlock_lock lk{ splk_ };
+        if ( ! waiting_producers_.empty() ) {
+            context * producer_ctx{ & waiting_producers_.front() };
+            waiting_producers_.pop_front();
+            lk.unlock();
+            context::active()->set_ready( producer_ctx);
         }
     }
 
+public:
+    template< std::size_t M = N, typename = typename std::enable_if< 0 == M >::type >
+    explicit buffered_channel( std::size_t capacity) :
+        slots_{ capacity } {
+    }
+
+    template< std::size_t M = N, typename = typename std::enable_if< 0 != M >::type >
+    buffered_channel() :
+        slots_{} {
+    }
+
     ~buffered_channel() {
         close();
         for (;;) {
@@ -148,12 +274,11 @@ public:
             std::size_t idx{ 0 };
             if ( channel_op_status::success == try_value_pop_( s, idx) ) {
                 reinterpret_cast< value_type * >( std::addressof( s->storage) )->~value_type();
-                s->cycle.store( idx + capacity_, std::memory_order_release);
+                s->cycle.store( idx + slots_.capacity(), std::memory_order_release);
             } else {
                 break;
             }
         }
-        delete [] slots_;
     }
 
     buffered_channel( buffered_channel const&) = delete;
@@ -179,20 +304,48 @@ public:
             waiting_consumers_.pop_front();
             ctx->set_ready( consumer_ctx);
         }
+        pop_waiter * w{ awaiting_head_ };
+        awaiting_head_ = nullptr;
+        awaiting_tail_ = & awaiting_head_;
+        lk.unlock();
+        // resume all awaiting coroutines; values pushed before closing are
+        // still passed
+        while ( nullptr != w) {
+            pop_waiter * next{ w->next };
+            slot * s{ nullptr };
+            std::size_t idx{ 0 };
+            if ( channel_op_status::success == try_value_pop_( s, idx) ) {
+                pass_( w, s, idx);
+            } else {
+                w->status = channel_op_status::closed;
+                w->fn( w);
+            }
+            w = next;
+        }
     }
 
     channel_op_status try_push( value_type const& value) {
         if ( is_closed() ) {
             return channel_op_status::closed;
         }
-        return try_push_( value);
+        channel_op_status status{ try_push_( value) };
+        if ( channel_op_status::success == status) {
+            // notify one waiting consumer
+            notify_consumer_();
+        }
+        return status;
     }
 
     channel_op_status try_push( value_type && value) {
         if ( is_closed() ) {
             return channel_op_status::closed;
         }
-        return try_push_( std::move( value) );
+        channel_op_status status{ try_push_( std::move( value) ) };
+        if ( channel_op_status::success == status) {
+            // notify one waiting consumer
+            notify_consumer_();
+        }
+        return status;
     }
 
     channel_op_status push( value_type const& value) {
@@ -203,14 +356,8 @@ public:
             }
             channel_op_status status{ try_push_( value) };
             if ( channel_op_status::success == status) {
-                detail::spinlock_lock lk{ splk_ };
                 // notify one waiting consumer
-                if ( ! waiting_consumers_.empty() ) {
-                    context * consumer_ctx{ & waiting_consumers_.front() };
-                    waiting_consumers_.pop_front();
-                    lk.unlock();
-                    ctx->set_ready( consumer_ctx);
-                }
+                notify_consumer_();
                 return status;
             } else if ( channel_op_status::full == status) {
                 BOOST_ASSERT( ! ctx->wait_is_linked() );
@@ -222,6 +369,7 @@ public:
                     continue;
                 }
                 ctx->wait_link( waiting_producers_);
+                detail::observe_block( ctx, block_reason::channel_push, this, BOOST_FIBERS_CALLER);
                 // suspend this producer
                 ctx->suspend( lk);
             } else {
@@ -239,14 +387,8 @@ public:
             }
             channel_op_status status{ try_push_( std::move( value) ) };
             if ( channel_op_status::success == status) {
-                detail::spinlock_lock lk{ splk_ };
                 // notify one waiting consumer
-                if ( ! waiting_consumers_.empty() ) {
-                    context * consumer_ctx{ & waiting_consumers_.front() };
-                    waiting_consumers_.pop_front();
-                    lk.unlock();
-                    ctx->set_ready( consumer_ctx);
-                }
+                notify_consumer_();
                 return status;
             } else if ( channel_op_status::full == status) {
                 BOOST_ASSERT( ! ctx->wait_is_linked() );
@@ -258,6 +400,7 @@ public:
                     continue;
                 }
                 ctx->wait_link( waiting_producers_);
+                detail::observe_block( ctx, block_reason::channel_push, this, BOOST_FIBERS_CALLER);
                 // suspend this producer
                 ctx->suspend( lk);
             } else {
@@ -271,14 +414,14 @@ public:
     channel_op_status push_wait_for( value_type const& value,
                                      std::chrono::duration< Rep, Period > const& timeout_duration) {
         return push_wait_until( value,
-                                std::chrono::steady_clock::now() + timeout_duration);
+                                detail::now() + timeout_duration);
     }
 
     template< typename Rep, typename Period >
     channel_op_status push_wait_for( value_type && value,
                                      std::chrono::duration< Rep, Period > const& timeout_duration) {
         return push_wait_until( std::forward< value_type >( value),
-                                std::chrono::steady_clock::now() + timeout_duration);
+                                detail::now() + timeout_duration);
     }
 
     template< typename Clock, typename Duration >
@@ -292,14 +435,8 @@ public:
             }
             channel_op_status status{ try_push_( value) };
             if ( channel_op_status::success == status) {
-                detail::spinlock_lock lk{ splk_ };
                 // notify one waiting consumer
-                if ( ! waiting_consumers_.empty() ) {
-                    context * consumer_ctx{ & waiting_consumers_.front() };
-                    waiting_consumers_.pop_front();
-                    lk.unlock();
-                    ctx->set_ready( consumer_ctx);
-                }
+                notify_consumer_();
                 return status;
             } else if ( channel_op_status::full == status) {
                 BOOST_ASSERT( ! ctx->wait_is_linked() );
@@ -311,6 +448,7 @@ public:
                     continue;
                 }
                 ctx->wait_link( waiting_producers_);
+                detail::observe_block( ctx, block_reason::channel_push, this, BOOST_FIBERS_CALLER);
                 // suspend this producer
                 if ( ! ctx->wait_until( timeout_time, lk) ) {
                     // relock local lk
@@ -337,14 +475,8 @@ public:
             }
             channel_op_status status{ try_push_( std::move( value) ) };
             if ( channel_op_status::success == status) {
-                detail::spinlock_lock lk{ splk_ };
                 // notify one waiting consumer
-                if ( ! waiting_consumers_.empty() ) {
-                    context * consumer_ctx{ & waiting_consumers_.front() };
-                    waiting_consumers_.pop_front();
-                    lk.unlock();
-                    ctx->set_ready( consumer_ctx);
-                }
+                notify_consumer_();
                 return status;
             } else if ( channel_op_status::full == status) {
                 BOOST_ASSERT( ! ctx->wait_is_linked() );
@@ -356,6 +488,7 @@ public:
                     continue;
                 }
                 ctx->wait_link( waiting_producers_);
+                detail::observe_block( ctx, block_reason::channel_push, this, BOOST_FIBERS_CALLER);
                 // suspend this producer
                 if ( ! ctx->wait_until( timeout_time, lk) ) {
                     // relock local lk
@@ -377,6 +510,9 @@ public:
             if ( is_closed() ) {
                 status = channel_op_status::closed;
             }
+        } else {
+            // notify one waiting producer
+            notify_producer_();
         }
         return status;
     }
@@ -405,6 +541,7 @@ public:
                     continue;
                 }
                 ctx->wait_link( waiting_consumers_);
+                detail::observe_block( ctx, block_reason::channel_pop, this, BOOST_FIBERS_CALLER);
                 // suspend this consumer
                 ctx->suspend( lk);
             } else {
@@ -422,7 +559,7 @@ public:
             channel_op_status status{ try_value_pop_( s, idx) };
             if ( channel_op_status::success == status) {
                 value_type value{ std::move( * reinterpret_cast< value_type * >( std::addressof( s->storage) ) ) };
-                s->cycle.store( idx + capacity_, std::memory_order_release);
+                s->cycle.store( idx + slots_.capacity(), std::memory_order_release);
                 detail::spinlock_lock lk{ splk_ };
                 // notify one waiting producer
                 if ( ! waiting_producers_.empty() ) {
@@ -444,6 +581,7 @@ public:
                     continue;
                 }
                 ctx->wait_link( waiting_consumers_);
+                detail::observe_block( ctx, block_reason::channel_pop, this, BOOST_FIBERS_CALLER);
                 // suspend this consumer
                 ctx->suspend( lk);
             } else {
@@ -459,7 +597,7 @@ public:
     channel_op_status pop_wait_for( value_type & value,
                                     std::chrono::duration< Rep, Period > const& timeout_duration) {
         return pop_wait_until( value,
-                               std::chrono::steady_clock::now() + timeout_duration);
+                               detail::now() + timeout_duration);
     }
 
     template< typename Clock, typename Duration >
@@ -489,6 +627,7 @@ public:
                     continue;
                 }
                 ctx->wait_link( waiting_consumers_);
+                detail::observe_block( ctx, block_reason::channel_pop, this, BOOST_FIBERS_CALLER);
                 // suspend this consumer
                 if ( ! ctx->wait_until( timeout_time, lk) ) {
                     // relock local lk
@@ -526,7 +665,7 @@ public:
 
         iterator() noexcept = default;
 
-        explicit iterator( buffered_channel< T > * chan) noexcept :
+        explicit iterator( buffered_channel * chan) noexcept :
             chan_{ chan } {
             increment_();
         }
@@ -568,16 +707,16 @@ public:
     friend class iterator;
 };
 
-template< typename T >
-typename buffered_channel< T >::iterator
-begin( buffered_channel< T > & chan) {
-    return typename buffered_channel< T >::iterator( & chan);
+template< typename T, std::size_t N, slot_layout Layout >
+typename buffered_channel< T, N, Layout >::iterator
+begin( buffered_channel< T, N, Layout > & chan) {
+    return typename buffered_channel< T, N, Layout >::iterator( & chan);
 }
 
-template< typename T >
-typename buffered_channel< T >::iterator
-end( buffered_channel< T > &) {
-    return typename buffered_channel< T >::iterator();
+template< typename T, std::size_t N, slot_layout Layout >
+typename buffered_channel< T, N, Layout >::iterator
+end( buffered_channel< T, N, Layout > &) {
+    return typename buffered_channel< T, N, Layout >::iterator();
 }
 
 }}
@@ -22,6 +22,7 @@
 #include <boost/fiber/detail/spinlock.hpp>
 #include <boost/fiber/exceptions.hpp>
 #include <boost/fiber/mutex.hpp>
+#include <boost/fiber/observer.hpp>
 #include <boost/fiber/operations.hpp>
 
 #ifdef BOOST_HAS_ABI_HEADERS
@@ -70,6 +71,7 @@ public:
         detail::spinlock_lock lk( wait_queue_splk_);
         BOOST_ASSERT( ! ctx->wait_is_linked() );
         ctx->wait_link( wait_queue_);
+        detail::observe_block( ctx, block_reason::condition_variable, this, BOOST_FIBERS_CALLER);
         // unlock external lt
         lt.unlock();
         // suspend this fiber
@@ -108,6 +110,7 @@ public:
         detail::spinlock_lock lk( wait_queue_splk_);
         BOOST_ASSERT( ! ctx->wait_is_linked() );
         ctx->wait_link( wait_queue_);
+        detail::observe_block( ctx, block_reason::condition_variable, this, BOOST_FIBERS_CALLER);
         // unlock external lt
         lt.unlock();
         // suspend this fiber
@@ -145,13 +148,13 @@ public:
     template< typename LockType, typename Rep, typename Period >
     cv_status wait_for( LockType & lt, std::chrono::duration< Rep, Period > const& timeout_duration) {
         return wait_until( lt,
-                           std::chrono::steady_clock::now() + timeout_duration);
+                           detail::now() + timeout_duration);
     }
 
     template< typename LockType, typename Rep, typename Period, typename Pred >
     bool wait_for( LockType & lt, std::chrono::duration< Rep, Period > const& timeout_duration, Pred pred) {
         return wait_until( lt,
-                           std::chrono::steady_clock::now() + timeout_duration,
+                           detail::now() + timeout_duration,
                            pred);
     }
 };
@@ -0,0 +1,101 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_CONTENTION_PROFILER_H
+#define BOOST_FIBERS_CONTENTION_PROFILER_H
+
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/observer.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+
+// waits on one synchronization primitive from one call site
+struct contention_record {
+    void const                  *   object{ nullptr };
+    // assigned by contention_profiler::name()
+    std::string                     name{};
+    void const                  *   caller{ nullptr };
+    block_reason                    reason{ block_reason::none };
+    std::size_t                     count{ 0 };
+    std::chrono::nanoseconds        total{ 0 };
+    std::chrono::nanoseconds        max{ 0 };
+};
+
+// measures how long fibers are suspended in mutexes, condition variables,
+// channels and join(), aggregated by primitive and call site
+class BOOST_FIBERS_DECL contention_profiler : public observer {
+private:
+    struct shard;
+
+    observer                            *   previous_{ nullptr };
+    bool                                    running_{ false };
+    std::unique_ptr< shard[] >              shards_;
+    mutable std::mutex                      mtx_{};
+    std::map< void const*, std::string >    names_{};
+
+    shard & shard_of( context::id) noexcept;
+
+public:
+    contention_profiler();
+
+    ~contention_profiler();
+
+    contention_profiler( contention_profiler const&) = delete;
+    contention_profiler & operator=( contention_profiler const&) = delete;
+
+    // installs the profiler as observer
+    void start() noexcept;
+
+    // restores the previous observer
+    void stop() noexcept;
+
+    void on_event( event const&) noexcept;
+
+    // names object in the report
+    void name( void const * object, std::string const& name);
+
+    // discards the waits recorded so far
+    void reset() noexcept;
+
+    // the n records with the longest total wait, longest first
+    std::vector< contention_record > top( std::size_t n = 10) const;
+
+    // writes top( n) as table
+    void report( std::ostream &, std::size_t n = 10) const;
+};
+
+}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_CONTENTION_PROFILER_H
@@ -39,6 +39,7 @@
 #include <boost/fiber/fixedsize_stack.hpp>
 #include <boost/fiber/policy.hpp>
 #include <boost/fiber/properties.hpp>
+#include <boost/fiber/scheduler_stats.hpp>
 #include <boost/fiber/segmented_stack.hpp>
 #include <boost/fiber/type.hpp>
 
@@ -58,6 +59,17 @@ class context;
 class fiber;
 class scheduler;
 
+// why a fiber is suspended, see observer and fiber_info
+enum class block_reason {
+    none = 0,
+    mutex,
+    condition_variable,
+    channel_push,
+    channel_pop,
+    join,
+    sleep
+};
+
 namespace detail {
 
 struct wait_tag;
@@ -230,6 +242,28 @@ public:
     detail::worker_hook                     worker_hook_{};
     std::atomic< context * >                remote_nxt_{ nullptr };
     std::chrono::steady_clock::time_point   tp_{ (std::chrono::steady_clock::time_point::max)() };
+    // see scheduler_stats: when the context has been made ready (epoch if
+    // not woken up) and if by another thread
+    std::chrono::steady_clock::time_point   ready_since_{};
+    bool                                    remote_ready_{ false };
+    // see fiber_info: the stack of the fiber (unknown for the main context),
+    // the stack pointer saved when it has been suspended, and the reason
+    // and primitive it blocks on (written by the thread of the scheduler)
+    void                                *   stack_base_{ nullptr };
+    std::size_t                             stack_size_{ 0 };
+    void                                *   saved_sp_{ nullptr };
+    block_reason                            wait_reason_{ block_reason::none };
+    void const                          *   wait_object_{ nullptr };
+    // return address in the code launching the fiber (fiber's constructor
+    // or its caller), null if unknown
+    void const                          *   spawn_site_{ nullptr };
+    // see fiber_stats: written by the thread of the scheduler on each
+    // context switch, read by any thread; run_since_ is the time-stamp
+    // counter when the fiber has been resumed, zero if it is not running
+    std::atomic< std::uint64_t >            cpu_ticks_{ 0 };
+    std::atomic< std::uint64_t >            run_since_{ 0 };
+    std::atomic< std::uint64_t >            switches_{ 0 };
+    std::atomic< std::int64_t >             ready_ns_{ 0 };
 
     typedef intrusive::list<
         context,
@@ -245,6 +279,8 @@ private:
 public:
     class id {
     private:
+        friend struct std::hash< id >;
+
         context  *   impl_{ nullptr };
 
     public:
@@ -381,6 +417,9 @@ public:
 
     id get_id() const noexcept;
 
+    // might be called from any thread
+    fiber_stats stats() const noexcept;
+
     void resume() noexcept;
     void resume( detail::spinlock_lock &) noexcept;
     void resume( context *) noexcept;
@@ -394,7 +433,8 @@ public:
     boost::context::continuation suspend_with_cc() noexcept;
     boost::context::continuation set_terminated() noexcept;
 #endif
-    void join();
+    // caller: call site reported to the observer
+    void join( void const * caller = nullptr);
 
     void yield() noexcept;
 
@@ -408,6 +448,14 @@ public:
         return type::none != ( type_ & t);
     }
 
+    // binds a worker context to the thread it is attached to, scheduling
+    // algorithms do not migrate it; must be called before the context
+    // becomes ready for the first time
+    void pin() noexcept {
+        BOOST_ASSERT( is_context( type::worker_context) );
+        type_ = type_ | type::bound_context;
+    }
+
     bool is_terminated() const noexcept {
         return 0 != ( flags_ & flag_terminated);
     }
@@ -533,14 +581,17 @@ static intrusive_ptr< context > make_worker_context( launch policy,
     const std::size_t size = sctx.size - ( static_cast< char * >( sctx.sp) - static_cast< char * >( sp) );
 #endif
     // placement new of context on top of fiber's stack
-    return intrusive_ptr< context >( 
+    intrusive_ptr< context > ctx{
             ::new ( sp) context(
                 worker_context,
                 policy,
                 boost::context::preallocated( sp, size, sctx),
                 salloc,
                 std::forward< Fn >( fn),
-                std::make_tuple( std::forward< Args >( args) ... ) ) );
+                std::make_tuple( std::forward< Args >( args) ... ) ) };
+    ctx->stack_base_ = sctx.sp;
+    ctx->stack_size_ = sctx.size;
+    return ctx;
 }
 
 namespace detail {
@@ -567,6 +618,17 @@ wait_functor::const_pointer wait_functor::to_value_ptr( wait_functor::const_hook
 
 }}}
 
+namespace std {
+
+template<>
+struct hash< ::boost::fibers::context::id > {
+    std::size_t operator()( ::boost::fibers::context::id const& id) const noexcept {
+        return hash< ::boost::fibers::context * >{}( id.impl_);
+    }
+};
+
+}
+
 #ifdef _MSC_VER
 # pragma warning(pop)
 #endif
@@ -0,0 +1,435 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_COROUTINE_H
+#define BOOST_FIBERS_COROUTINE_H
+
+#include <boost/config.hpp>
+
+// C++20 coroutines
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+# if __has_include(<coroutine>)
+#  define BOOST_FIBERS_HAS_COROUTINES
+# endif
+#endif
+
+#if defined(BOOST_FIBERS_HAS_COROUTINES)
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include <boost/assert.hpp>
+
+#include <boost/fiber/buffered_channel.hpp>
+#include <boost/fiber/channel_op_status.hpp>
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/deferred.hpp>
+#include <boost/fiber/exceptions.hpp>
+#include <boost/fiber/fiber.hpp>
+#include <boost/fiber/future/future.hpp>
+#include <boost/fiber/future/promise.hpp>
+#include <boost/fiber/scheduler.hpp>
+#include <boost/fiber/scheduler_handle.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+template< typename T = void >
+class task;
+
+namespace detail {
+
+// resumes a coroutine in the deferred runner of a scheduler
+struct coroutine_resumer : public deferred {
+    scheduler               *   sched{ nullptr };
+    std::coroutine_handle<>     handle{};
+
+    static void resume_( deferred * d) {
+        static_cast< coroutine_resumer * >( d)->handle.resume();
+    }
+
+    coroutine_resumer() noexcept :
+        deferred{ & coroutine_resumer::resume_ } {
+    }
+
+    // the coroutine is resumed by the scheduler of the calling thread
+    void suspend( std::coroutine_handle<> h) noexcept {
+        sched = context::active()->get_scheduler();
+        handle = h;
+    }
+
+    // might be called from any thread
+    void resume() {
+        sched->defer( this);
+    }
+};
+
+template< typename R >
+struct future_awaiter : public coroutine_resumer {
+    future< R > &   f;
+
+    static void ready_( void * vp) {
+        static_cast< future_awaiter * >( vp)->resume();
+    }
+
+    explicit future_awaiter( future< R > & f_) noexcept :
+        f{ f_ } {
+    }
+
+    bool await_ready() const noexcept {
+        // await_resume() throws future_uninitialized
+        return ! f.valid();
+    }
+
+    bool await_suspend( std::coroutine_handle<> h) {
+        suspend( h);
+        // resumed at once if the state is ready
+        return f.state_->set_callback( & future_awaiter::ready_, this);
+    }
+
+    decltype(auto) await_resume() {
+        return f.get();
+    }
+};
+
+template< typename Channel >
+auto try_pop( Channel & chan, typename Channel::value_type & value, int)
+        -> decltype( chan.try_pop( value) ) {
+    return chan.try_pop( value);
+}
+
+template< typename Channel >
+channel_op_status try_pop( Channel &, typename Channel::value_type &, long) {
+    // unbuffered_channel
+    return channel_op_status::empty;
+}
+
+template< typename Channel >
+struct pop_awaiter : public coroutine_resumer {
+    Channel                         &   chan;
+    typename Channel::value_type    &   value;
+    channel_op_status                   status{ channel_op_status::empty };
+
+    pop_awaiter( Channel & chan_, typename Channel::value_type & value_) noexcept :
+        chan{ chan_ },
+        value{ value_ } {
+    }
+
+    bool await_ready() {
+        status = detail::try_pop( chan, value, 0);
+        return channel_op_status::empty != status;
+    }
+
+    void await_suspend( std::coroutine_handle<> h) {
+        suspend( h);
+        // the channel waits for fibers only: a fiber waits in place of
+        // the coroutine, the coroutine must not be destroyed meanwhile
+        fiber{ [this](){
+            status = chan.pop( value);
+            resume();
+        }}.detach();
+    }
+
+    channel_op_status await_resume() const noexcept {
+        return status;
+    }
+};
+
+// the coroutine is parked in the channel, which passes it the value
+template< typename T, std::size_t N, slot_layout Layout >
+struct pop_awaiter< buffered_channel< T, N, Layout > > :
+        public coroutine_resumer,
+        public buffered_channel< T, N, Layout >::pop_waiter {
+    typedef buffered_channel< T, N, Layout >            channel_type;
+    typedef typename channel_type::pop_waiter           waiter_type;
+
+    channel_type    &   chan;
+    bool                linked{ false };
+
+    static void resume_( waiter_type * w) {
+        static_cast< pop_awaiter * >( w)->resume();
+    }
+
+    pop_awaiter( channel_type & chan_, T & value_) noexcept :
+        chan{ chan_ } {
+        waiter_type::value = & value_;
+        waiter_type::fn = & pop_awaiter::resume_;
+    }
+
+    pop_awaiter( pop_awaiter const&) = delete;
+    pop_awaiter & operator=( pop_awaiter const&) = delete;
+
+    ~pop_awaiter() {
+        if ( linked) {
+            // the suspended coroutine is destroyed
+            chan.cancel_pop_( this);
+        }
+    }
+
+    bool await_ready() {
+        this->status = chan.try_pop( * this->value);
+        return channel_op_status::empty != this->status;
+    }
+
+    bool await_suspend( std::coroutine_handle<> h) noexcept {
+        suspend( h);
+        linked = chan.await_pop_( this);
+        return linked;
+    }
+
+    channel_op_status await_resume() noexcept {
+        linked = false;
+        return this->status;
+    }
+};
+
+template< typename T >
+struct task_promise_base {
+    // resumed as soon as the task is done
+    std::coroutine_handle<>     continuation{};
+    std::exception_ptr          except{};
+
+    struct final_awaiter {
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        template< typename Promise >
+        std::coroutine_handle<> await_suspend( std::coroutine_handle< Promise > h) noexcept {
+            std::coroutine_handle<> c = h.promise().continuation;
+            return c ? c : std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {
+        }
+    };
+
+    std::suspend_always initial_suspend() const noexcept {
+        return {};
+    }
+
+    final_awaiter final_suspend() const noexcept {
+        return {};
+    }
+
+    void unhandled_exception() noexcept {
+        except = std::current_exception();
+    }
+
+    task< T > get_return_object() noexcept;
+};
+
+template< typename T >
+struct task_promise : public task_promise_base< T > {
+    std::optional< T >          value{};
+
+    template< typename U >
+    void return_value( U && u) {
+        value.emplace( std::forward< U >( u) );
+    }
+
+    T result() {
+        if ( this->except) {
+            std::rethrow_exception( this->except);
+        }
+        return std::move( * value);
+    }
+};
+
+template<>
+struct task_promise< void > : public task_promise_base< void > {
+    void return_void() noexcept {
+    }
+
+    void result() {
+        if ( except) {
+            std::rethrow_exception( except);
+        }
+    }
+};
+
+// started by spawn(), destroys itself when done
+struct spawned {
+    struct promise_type : public coroutine_resumer {
+        spawned get_return_object() noexcept {
+            return spawned{ std::coroutine_handle< promise_type >::from_promise( * this) };
+        }
+
+        std::suspend_always initial_suspend() const noexcept {
+            return {};
+        }
+
+        std::suspend_never final_suspend() const noexcept {
+            return {};
+        }
+
+        void return_void() noexcept {
+        }
+
+        void unhandled_exception() noexcept {
+            std::terminate();
+        }
+    };
+
+    std::coroutine_handle< promise_type >   handle;
+};
+
+template< typename T >
+spawned spawn( task< T > t, promise< T > p) {
+    try {
+        if constexpr ( std::is_void< T >::value) {
+            co_await std::move( t);
+            p.set_value();
+        } else {
+            p.set_value( co_await std::move( t) );
+        }
+    } catch (...) {
+        p.set_exception( std::current_exception() );
+    }
+}
+
+}
+
+// a lazily started coroutine, awaitable by coroutines; fibers wait for
+// it via spawn()
+template< typename T >
+class task {
+public:
+    typedef detail::task_promise< T >   promise_type;
+
+private:
+    std::coroutine_handle< promise_type >   handle_{};
+
+public:
+    task() noexcept = default;
+
+    explicit task( std::coroutine_handle< promise_type > h) noexcept :
+        handle_{ h } {
+    }
+
+    ~task() {
+        if ( handle_) {
+            handle_.destroy();
+        }
+    }
+
+    task( task const&) = delete;
+    task & operator=( task const&) = delete;
+
+    task( task && other) noexcept :
+        handle_{ std::exchange( other.handle_, nullptr) } {
+    }
+
+    task & operator=( task && other) noexcept {
+        if ( this == & other) return * this;
+        if ( handle_) {
+            handle_.destroy();
+        }
+        handle_ = std::exchange( other.handle_, nullptr);
+        return * this;
+    }
+
+    bool valid() const noexcept {
+        return static_cast< bool >( handle_);
+    }
+
+    auto operator co_await() && noexcept {
+        struct awaiter {
+            std::coroutine_handle< promise_type >   handle;
+
+            bool await_ready() const noexcept {
+                return ! handle || handle.done();
+            }
+
+            std::coroutine_handle<> await_suspend( std::coroutine_handle<> h) noexcept {
+                // the task runs in the thread of the awaiting coroutine
+                handle.promise().continuation = h;
+                return handle;
+            }
+
+            T await_resume() {
+                if ( ! handle) {
+                    throw future_uninitialized{};
+                }
+                return handle.promise().result();
+            }
+        };
+        return awaiter{ handle_ };
+    }
+};
+
+template< typename T >
+task< T >
+detail::task_promise_base< T >::get_return_object() noexcept {
+    return task< T >{
+        std::coroutine_handle< task_promise< T > >::from_promise(
+            static_cast< task_promise< T > & >( * this) ) };
+}
+
+// a coroutine awaiting a future is resumed by the deferred runner of the
+// scheduler it has been running in, the future might be made ready by
+// any thread
+template< typename R >
+detail::future_awaiter< R > operator co_await( future< R > & f) noexcept {
+    return detail::future_awaiter< R >{ f };
+}
+
+template< typename R >
+detail::future_awaiter< R > operator co_await( future< R > && f) noexcept {
+    return detail::future_awaiter< R >{ f };
+}
+
+// co_await async_pop( chan, value) is equivalent to chan.pop( value),
+// without blocking the thread
+template< typename Channel >
+detail::pop_awaiter< Channel > async_pop( Channel & chan, typename Channel::value_type & value) noexcept {
+    return detail::pop_awaiter< Channel >{ chan, value };
+}
+
+// runs the task in the deferred runner of the scheduler; the returned
+// future is ready as soon as the task is done
+template< typename T >
+future< T > spawn( scheduler_handle const& sched, task< T > t) {
+    BOOST_ASSERT( sched);
+    if ( ! t.valid() ) {
+        throw future_uninitialized{};
+    }
+    promise< T > p;
+    future< T > f{ p.get_future() };
+    detail::spawned s{ detail::spawn( std::move( t), std::move( p) ) };
+    s.handle.promise().sched = sched.get_scheduler();
+    s.handle.promise().handle = s.handle;
+    try {
+        sched.get_scheduler()->defer( & s.handle.promise() );
+    } catch (...) {
+        s.handle.destroy();
+        throw;
+    }
+    return f;
+}
+
+template< typename T >
+future< T > spawn( task< T > t) {
+    return spawn( scheduler_handle::current(), std::move( t) );
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif
+
+#endif // BOOST_FIBERS_COROUTINE_H
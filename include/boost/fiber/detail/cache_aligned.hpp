@@ -0,0 +1,56 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_CACHE_ALIGNED_H
+#define BOOST_FIBERS_DETAIL_CACHE_ALIGNED_H
+
+#include <cstddef>
+#include <new>
+
+#include <boost/align/aligned_alloc.hpp>
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// base of types with alignas(cache_alignment) members which are allocated
+// by new; before C++17 operator new does not honour extended alignment
+struct cache_aligned {
+    static void * operator new( std::size_t size) {
+        void * vp = boost::alignment::aligned_alloc( cache_alignment, size);
+        if ( nullptr == vp) {
+            throw std::bad_alloc{};
+        }
+        return vp;
+    }
+
+    static void operator delete( void * vp) noexcept {
+        boost::alignment::aligned_free( vp);
+    }
+
+    static void * operator new[]( std::size_t size) {
+        return operator new( size);
+    }
+
+    static void operator delete[]( void * vp) noexcept {
+        operator delete( vp);
+    }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_CACHE_ALIGNED_H
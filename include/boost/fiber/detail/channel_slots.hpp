@@ -0,0 +1,98 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_CHANNEL_SLOTS_H
+#define BOOST_FIBERS_DETAIL_CHANNEL_SLOTS_H
+
+#include <atomic>
+#include <cstddef>
+#include <system_error>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/exceptions.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// ring of a buffered_channel; embedded if the capacity N is known at
+// compile time, allocated if it is given at runtime (N == 0)
+// operator[] maps an index of the channel to its slot
+template< typename Slot, std::size_t N >
+class channel_slots {
+private:
+    static_assert( 2 <= N && 0 == ( N & ( N - 1) ),
+                   "boost fiber: buffer capacity must be a power of two");
+
+    Slot    slots_[N];
+
+public:
+    channel_slots() noexcept {
+        for ( std::size_t i = 0; i < N; ++i) {
+            slots_[i].cycle.store( i, std::memory_order_relaxed);
+        }
+    }
+
+    channel_slots( channel_slots const&) = delete;
+    channel_slots & operator=( channel_slots const&) = delete;
+
+    constexpr std::size_t capacity() const noexcept {
+        return N;
+    }
+
+    Slot & operator[]( std::size_t idx) noexcept {
+        return slots_[idx & ( N - 1)];
+    }
+};
+
+template< typename Slot >
+class channel_slots< Slot, 0 > {
+private:
+    Slot        *   slots_{ nullptr };
+    std::size_t     capacity_;
+
+public:
+    explicit channel_slots( std::size_t capacity) :
+        capacity_{ capacity } {
+        if ( 2 > capacity_ || 0 != ( capacity_ & (capacity_ - 1) ) ) {
+            throw fiber_error( std::make_error_code( std::errc::invalid_argument),
+                               "boost fiber: buffer capacity is invalid");
+        }
+        slots_ = new Slot[capacity_]();
+        for ( std::size_t i = 0; i < capacity_; ++i) {
+            slots_[i].cycle.store( i, std::memory_order_relaxed);
+        }
+    }
+
+    ~channel_slots() {
+        delete [] slots_;
+    }
+
+    channel_slots( channel_slots const&) = delete;
+    channel_slots & operator=( channel_slots const&) = delete;
+
+    std::size_t capacity() const noexcept {
+        return capacity_;
+    }
+
+    Slot & operator[]( std::size_t idx) noexcept {
+        return slots_[idx & ( capacity_ - 1)];
+    }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_CHANNEL_SLOTS_H
@@ -42,6 +42,11 @@
 # define BOOST_FIBERS_HAS_FUTEX
 #endif
 
+// a thread might be interrupted by pthread_kill(), see monitor
+#if BOOST_OS_LINUX || BOOST_OS_MACOS || BOOST_OS_BSD
+# define BOOST_FIBERS_HAS_PTHREAD_KILL
+#endif
+
 #if (!defined(BOOST_FIBERS_HAS_FUTEX) && \
     (defined(BOOST_FIBERS_SPINLOCK_TTAS_FUTEX) || defined(BOOST_FIBERS_SPINLOCK_TTAS_ADAPTIVE_FUTEX)))
 # error "futex not supported on this platform"
@@ -55,6 +60,26 @@
 # define BOOST_FIBERS_SPIN_MAX_TESTS 100
 #endif
 
+// return address of the calling function, i.e. the call site of the
+// function using it (or of the function it has been inlined into)
+#if defined(BOOST_GCC) || defined(BOOST_CLANG)
+# define BOOST_FIBERS_CALLER __builtin_return_address( 0)
+#elif defined(BOOST_MSVC)
+# include <intrin.h>
+# define BOOST_FIBERS_CALLER _ReturnAddress()
+#else
+# define BOOST_FIBERS_CALLER nullptr
+#endif
+
+// frame address of the calling function, approximately its stack pointer
+#if defined(BOOST_GCC) || defined(BOOST_CLANG)
+# define BOOST_FIBERS_FRAME __builtin_frame_address( 0)
+#elif defined(BOOST_MSVC)
+# define BOOST_FIBERS_FRAME _AddressOfReturnAddress()
+#else
+# define BOOST_FIBERS_FRAME nullptr
+#endif
+
 // modern architectures have cachelines with 64byte length
 // ARM Cortex-A15 32/64byte, Cortex-A9 16/32/64bytes
 // MIPS 74K: 32byte, 4KEc: 16byte
@@ -65,6 +65,15 @@ public:
         prev->remote_nxt_.store( ctx, std::memory_order_release);
     }
 
+    // pushes the chain first..last, linked via remote_nxt_, at once
+    void push( context * first, context * last) noexcept {
+        BOOST_ASSERT( nullptr != first);
+        BOOST_ASSERT( nullptr != last);
+        last->remote_nxt_.store( nullptr, std::memory_order_release);
+        context * prev = head_.exchange( last, std::memory_order_acq_rel);
+        prev->remote_nxt_.store( first, std::memory_order_release);
+    }
+
     context * pop() noexcept {
         context * tail = tail_;
         context * next = tail->remote_nxt_.load( std::memory_order_acquire);
@@ -120,6 +120,13 @@ public:
         return bottom <= top;
     }
 
+    // approximate if called concurrently with pop()
+    std::size_t size() const noexcept {
+        std::size_t bottom{ bottom_.load( std::memory_order_relaxed) };
+        std::size_t top{ top_.load( std::memory_order_relaxed) };
+        return bottom > top ? bottom - top : 0;
+    }
+
     void push( context * ctx) {
         std::size_t bottom{ bottom_.load( std::memory_order_relaxed) };
         std::size_t top{ top_.load( std::memory_order_acquire) };
@@ -22,6 +22,10 @@ namespace boost {
 namespace fibers {
 namespace detail {
 
+// the clock of the scheduler running in this thread
+BOOST_FIBERS_DECL
+std::chrono::steady_clock::time_point now() noexcept;
+
 inline
 std::chrono::steady_clock::time_point convert(
         std::chrono::steady_clock::time_point const& timeout_time) noexcept {
@@ -31,7 +35,7 @@ std::chrono::steady_clock::time_point convert(
 template< typename Clock, typename Duration >
 std::chrono::steady_clock::time_point convert(
         std::chrono::time_point< Clock, Duration > const& timeout_time) {
-    return std::chrono::steady_clock::now() + ( timeout_time - Clock::now() );
+    return detail::now() + ( timeout_time - Clock::now() );
 }
 
 // suggested by Howard Hinnant
@@ -0,0 +1,43 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_DEFERRED_H
+#define BOOST_FIBERS_DETAIL_DEFERRED_H
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// a function run by the deferred runner of a scheduler (see
+// scheduler::defer()), e.g. resuming a C++20 coroutine
+// the node is owned by the caller and linked intrusively, it must be
+// valid until fn is called; fn must not throw
+struct deferred {
+    deferred    *   next{ nullptr };
+    void        ( * fn)( deferred *){ nullptr };
+
+    deferred() noexcept = default;
+
+    explicit deferred( void ( * fn_)( deferred *) ) noexcept :
+        fn{ fn_ } {
+    }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_DEFERRED_H
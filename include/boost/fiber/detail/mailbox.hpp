@@ -0,0 +1,126 @@
+
+//          Copyright Dmitry Vyukov 2010-2011.
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+// based on Dmitry Vyukov's intrusive MPSC queue
+// http://www.1024cores.net/home/lock-free-algorithms/queues/intrusive-mpsc-node-based-queue
+
+#ifndef BOOST_FIBERS_DETAIL_MAILBOX_H
+#define BOOST_FIBERS_DETAIL_MAILBOX_H
+
+#include <atomic>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+struct mailbox_node {
+    std::atomic< mailbox_node * >   nxt_{ nullptr };
+
+    virtual ~mailbox_node() {}
+};
+
+// intrusive MPSC queue, modelled on context_mpsc_queue
+// the consumer marks the empty queue as idle before it suspends;
+// the producer learns from its single exchange whether the consumer
+// has to be woken up
+class mailbox {
+private:
+    mailbox_node                                        dummy_{};
+    // never linked, its address marks the idle consumer
+    mailbox_node                                        idle_{};
+    alignas(cache_alignment) std::atomic< mailbox_node * >  head_;
+    alignas(cache_alignment) mailbox_node               *   tail_;
+    char                                                pad_[cacheline_length];
+
+    void push_( mailbox_node * node) noexcept {
+        node->nxt_.store( nullptr, std::memory_order_relaxed);
+        mailbox_node * prev = head_.exchange( node, std::memory_order_acq_rel);
+        prev->nxt_.store( node, std::memory_order_release);
+    }
+
+public:
+    mailbox() noexcept :
+        head_{ & dummy_ },
+        tail_{ & dummy_ } {
+    }
+
+    mailbox( mailbox const&) = delete;
+    mailbox & operator=( mailbox const&) = delete;
+
+    // returns true if the consumer is idle and has to be woken up
+    bool push( mailbox_node * node) noexcept {
+        BOOST_ASSERT( nullptr != node);
+        node->nxt_.store( nullptr, std::memory_order_relaxed);
+        mailbox_node * prev = head_.exchange( node, std::memory_order_acq_rel);
+        if ( & idle_ == prev) {
+            // the idle marker stands for the empty queue (dummy_)
+            dummy_.nxt_.store( node, std::memory_order_release);
+            return true;
+        }
+        prev->nxt_.store( node, std::memory_order_release);
+        return false;
+    }
+
+    mailbox_node * pop() noexcept {
+        mailbox_node * tail = tail_;
+        mailbox_node * next = tail->nxt_.load( std::memory_order_acquire);
+        if ( & dummy_ == tail) {
+            if ( nullptr == next) {
+                return nullptr;
+            }
+            tail_ = next;
+            tail = next;
+            next = next->nxt_.load( std::memory_order_acquire);
+        }
+        if ( nullptr != next) {
+            tail_ = next;
+            return tail;
+        }
+        mailbox_node * head = head_.load( std::memory_order_acquire);
+        if ( tail != head) {
+            // a producer has not yet linked its node
+            return nullptr;
+        }
+        push_( & dummy_);
+        next = tail->nxt_.load( std::memory_order_acquire);
+        if ( nullptr != next) {
+            tail_ = next;
+            return tail;
+        }
+        return nullptr;
+    }
+
+    // marks the consumer as idle if the queue is empty; the next push()
+    // returns true then
+    bool try_idle() noexcept {
+        if ( & dummy_ != tail_ ||
+             nullptr != dummy_.nxt_.load( std::memory_order_acquire) ) {
+            return false;
+        }
+        mailbox_node * expected = & dummy_;
+        return head_.compare_exchange_strong( expected, & idle_,
+                                              std::memory_order_acq_rel,
+                                              std::memory_order_relaxed);
+    }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_MAILBOX_H
@@ -0,0 +1,101 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_SPSC_RING_H
+#define BOOST_FIBERS_DETAIL_SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/cache_aligned.hpp>
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// bounded single-producer/single-consumer ring (Lamport)
+// producer and consumer cache the index of the other side, so that
+// the shared cachelines are only touched if the ring seems full/empty
+template< typename T >
+class spsc_ring : public cache_aligned {
+private:
+    alignas(cache_alignment) std::atomic< std::size_t >    head_{ 0 };
+    // consumer's copy of tail_
+    std::size_t                                             tail_cached_{ 0 };
+    alignas(cache_alignment) std::atomic< std::size_t >    tail_{ 0 };
+    // producer's copy of head_
+    std::size_t                                             head_cached_{ 0 };
+    alignas(cache_alignment) std::size_t                   capacity_;
+    std::unique_ptr< T[] >                                  slots_;
+
+public:
+    explicit spsc_ring( std::size_t capacity) :
+        capacity_{ capacity },
+        slots_{ new T[capacity] } {
+        BOOST_ASSERT( 0 < capacity_);
+        BOOST_ASSERT( 0 == ( capacity_ & ( capacity_ - 1) ) );
+    }
+
+    spsc_ring( spsc_ring const&) = delete;
+    spsc_ring & operator=( spsc_ring const&) = delete;
+
+    // called by the producer; returns false if the ring is full
+    // was_empty is set if the consumer had consumed all items pushed
+    // before, e.g. the consumer might wait for new items
+    bool push( T value, bool & was_empty) noexcept {
+        std::size_t tail = tail_.load( std::memory_order_relaxed);
+        if ( capacity_ == tail - head_cached_) {
+            head_cached_ = head_.load( std::memory_order_acquire);
+            if ( capacity_ == tail - head_cached_) {
+                return false;
+            }
+        }
+        slots_[tail & ( capacity_ - 1)] = value;
+        // store-load ordering with the consumer: either the consumer sees
+        // the new item or the producer sees that the ring was drained
+        tail_.store( tail + 1, std::memory_order_seq_cst);
+        head_cached_ = head_.load( std::memory_order_seq_cst);
+        was_empty = head_cached_ == tail;
+        return true;
+    }
+
+    // called by the consumer; returns false if the ring is empty
+    bool pop( T & value) noexcept {
+        std::size_t head = head_.load( std::memory_order_relaxed);
+        if ( head == tail_cached_) {
+            // orders the preceding store to head_ (see push())
+            std::atomic_thread_fence( std::memory_order_seq_cst);
+            tail_cached_ = tail_.load( std::memory_order_seq_cst);
+            if ( head == tail_cached_) {
+                return false;
+            }
+        }
+        value = slots_[head & ( capacity_ - 1)];
+        head_.store( head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const noexcept {
+        return head_.load( std::memory_order_acquire) == tail_.load( std::memory_order_acquire);
+    }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_SPSC_RING_H
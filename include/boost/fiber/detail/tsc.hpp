@@ -0,0 +1,70 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_TSC_H
+#define BOOST_FIBERS_DETAIL_TSC_H
+
+#include <chrono>
+#include <cstdint>
+
+#include <boost/config.hpp>
+#include <boost/predef.h> 
+
+#include <boost/fiber/detail/config.hpp>
+
+#if BOOST_ARCH_X86
+# if BOOST_COMP_MSVC
+#  include <intrin.h>
+# else
+#  include <x86intrin.h>
+# endif
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// cheap, monotonic tick counter: the time-stamp counter on x86 (invariant
+// on current CPUs), the steady_clock in nanoseconds otherwise; ticks are
+// converted by calibrating against the steady_clock
+inline
+std::uint64_t tsc() noexcept {
+#if BOOST_ARCH_X86
+    return __rdtsc();
+#else
+    return static_cast< std::uint64_t >(
+        std::chrono::duration_cast< std::chrono::nanoseconds >(
+            std::chrono::steady_clock::now().time_since_epoch() ).count() );
+#endif
+}
+
+// pair of samples of tsc() and the steady_clock
+struct tsc_sample {
+    std::uint64_t                           ticks{ tsc() };
+    std::chrono::steady_clock::time_point   time{ std::chrono::steady_clock::now() };
+};
+
+// ticks per nanosecond between two samples
+inline
+double tsc_rate( tsc_sample const& from, tsc_sample const& to) noexcept {
+    std::chrono::steady_clock::rep ns =
+        std::chrono::duration_cast< std::chrono::nanoseconds >( to.time - from.time).count();
+    return ( 0 < ns && from.ticks < to.ticks)
+        ? static_cast< double >( to.ticks - from.ticks) / ns
+        : 1.;
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_TSC_H
@@ -0,0 +1,127 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_ELASTIC_POOL_H
+#define BOOST_FIBERS_ELASTIC_POOL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <boost/config.hpp>
+#include <boost/intrusive_ptr.hpp>
+
+#include <boost/fiber/algo/work_stealing.hpp>
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/fixedsize_stack.hpp>
+#include <boost/fiber/policy.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+
+// pool of threads running algo::work_stealing; the number of threads
+// follows the load: a thread is added if fibers queue up while no thread
+// is idle, a thread is retired if the threads are mostly idle
+// a retiring thread passes its ready fibers to the remaining threads
+class BOOST_FIBERS_DECL elastic_pool {
+private:
+    struct worker;
+
+    std::size_t                                 min_threads_;
+    std::size_t                                 max_threads_;
+    std::chrono::steady_clock::duration         interval_;
+    // the threads of the pool steal only from each other
+    std::shared_ptr< algo::work_stealing::group >   group_{ algo::work_stealing::make_group() };
+    mutable std::mutex                          mtx_{};
+    std::condition_variable                     cnd_{};
+    bool                                        shutdown_{ false };
+    std::size_t                                 next_{ 0 };
+    // consecutive samples the threads were mostly idle
+    std::size_t                                 idle_samples_{ 0 };
+    std::vector< std::unique_ptr< worker > >    active_{};
+    std::vector< std::unique_ptr< worker > >    retiring_{};
+    std::thread                                 controller_{};
+
+    static void run_( worker *) noexcept;
+
+    void run_controller_() noexcept;
+
+    void adapt_( std::unique_lock< std::mutex > &);
+
+    void add_( std::unique_lock< std::mutex > &);
+
+    void retire_( std::unique_lock< std::mutex > &) noexcept;
+
+    void join_retired_( std::unique_lock< std::mutex > &) noexcept;
+
+    void post_( context *) noexcept;
+
+public:
+    // starts min_threads threads; the load is sampled every interval,
+    // a zero interval disables the automatic adaption
+    elastic_pool( std::size_t min_threads, std::size_t max_threads,
+                  std::chrono::steady_clock::duration const& interval =
+                        std::chrono::milliseconds( 10) );
+
+    elastic_pool( elastic_pool const&) = delete;
+    elastic_pool & operator=( elastic_pool const&) = delete;
+
+    // retires all threads and joins them, the fibers are completed before
+    ~elastic_pool();
+
+    template< typename Fn, typename ... Args >
+    void post( Fn && fn, Args && ... args) {
+        post( std::allocator_arg, default_stack(),
+              std::forward< Fn >( fn), std::forward< Args >( args) ... );
+    }
+
+    // launches a fiber in the pool, might be called from any thread
+    template< typename StackAllocator, typename Fn, typename ... Args >
+    void post( std::allocator_arg_t, StackAllocator salloc, Fn && fn, Args && ... args) {
+        intrusive_ptr< context > ctx{
+            make_worker_context( launch::post, salloc,
+                                 std::forward< Fn >( fn), std::forward< Args >( args) ... ) };
+        // the remaining reference is owned by the scheduler,
+        // as for a detached fiber
+        post_( ctx.get() );
+    }
+
+    // number of threads not retiring
+    std::size_t size() const noexcept;
+
+    // adds a thread; returns false if max_threads are running
+    bool grow();
+
+    // retires a thread; returns false if min_threads are running
+    bool shrink() noexcept;
+};
+
+}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_ELASTIC_POOL_H
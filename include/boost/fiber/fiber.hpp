@@ -125,6 +125,13 @@ public:
         return nullptr != impl_;
     }
 
+    // CPU time, switches and time spent ready; not available after
+    // join() or detach()
+    fiber_stats stats() const noexcept {
+        BOOST_ASSERT( impl_);
+        return impl_->stats();
+    }
+
     void join();
 
     void detach();
@@ -0,0 +1,99 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_FIBER_DUMP_H
+#define BOOST_FIBERS_FIBER_DUMP_H
+
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
+#include <thread>
+#include <vector>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+enum class fiber_state {
+    running = 0,
+    ready,
+    // blocked on a synchronization primitive, join() or suspended by
+    // the scheduling algorithm
+    blocked,
+    sleeping
+};
+
+struct fiber_info {
+    context::id                                 id{};
+    fiber_state                                 state{ fiber_state::ready };
+    // the main fiber of the thread
+    bool                                        main{ false };
+    // what a blocked fiber waits for (none if unknown), and on which primitive
+    block_reason                                reason{ block_reason::none };
+    void const                              *   object{ nullptr };
+    // the deadline of a sleeping fiber or of a timed wait, max() if none
+    std::chrono::steady_clock::time_point       deadline{ (std::chrono::steady_clock::time_point::max)() };
+    // zero for the main fiber
+    std::size_t                                 stack_size{ 0 };
+    std::size_t                                 stack_used{ 0 };
+    // return addresses of a suspended fiber, innermost first
+    std::vector< void * >                       backtrace{};
+    // CPU time, switches and time spent ready (if BOOST_FIBERS_STATS)
+    fiber_stats                                 stats{};
+};
+
+struct scheduler_dump {
+    std::thread::id                             thread_id{};
+    // false if the scheduler did not respond in time, e.g. because a fiber
+    // does not yield; fibers contains only the running fiber then
+    bool                                        complete{ false };
+    std::vector< fiber_info >                   fibers{};
+};
+
+namespace detail {
+
+// stores up to max return addresses of the frames starting at frame
+// pointer fp, reading only inside [bottom, top); async-signal-safe
+BOOST_FIBERS_DECL
+std::size_t walk_frames( void * fp, void * bottom, void * top, void ** frames, std::size_t max) noexcept;
+
+// called by the thread of the scheduler of ctx
+BOOST_FIBERS_DECL
+fiber_info describe( context * ctx, bool active, bool backtrace);
+
+}
+
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+// the fibers of all threads; each scheduler walks its own fibers (in a
+// fiber run by the scheduler), the schedulers are not stopped together
+// backtraces are taken by following the frame pointers, i.e. the code
+// has to be built with -fno-omit-frame-pointer
+BOOST_FIBERS_DECL
+std::vector< scheduler_dump > dump_fibers( std::chrono::milliseconds timeout = std::chrono::milliseconds( 100),
+                                           bool backtraces = false);
+#endif
+
+BOOST_FIBERS_DECL
+std::ostream & operator<<( std::ostream &, fiber_state);
+
+BOOST_FIBERS_DECL
+std::ostream & operator<<( std::ostream &, scheduler_dump const&);
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_FIBER_DUMP_H
@@ -38,6 +38,9 @@ class shared_state_base {
 private:
     std::atomic< std::size_t >  use_count_{ 0 };
     mutable condition_variable  waiters_{};
+    // called once the state became ready, see set_callback()
+    void                    ( * callback_)( void *){ nullptr };
+    void                    *   callback_arg_{ nullptr };
 
 protected:
     mutable mutex       mtx_{};
@@ -47,8 +50,13 @@ protected:
     void mark_ready_and_notify_( std::unique_lock< mutex > & lk) noexcept {
         BOOST_ASSERT( lk.owns_lock() );
         ready_ = true;
+        void ( * callback)( void *) = callback_;
+        callback_ = nullptr;
         lk.unlock();
         waiters_.notify_all();
+        if ( nullptr != callback) {
+            callback( callback_arg_);
+        }
     }
 
     void owner_destroyed_( std::unique_lock< mutex > & lk) {
@@ -123,6 +131,21 @@ public:
         return get_exception_ptr_( lk);
     }
 
+    // registers fn( arg) to be called by the thread making the state
+    // ready, instead of waiting for it (e.g. to resume a coroutine);
+    // returns false if the state is already ready
+    // fn must not throw, one callback at most
+    bool set_callback( void ( * fn)( void *), void * arg) {
+        std::unique_lock< mutex > lk( mtx_);
+        if ( ready_) {
+            return false;
+        }
+        BOOST_ASSERT( nullptr == callback_);
+        callback_ = fn;
+        callback_arg_ = arg;
+        return true;
+    }
+
     void wait() const {
         std::unique_lock< mutex > lk( mtx_);
         wait_( lk);
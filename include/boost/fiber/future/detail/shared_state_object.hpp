@@ -43,7 +43,7 @@ private:
 
     static void destroy_( allocator_t const& alloc, shared_state_object * p) noexcept {
         allocator_t a{ alloc };
-        a.destroy( p);
+        std::allocator_traits< allocator_t >::destroy( a, p);
         a.deallocate( p, 1);
     }
 };
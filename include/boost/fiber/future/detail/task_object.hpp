@@ -81,7 +81,7 @@ private:
 
     static void destroy_( allocator_t const& alloc, task_object * p) noexcept {
         allocator_t a{ alloc };
-        a.destroy( p);
+        std::allocator_traits< allocator_t >::destroy( a, p);
         a.deallocate( p, 1);
     }
 };
@@ -142,7 +142,7 @@ private:
 
     static void destroy_( allocator_t const& alloc, task_object * p) noexcept {
         allocator_t a{ alloc };
-        a.destroy( p);
+        std::allocator_traits< allocator_t >::destroy( a, p);
         a.deallocate( p, 1);
     }
 };
@@ -96,6 +96,9 @@ struct future_base {
 template< typename R >
 struct promise_base;
 
+template< typename R >
+struct future_awaiter;
+
 }
 
 template< typename R >
@@ -113,6 +116,7 @@ private:
     friend class shared_future< R >;
     template< typename Signature >
     friend class packaged_task;
+    friend struct detail::future_awaiter< R >;
 
     explicit future( typename base_t::ptr_t const& p) noexcept :
         base_t{ p } {
@@ -161,6 +165,7 @@ private:
     friend class shared_future< R & >;
     template< typename Signature >
     friend class packaged_task;
+    friend struct detail::future_awaiter< R & >;
 
     explicit future( typename base_t::ptr_t const& p) noexcept :
         base_t{ p  } {
@@ -209,6 +214,7 @@ private:
     friend class shared_future< void >;
     template< typename Signature >
     friend class packaged_task;
+    friend struct detail::future_awaiter< void >;
 
     explicit future( base_t::ptr_t const& p) noexcept :
         base_t{ p } {
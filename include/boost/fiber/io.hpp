@@ -0,0 +1,99 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_IO_H
+#define BOOST_FIBERS_IO_H
+
+#include <chrono>
+#include <cstddef>
+#include <system_error>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/algo/epoll.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/convert.hpp>
+#include <boost/fiber/exceptions.hpp>
+
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+inline
+algo::epoll * epoll_instance() {
+    algo::epoll * ep = algo::epoll::instance();
+    if ( nullptr == ep) {
+        throw fiber_error{
+                std::make_error_code( std::errc::operation_not_supported),
+                "boost fiber: epoll scheduling algorithm not in use" };
+    }
+    return ep;
+}
+
+}
+
+// fiber-blocking wrappers of the POSIX functions
+// fd must be in non-blocking mode; the calling fiber is suspended
+// instead of the thread if the operation would block
+// errors are reported via return value and errno
+BOOST_FIBERS_DECL
+::ssize_t read( int fd, void * buf, std::size_t count);
+
+BOOST_FIBERS_DECL
+::ssize_t write( int fd, void const* buf, std::size_t count);
+
+// the accepted socket is created in non-blocking mode
+BOOST_FIBERS_DECL
+int accept( int fd, ::sockaddr * addr, ::socklen_t * addrlen);
+
+// removes fd from the epoll instance before closing it
+BOOST_FIBERS_DECL
+int close( int fd);
+
+}
+
+namespace this_fiber {
+
+template< typename Clock, typename Duration >
+bool wait_readable( int fd, std::chrono::time_point< Clock, Duration > const& timeout_time_) {
+    std::chrono::steady_clock::time_point timeout_time(
+            fibers::detail::convert( timeout_time_) );
+    return fibers::detail::epoll_instance()->wait( fd, EPOLLIN, timeout_time);
+}
+
+inline
+void wait_readable( int fd) {
+    fibers::detail::epoll_instance()->wait(
+            fd, EPOLLIN, (std::chrono::steady_clock::time_point::max)() );
+}
+
+template< typename Clock, typename Duration >
+bool wait_writable( int fd, std::chrono::time_point< Clock, Duration > const& timeout_time_) {
+    std::chrono::steady_clock::time_point timeout_time(
+            fibers::detail::convert( timeout_time_) );
+    return fibers::detail::epoll_instance()->wait( fd, EPOLLOUT, timeout_time);
+}
+
+inline
+void wait_writable( int fd) {
+    fibers::detail::epoll_instance()->wait(
+            fd, EPOLLOUT, (std::chrono::steady_clock::time_point::max)() );
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_IO_H
@@ -0,0 +1,179 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_LATENCY_HISTOGRAM_H
+#define BOOST_FIBERS_LATENCY_HISTOGRAM_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+// histogram of durations with log-linear buckets (as HdrHistogram): the
+// values below 64ns are counted exactly, above each power of two is split
+// into 32 buckets, i.e. a value is known with a relative error < 1/64;
+// values above ~68s are counted as ~68s
+class latency_histogram {
+public:
+    static constexpr std::size_t    sub_bucket_bits = 5;
+    static constexpr std::size_t    sub_buckets = std::size_t{ 1 } << sub_bucket_bits;
+    static constexpr std::size_t    max_bits = 36;
+    static constexpr std::size_t    buckets = 2 * sub_buckets + ( max_bits - sub_bucket_bits - 1) * sub_buckets;
+
+    static std::size_t index( std::uint64_t ns) noexcept {
+        if ( ns < 2 * sub_buckets) {
+            return static_cast< std::size_t >( ns);
+        }
+        ns = ( std::min)( ns, ( std::uint64_t{ 1 } << max_bits) - 1);
+#if defined(BOOST_GCC) || defined(BOOST_CLANG)
+        std::size_t msb = 63 - static_cast< std::size_t >( __builtin_clzll( ns) );
+#else
+        std::size_t msb = 0;
+        for ( std::uint64_t v = ns; 1 < v; v >>= 1) {
+            ++msb;
+        }
+#endif
+        std::size_t shift = msb - sub_bucket_bits;
+        return 2 * sub_buckets + ( shift - 1) * sub_buckets +
+            static_cast< std::size_t >( ( ns >> shift) - sub_buckets);
+    }
+
+    // the middle of the values counted in bucket idx
+    static std::uint64_t value( std::size_t idx) noexcept {
+        if ( idx < 2 * sub_buckets) {
+            return idx;
+        }
+        std::size_t shift = ( idx - 2 * sub_buckets) / sub_buckets + 1;
+        std::uint64_t sub = ( idx - 2 * sub_buckets) % sub_buckets + sub_buckets;
+        return ( sub << shift) + ( std::uint64_t{ 1 } << ( shift - 1) );
+    }
+
+private:
+    // empty if nothing has been recorded
+    std::vector< std::uint64_t >    counts_{};
+    std::uint64_t                   count_{ 0 };
+    std::uint64_t                   max_{ 0 };
+
+public:
+    latency_histogram() = default;
+
+    void record( std::chrono::nanoseconds d, std::uint64_t n = 1) {
+        std::uint64_t ns = static_cast< std::uint64_t >( ( std::max)( d.count(), std::chrono::nanoseconds::rep{ 0 }) );
+        record_bucket( index( ns), n);
+        max_ = ( std::max)( max_, ns);
+    }
+
+    void record_bucket( std::size_t idx, std::uint64_t n) {
+        if ( 0 == n) {
+            return;
+        }
+        if ( counts_.empty() ) {
+            counts_.resize( buckets, 0);
+        }
+        counts_[idx] += n;
+        count_ += n;
+    }
+
+    void record_max( std::uint64_t ns) noexcept {
+        max_ = ( std::max)( max_, ns);
+    }
+
+    // adds the values of other, e.g. of the schedulers of all threads
+    void merge( latency_histogram const& other) {
+        for ( std::size_t i = 0; i < other.counts_.size(); ++i) {
+            record_bucket( i, other.counts_[i]);
+        }
+        max_ = ( std::max)( max_, other.max_);
+    }
+
+    std::uint64_t count() const noexcept {
+        return count_;
+    }
+
+    std::chrono::nanoseconds max() const noexcept {
+        return std::chrono::nanoseconds( max_);
+    }
+
+    // the value below which p percent of the values lie, e.g. 99.9
+    std::chrono::nanoseconds percentile( double p) const noexcept {
+        if ( 0 == count_) {
+            return std::chrono::nanoseconds::zero();
+        }
+        std::uint64_t rank = static_cast< std::uint64_t >( p / 100. * count_ + .5);
+        rank = ( std::max)( std::uint64_t{ 1 }, ( std::min)( rank, count_) );
+        std::uint64_t seen = 0;
+        for ( std::size_t i = 0; i < counts_.size(); ++i) {
+            seen += counts_[i];
+            if ( rank <= seen) {
+                return std::chrono::nanoseconds( ( std::min)( value( i), max_) );
+            }
+        }
+        return max();
+    }
+
+    std::chrono::nanoseconds p50() const noexcept {
+        return percentile( 50.);
+    }
+
+    std::chrono::nanoseconds p99() const noexcept {
+        return percentile( 99.);
+    }
+
+    std::chrono::nanoseconds p999() const noexcept {
+        return percentile( 99.9);
+    }
+};
+
+namespace detail {
+
+// the buckets of a latency_histogram (~8KB), written by one thread and
+// read by any thread; part of the scheduler counters, which exist only if
+// the library is built with BOOST_FIBERS_STATS
+struct latency_buckets {
+    std::atomic< std::uint64_t >    counts[latency_histogram::buckets]{};
+    std::atomic< std::uint64_t >    max{ 0 };
+
+    void record( std::chrono::nanoseconds d) noexcept {
+        std::uint64_t ns = static_cast< std::uint64_t >( ( std::max)( d.count(), std::chrono::nanoseconds::rep{ 0 }) );
+        std::atomic< std::uint64_t > & c = counts[latency_histogram::index( ns)];
+        c.store( c.load( std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if ( max.load( std::memory_order_relaxed) < ns) {
+            max.store( ns, std::memory_order_relaxed);
+        }
+    }
+
+    latency_histogram snapshot() const {
+        latency_histogram h;
+        for ( std::size_t i = 0; i < latency_histogram::buckets; ++i) {
+            h.record_bucket( i, counts[i].load( std::memory_order_relaxed) );
+        }
+        h.record_max( max.load( std::memory_order_relaxed) );
+        return h;
+    }
+};
+
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_LATENCY_HISTOGRAM_H
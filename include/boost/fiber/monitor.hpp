@@ -0,0 +1,103 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_MONITOR_H
+#define BOOST_FIBERS_MONITOR_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+
+// a fiber that did not give up its thread for longer than the threshold
+struct blocked_fiber {
+    std::thread::id                         thread_id;
+    context::id                             fiber_id;
+    std::chrono::steady_clock::duration     duration;
+    // number of ready fibers handed over to the spare thread
+    std::size_t                             handed_off;
+    // return address in the code that launched the fiber, null if unknown
+    void const                          *   spawn_site{ nullptr };
+    // return addresses of the blocking fiber, innermost first, sampled by
+    // interrupting the thread with a signal (if enabled)
+    std::vector< void * >                   backtrace{};
+};
+
+// watches the schedulers of all threads from a separate thread
+// a thread that did not switch context for longer than the threshold
+// is reported; if handoff is enabled, the ready fibers of that thread
+// are moved to a spare thread (requires algorithm::steal(), e.g.
+// algo::work_stealing); if sample_signal is not zero, the blocked thread
+// is interrupted by that signal and the stack of the blocking fiber is
+// sampled by the signal handler
+class BOOST_FIBERS_DECL monitor {
+public:
+    typedef std::function< void( blocked_fiber const&) >    report_fn;
+
+private:
+    std::chrono::steady_clock::duration     threshold_;
+    report_fn                               report_;
+    bool                                    handoff_;
+    int                                     sample_signal_;
+    std::mutex                              mtx_{};
+    std::condition_variable                 cnd_{};
+    condition_variable_any                  spare_cnd_{};
+    std::vector< context * >                handed_{};
+    bool                                    shutdown_{ false };
+    std::thread                             spare_{};
+    std::thread                             thread_{};
+
+    void run_() noexcept;
+
+    void run_spare_() noexcept;
+
+public:
+    // report defaults to a message written to std::cerr
+    explicit monitor( std::chrono::steady_clock::duration const& threshold,
+                      report_fn report = report_fn{},
+                      bool handoff = false,
+                      int sample_signal = 0);
+
+    monitor( monitor const&) = delete;
+    monitor & operator=( monitor const&) = delete;
+
+    // joins the spare thread, which first runs the fibers handed over
+    // to it to completion
+    ~monitor();
+};
+
+}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_MONITOR_H
@@ -0,0 +1,151 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_OBSERVER_H
+#define BOOST_FIBERS_OBSERVER_H
+
+#include <chrono>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+class scheduler;
+
+enum class event_type {
+    // a fiber has been attached to a scheduler (launched or posted)
+    spawn = 0,
+    // a fiber is resumed, the previous one switched out
+    resume,
+    // a fiber is made ready by a fiber of the same thread, or by
+    // the dispatcher because its deadline was reached
+    ready,
+    // a fiber is made ready by another thread
+    remote_ready,
+    // a fiber is about to block
+    block,
+    // a fiber has terminated
+    terminate,
+    // a fiber has been stolen by the scheduler of the calling thread
+    steal
+};
+
+struct event {
+    event_type                                  type;
+    block_reason                                reason;
+    // the fiber the event applies to
+    context::id                                 id;
+    // the active fiber issuing the event: the previous fiber (resume) or
+    // the fiber waking id (ready, remote_ready)
+    context::id                                 from;
+    // the scheduler of id
+    scheduler                               *   sched;
+    std::chrono::steady_clock::time_point       timestamp;
+    // the synchronization primitive (block)
+    void const                              *   object;
+    // return address into the code calling the blocking function (block),
+    // null if not known
+    void const                              *   caller;
+};
+
+// called by the thread issuing an event; events are reported only if
+// the library is built with BOOST_FIBERS_HOOKS
+class BOOST_FIBERS_DECL observer {
+private:
+    bool    timestamps_;
+
+public:
+    // an observer taking its own timestamps saves reading the
+    // steady_clock for each event (event::timestamp is zero)
+    explicit observer( bool timestamps = true) noexcept :
+        timestamps_{ timestamps } {
+    }
+
+    virtual ~observer() {}
+
+    bool timestamps() const noexcept {
+        return timestamps_;
+    }
+
+    // called for each event with its parts; builds the event and calls
+    // on_event(), an observer overriding it saves building the event
+    virtual void record( event_type, context *, context *, block_reason,
+                         void const *, void const *) noexcept;
+
+    // must neither block nor call functions of the library which
+    // might suspend the calling fiber
+    virtual void on_event( event const&) noexcept = 0;
+};
+
+// installs the observer of all threads, returns the previous one
+BOOST_FIBERS_DECL
+observer * set_observer( observer *) noexcept;
+
+namespace detail {
+
+BOOST_FIBERS_DECL
+char const* reason_name( block_reason) noexcept;
+
+// reports an event to the installed observer; does nothing if the library
+// has been built without BOOST_FIBERS_HOOKS
+BOOST_FIBERS_DECL
+void notify_observer( event_type, context *, context *, block_reason, void const *, void const *) noexcept;
+
+// block point of the templates (channels, condition variables); the same
+// in every translation unit, the library decides whether it is reported
+inline
+void observe_block( context * ctx, block_reason reason, void const * object,
+                    void const * caller) noexcept {
+    // the reason a fiber blocks is kept for fiber_info in any case
+    ctx->wait_reason_ = reason;
+    ctx->wait_object_ = object;
+    notify_observer( event_type::block, ctx, ctx, reason, object, caller);
+}
+
+#if defined(BOOST_FIBERS_SOURCE)
+// events issued by the library itself; all of its translation units are
+// built either with or without BOOST_FIBERS_HOOKS
+#if defined(BOOST_FIBERS_HOOKS)
+inline
+void observe( event_type type, context * ctx, context * from,
+              block_reason reason = block_reason::none, void const * object = nullptr,
+              void const * caller = nullptr) noexcept {
+    if ( event_type::block == type) {
+        ctx->wait_reason_ = reason;
+        ctx->wait_object_ = object;
+    }
+    notify_observer( type, ctx, from, reason, object, caller);
+}
+#else
+inline
+void observe( event_type type, context * ctx, context *,
+              block_reason reason = block_reason::none, void const * object = nullptr,
+              void const * = nullptr) noexcept {
+    if ( event_type::block == type) {
+        ctx->wait_reason_ = reason;
+        ctx->wait_object_ = object;
+    }
+}
+#endif
+#endif
+
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_OBSERVER_H
@@ -7,6 +7,7 @@
 #define BOOST_THIS_FIBER_OPERATIONS_H
 
 #include <chrono>
+#include <functional>
 
 #include <boost/config.hpp> 
 
@@ -28,6 +29,11 @@ fibers::fiber::id get_id() noexcept {
     return fibers::context::active()->get_id();
 }
 
+inline
+fibers::fiber_stats stats() noexcept {
+    return fibers::context::active()->stats();
+}
+
 inline
 void yield() noexcept {
     fibers::context::active()->yield();
@@ -43,7 +49,7 @@ void sleep_until( std::chrono::time_point< Clock, Duration > const& sleep_time_)
 template< typename Rep, typename Period >
 void sleep_for( std::chrono::duration< Rep, Period > const& timeout_duration) {
     fibers::context::active()->wait_until(
-            std::chrono::steady_clock::now() + timeout_duration);
+            boost::fibers::detail::now() + timeout_duration);
 }
 
 template< typename PROPS >
@@ -75,6 +81,11 @@ bool has_ready_fibers() noexcept {
     return boost::fibers::context::active()->get_scheduler()->has_ready_fibers();
 }
 
+inline
+std::chrono::steady_clock::time_point now() noexcept {
+    return detail::now();
+}
+
 template< typename SchedAlgo, typename ... Args >
 void use_scheduling_algorithm( Args && ... args) noexcept {
     boost::fibers::context::active()->get_scheduler()
@@ -83,6 +94,22 @@ void use_scheduling_algorithm( Args && ... args) noexcept {
                 new SchedAlgo( std::forward< Args >( args) ... ) ) );
 }
 
+inline
+scheduler::poller_id add_poller( std::function< bool() > fn) {
+    return boost::fibers::context::active()->get_scheduler()->add_poller( std::move( fn) );
+}
+
+inline
+void remove_poller( scheduler::poller_id id) noexcept {
+    boost::fibers::context::active()->get_scheduler()->remove_poller( id);
+}
+
+template< typename Rep, typename Period >
+void set_poll_interval( std::chrono::duration< Rep, Period > const& interval) noexcept {
+    boost::fibers::context::active()->get_scheduler()->set_poll_interval(
+            std::chrono::duration_cast< std::chrono::steady_clock::duration >( interval) );
+}
+
 }}
 
 #ifdef BOOST_HAS_ABI_HEADERS
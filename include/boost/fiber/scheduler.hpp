@@ -6,13 +6,21 @@
 #ifndef BOOST_FIBERS_FIBER_MANAGER_H
 #define BOOST_FIBERS_FIBER_MANAGER_H
 
+#include <atomic>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <list>
 #include <memory>
 #include <mutex>
+#include <thread>
 #include <vector>
 
 #include <boost/config.hpp>
+#if defined(BOOST_FIBERS_HAS_PTHREAD_KILL)
+# include <pthread.h>
+#endif
 #if (BOOST_EXECUTION_CONTEXT==1)
 # include <boost/context/execution_context.hpp>
 #else
@@ -27,7 +35,10 @@
 #include <boost/fiber/detail/config.hpp>
 #include <boost/fiber/detail/context_mpsc_queue.hpp>
 #include <boost/fiber/detail/data.hpp>
+#include <boost/fiber/detail/deferred.hpp>
 #include <boost/fiber/detail/spinlock.hpp>
+#include <boost/fiber/detail/tsc.hpp>
+#include <boost/fiber/scheduler_stats.hpp>
 
 #ifdef BOOST_HAS_ABI_HEADERS
 #  include BOOST_ABI_PREFIX
@@ -41,6 +52,10 @@
 namespace boost {
 namespace fibers {
 
+class monitor;
+struct fiber_info;
+struct scheduler_dump;
+
 class BOOST_FIBERS_DECL scheduler {
 public:
     struct timepoint_less {
@@ -54,7 +69,11 @@ public:
                 intrusive::member_hook<
                     context, detail::ready_hook, & context::ready_hook_ >,
                 intrusive::constant_time_size< false > >    ready_queue_t;
+
+    typedef std::size_t                                 poller_id;
 private:
+    friend class monitor;
+
     typedef intrusive::multiset<
                 context,
                 intrusive::member_hook<
@@ -85,11 +104,80 @@ private:
     // remote ready-queue contains context' signaled by schedulers
     // running in other threads
     detail::context_mpsc_queue          remote_ready_queue_{};
+    // remote post-queue contains new context' launched by
+    // other threads via scheduler_handle::post()
+    detail::context_mpsc_queue          remote_post_queue_{};
+    // remote migrate-queue contains ready context' passed by other
+    // threads via remote_migrate()
+    detail::context_mpsc_queue          remote_migrate_queue_{};
     // sleep-queue contains context' which have been called
 #endif
     // scheduler::wait_until()
     sleep_queue_t                       sleep_queue_{};
     bool                                shutdown_{ false };
+    // user-defined event sources polled by the dispatcher-context
+    // removed entries are erased by poll_(), a poller might remove itself
+    struct poller_t {
+        poller_id                   id;
+        std::function< bool() >     fn;
+        bool                        removed;
+    };
+    std::list< poller_t >               pollers_{};
+    poller_id                           next_poller_id_{ 0 };
+    std::chrono::steady_clock::duration poll_interval_{
+        std::chrono::steady_clock::duration::zero() };
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    // registry of the schedulers of all threads, see class monitor
+    intrusive::list_member_hook<
+        intrusive::link_mode<
+            intrusive::safe_link > >        registry_hook_{};
+    std::thread::id                     thread_id_;
+    // read by monitor and dump_fibers(), maintained with or without
+    // BOOST_FIBERS_STATS and written only by the thread of this scheduler
+    struct activity_t {
+        // number of context switches and the context resumed last
+        std::atomic< std::size_t >      switches{ 0 };
+        std::atomic< context * >        running{ nullptr };
+        // where the running context has been launched
+        std::atomic< void const * >     running_site{ nullptr };
+        // number of attached worker context'
+        std::atomic< std::size_t >      workers{ 0 };
+    };
+    activity_t                          activity_{};
+#if defined(BOOST_FIBERS_HAS_PTHREAD_KILL)
+    pthread_t                           native_thread_;
+#endif
+    // functions passed to defer(), run in FIFO order by a fiber of this
+    // scheduler; the fiber is launched on demand and waits (as
+    // deferred_waiting_) while the queue is empty
+    detail::spinlock                    deferred_splk_{};
+    detail::deferred                *   deferred_head_{ nullptr };
+    detail::deferred                **  deferred_tail_{ & deferred_head_ };
+    context                         *   deferred_waiting_{ nullptr };
+    bool                                deferred_running_{ false };
+    // see scheduler_stats, allocated only if the library is built with
+    // BOOST_FIBERS_STATS (the wakeup-latency histograms alone take ~16KB)
+    std::unique_ptr< detail::scheduler_counters >   counters_{};
+
+    typedef intrusive::list<
+                scheduler,
+                intrusive::member_hook<
+                    scheduler,
+                    intrusive::list_member_hook<
+                        intrusive::link_mode<
+                            intrusive::safe_link > >,
+                    & scheduler::registry_hook_ >,
+                intrusive::constant_time_size< false > >   registry_t;
+
+    static std::mutex & registry_mtx_() noexcept;
+
+    static registry_t & registry_() noexcept;
+
+    void add_workers_( std::size_t n) noexcept {
+        activity_.workers.store( activity_.workers.load( std::memory_order_relaxed) + n,
+                                 std::memory_order_relaxed);
+    }
+#endif
 
     context * get_next_() noexcept;
 
@@ -97,10 +185,22 @@ private:
 
 #if ! defined(BOOST_FIBERS_NO_ATOMICS)
     void remote_ready2ready_() noexcept;
+
+    void remote_post2ready_() noexcept;
+
+    void remote_migrate2ready_() noexcept;
+
+    void run_deferred_() noexcept;
+
+    void wake_deferred_() noexcept;
 #endif
 
     void sleep2ready_() noexcept;
 
+    bool poll_() noexcept;
+
+    void idle_() noexcept;
+
 public:
     scheduler() noexcept;
 
@@ -113,6 +213,22 @@ public:
 
 #if ! defined(BOOST_FIBERS_NO_ATOMICS)
     void set_remote_ready( context *) noexcept;
+
+    void remote_post( context *, context *) noexcept;
+
+    // passes a ready context, detached from the scheduler of another
+    // thread, to this scheduler; unlike remote_post() it is neither
+    // reported nor counted as a new fiber
+    void remote_migrate( context *) noexcept;
+
+    // runs d->fn( d) in a fiber of this scheduler, e.g. to resume a
+    // C++20 coroutine; might be called from any thread
+    void defer( detail::deferred *);
+
+    // wakes up the dispatcher if it waits for ready fibers, e.g. after
+    // an event source polled by the dispatcher got data; might be
+    // called from any thread
+    void notify() noexcept;
 #endif
 
 #if (BOOST_EXECUTION_CONTEXT==1)
@@ -138,6 +254,51 @@ public:
 
     bool has_ready_fibers() const noexcept;
 
+    // the clock of the deadlines, virtual if the algorithm simulates time
+    std::chrono::steady_clock::time_point now() const noexcept {
+        return algo_->now();
+    }
+
+    // worker fibers (ready, running, waiting or sleeping) are attached
+    // to this scheduler
+    bool has_worker_fibers() const noexcept {
+        return ! worker_queue_.empty();
+    }
+
+    // worker fibers other than the runner of defer() waiting for
+    // functions are attached to this scheduler; the runner terminates
+    // with the scheduler
+    bool has_user_fibers() noexcept;
+
+    poller_id add_poller( std::function< bool() >);
+
+    void remove_poller( poller_id) noexcept;
+
+    void set_poll_interval( std::chrono::steady_clock::duration const&) noexcept;
+
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    // called on each context switch (from prev to ctx) in the thread of
+    // this scheduler
+    void resumed( context * ctx, context * prev) noexcept;
+
+    // updated by the scheduling algorithms (e.g. steals) and fiber;
+    // nullptr unless the library is built with BOOST_FIBERS_STATS
+    detail::scheduler_counters * counters() noexcept {
+        return counters_.get();
+    }
+
+    // snapshot of the counters; might be called from any thread
+    scheduler_stats stats() const;
+
+    friend BOOST_FIBERS_DECL std::vector< scheduler_stats > all_scheduler_stats();
+
+    friend BOOST_FIBERS_DECL std::vector< scheduler_dump > dump_fibers( std::chrono::milliseconds, bool);
+#endif
+
+    // appends the main fiber and the worker fibers except skip (e.g. the
+    // fiber taking the dump); must be called by the thread of the scheduler
+    void dump( std::vector< fiber_info > &, bool backtraces, context * skip);
+
     void set_algo( std::unique_ptr< algo::algorithm >) noexcept;
 
     void attach_main_context( context *) noexcept;
@@ -149,6 +310,39 @@ public:
     void detach_worker_context( context *) noexcept;
 };
 
+#if defined(BOOST_FIBERS_SOURCE) && ! defined(BOOST_FIBERS_NO_ATOMICS)
+// defined only while building the library, whose translation units are
+// all built either with or without BOOST_FIBERS_STATS
+inline
+void
+scheduler::resumed( context * ctx, context * prev) noexcept {
+    activity_.switches.store( activity_.switches.load( std::memory_order_relaxed) + 1,
+                              std::memory_order_relaxed);
+    activity_.running.store( ctx, std::memory_order_relaxed);
+    activity_.running_site.store( ctx->spawn_site_, std::memory_order_relaxed);
+    ( void)prev;
+#if defined(BOOST_FIBERS_STATS)
+    std::uint64_t ticks = detail::tsc();
+    std::uint64_t since = prev->run_since_.load( std::memory_order_relaxed);
+    if ( 0 != since && since < ticks) {
+        prev->cpu_ticks_.store( prev->cpu_ticks_.load( std::memory_order_relaxed) + ticks - since,
+                                std::memory_order_relaxed);
+    }
+    prev->run_since_.store( 0, std::memory_order_relaxed);
+    ctx->run_since_.store( ticks, std::memory_order_relaxed);
+    detail::stat_inc( ctx->switches_);
+    if ( std::chrono::steady_clock::time_point{} != ctx->ready_since_) {
+        std::chrono::nanoseconds waited = std::chrono::duration_cast< std::chrono::nanoseconds >(
+                std::chrono::steady_clock::now() - ctx->ready_since_);
+        ( ctx->remote_ready_ ? counters_->remote_latency : counters_->local_latency).record( waited);
+        ctx->ready_ns_.store( ctx->ready_ns_.load( std::memory_order_relaxed) + waited.count(),
+                              std::memory_order_relaxed);
+        ctx->ready_since_ = std::chrono::steady_clock::time_point{};
+    }
+#endif
+}
+#endif
+
 }}
 
 #ifdef _MSC_VER
@@ -0,0 +1,145 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_SCHEDULER_HANDLE_H
+#define BOOST_FIBERS_SCHEDULER_HANDLE_H
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/fixedsize_stack.hpp>
+#include <boost/fiber/policy.hpp>
+#include <boost/fiber/scheduler.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+// launches fibers on the scheduler of another thread; post() might be
+// called from any thread, including threads not running fibers
+// the thread of the scheduler must not terminate while fibers are posted
+class scheduler_handle {
+private:
+    scheduler   *   sched_{ nullptr };
+
+    template< typename StackAllocator, typename Fn, typename ... Args >
+    static context * make_context_( StackAllocator salloc, Fn && fn, Args && ... args) {
+        intrusive_ptr< context > ctx{
+            make_worker_context( launch::post, salloc,
+                                 std::forward< Fn >( fn), std::forward< Args >( args) ... ) };
+        // the remaining reference is owned by the scheduler,
+        // as for a detached fiber
+        return ctx.get();
+    }
+
+public:
+    scheduler_handle() noexcept = default;
+
+    explicit scheduler_handle( scheduler * sched) noexcept :
+        sched_{ sched } {
+    }
+
+    // handle of the scheduler of the calling thread
+    static scheduler_handle current() noexcept {
+        return scheduler_handle{ context::active()->get_scheduler() };
+    }
+
+    template< typename Fn, typename ... Args >
+    void post( Fn && fn, Args && ... args) {
+        post( std::allocator_arg, default_stack(),
+              std::forward< Fn >( fn), std::forward< Args >( args) ... );
+    }
+
+    template< typename StackAllocator, typename Fn, typename ... Args >
+    void post( std::allocator_arg_t, StackAllocator salloc, Fn && fn, Args && ... args) {
+        BOOST_ASSERT( nullptr != sched_);
+        // the context is created in the calling thread, the scheduler
+        // only attaches it
+        context * ctx = make_context_( salloc,
+                                       std::forward< Fn >( fn), std::forward< Args >( args) ... );
+        sched_->remote_post( ctx, ctx);
+    }
+
+    // launches a fiber for each function in [first, last), the fibers are
+    // passed to the scheduler with one atomic operation
+    // if creating a fiber throws, the fibers created before are launched
+    template< typename InputIterator >
+    void post_bulk( InputIterator first, InputIterator last) {
+        post_bulk( std::allocator_arg, default_stack(), first, last);
+    }
+
+    template< typename StackAllocator, typename InputIterator >
+    void post_bulk( std::allocator_arg_t, StackAllocator salloc,
+                    InputIterator first, InputIterator last) {
+        BOOST_ASSERT( nullptr != sched_);
+        context * head = nullptr;
+        context * tail = nullptr;
+        try {
+            for (; first != last; ++first) {
+                context * ctx = make_context_( salloc, * first);
+                if ( nullptr == tail) {
+                    head = ctx;
+                } else {
+                    tail->remote_nxt_.store( ctx, std::memory_order_relaxed);
+                }
+                tail = ctx;
+            }
+        } catch (...) {
+            // a context that never ran can not be released: the fibers
+            // created so far are launched
+            if ( nullptr != head) {
+                sched_->remote_post( head, tail);
+            }
+            throw;
+        }
+        if ( nullptr != head) {
+            sched_->remote_post( head, tail);
+        }
+    }
+
+    // snapshot of the counters of the scheduler
+    scheduler_stats stats() const {
+        BOOST_ASSERT( nullptr != sched_);
+        return sched_->stats();
+    }
+
+    scheduler * get_scheduler() const noexcept {
+        return sched_;
+    }
+
+    explicit operator bool() const noexcept {
+        return nullptr != sched_;
+    }
+
+    bool operator!() const noexcept {
+        return nullptr == sched_;
+    }
+
+    bool operator==( scheduler_handle const& other) const noexcept {
+        return sched_ == other.sched_;
+    }
+
+    bool operator!=( scheduler_handle const& other) const noexcept {
+        return sched_ != other.sched_;
+    }
+};
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_SCHEDULER_HANDLE_H
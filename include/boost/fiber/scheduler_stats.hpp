@@ -0,0 +1,169 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_SCHEDULER_STATS_H
+#define BOOST_FIBERS_SCHEDULER_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/cache_aligned.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/latency_histogram.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+// snapshot of the counters of a scheduler; the counters are maintained
+// only if the library is built with BOOST_FIBERS_STATS (enabled == true)
+struct scheduler_stats {
+    bool                        enabled{ false };
+    std::thread::id             thread_id{};
+    // context switches
+    std::uint64_t               switches{ 0 };
+    // iterations of the dispatcher loop
+    std::uint64_t               rounds{ 0 };
+    // fibers signaled by other threads, drained from the remote ready-queue
+    std::uint64_t               remote_wakeups{ 0 };
+    // sleeping fibers made ready because their deadline was reached
+    std::uint64_t               timers_fired{ 0 };
+    // fibers launched in or posted to this scheduler, and terminated
+    std::uint64_t               fibers_created{ 0 };
+    std::uint64_t               fibers_terminated{ 0 };
+    // fibers this scheduler stole from another one, failed attempts, and
+    // fibers other schedulers stole from this one
+    std::uint64_t               steals{ 0 };
+    std::uint64_t               failed_steals{ 0 };
+    std::uint64_t               stolen{ 0 };
+    // calls of algorithm::suspend_until() and of algorithm::notify()
+    std::uint64_t               parks{ 0 };
+    std::uint64_t               unparks{ 0 };
+    // time spent in algorithm::suspend_until() and the remaining time
+    // since the scheduler was created
+    std::chrono::nanoseconds    parked_time{ 0 };
+    std::chrono::nanoseconds    running_time{ 0 };
+    // fibers ready to run (approximate) and fibers attached
+    std::size_t                 ready_fibers{ 0 };
+    std::size_t                 worker_fibers{ 0 };
+    // time from making a fiber ready until it is resumed, if made ready by
+    // a fiber of this thread (or its deadline has been reached) and if made
+    // ready by another thread; the histograms of several schedulers can be
+    // merged
+    latency_histogram           local_wakeup_latency{};
+    latency_histogram           remote_wakeup_latency{};
+
+    // fraction of the time not parked
+    double utilization() const noexcept {
+        std::chrono::nanoseconds total = parked_time + running_time;
+        return 0 == total.count()
+            ? 0.
+            : static_cast< double >( running_time.count() ) / total.count();
+    }
+};
+
+// the accounting of a fiber, maintained only if the library is built with
+// BOOST_FIBERS_STATS (enabled == true)
+struct fiber_stats {
+    bool                        enabled{ false };
+    // time the fiber has been running (measured with the time-stamp
+    // counter), including the current run if it is running
+    std::chrono::nanoseconds    cpu_time{ 0 };
+    // times the fiber has been resumed
+    std::uint64_t               switches{ 0 };
+    // time the fiber has been ready but not running
+    std::chrono::nanoseconds    ready_time{ 0 };
+};
+
+namespace detail {
+
+// the counters of a scheduler, allocated only if the library is built with
+// BOOST_FIBERS_STATS; most of them are written by the thread of the
+// scheduler only (load + store instead of read-modify-write)
+struct scheduler_counters : public cache_aligned {
+    std::atomic< std::uint64_t >                        rounds{ 0 };
+    std::atomic< std::uint64_t >                        remote_wakeups{ 0 };
+    std::atomic< std::uint64_t >                        timers_fired{ 0 };
+    std::atomic< std::uint64_t >                        fibers_created{ 0 };
+    std::atomic< std::uint64_t >                        fibers_terminated{ 0 };
+    std::atomic< std::uint64_t >                        steals{ 0 };
+    std::atomic< std::uint64_t >                        failed_steals{ 0 };
+    std::atomic< std::uint64_t >                        parks{ 0 };
+    std::atomic< std::uint64_t >                        enqueued{ 0 };
+    std::atomic< std::uint64_t >                        dequeued{ 0 };
+    std::atomic< std::int64_t >                         parked_ns{ 0 };
+    // start of the current park, zero if not parked
+    std::atomic< std::chrono::steady_clock::rep >       parked_since{ 0 };
+    // written by any thread
+    alignas(cache_alignment) std::atomic< std::uint64_t >   unparks{ 0 };
+    std::atomic< std::uint64_t >                        stolen{ 0 };
+    std::chrono::steady_clock::time_point               created{ std::chrono::steady_clock::now() };
+    // written by the thread of the scheduler resuming the fiber
+    latency_buckets                                     local_latency{};
+    latency_buckets                                     remote_latency{};
+};
+
+// used by the library only, whose translation units are all built either
+// with or without BOOST_FIBERS_STATS
+#if defined(BOOST_FIBERS_SOURCE)
+// the counters of a scheduler are passed as pointer and member, the
+// pointer is not dereferenced without BOOST_FIBERS_STATS (it is nullptr)
+typedef std::atomic< std::uint64_t > scheduler_counters::*  scheduler_counter;
+
+#if defined(BOOST_FIBERS_STATS)
+inline
+void stat_inc( std::atomic< std::uint64_t > & c) noexcept {
+    c.store( c.load( std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+inline
+void stat_inc( scheduler_counters * c, scheduler_counter m) noexcept {
+    stat_inc( c->*m);
+}
+
+inline
+void stat_inc_shared( scheduler_counters * c, scheduler_counter m) noexcept {
+    ( c->*m).fetch_add( 1, std::memory_order_relaxed);
+}
+#else
+inline
+void stat_inc( std::atomic< std::uint64_t > &) noexcept {
+}
+
+inline
+void stat_inc( scheduler_counters *, scheduler_counter) noexcept {
+}
+
+inline
+void stat_inc_shared( scheduler_counters *, scheduler_counter) noexcept {
+}
+#endif
+#endif
+
+}
+
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+// snapshots of the schedulers of all threads
+BOOST_FIBERS_DECL
+std::vector< scheduler_stats > all_scheduler_stats();
+#endif
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_SCHEDULER_STATS_H
@@ -0,0 +1,150 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_SHARDED_H
+#define BOOST_FIBERS_SHARDED_H
+
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/spsc_ring.hpp>
+#include <boost/fiber/future/future.hpp>
+#include <boost/fiber/future/packaged_task.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// a function submitted to a shard, executed by a new fiber
+struct shard_task {
+    virtual ~shard_task() {}
+
+    virtual void run() = 0;
+};
+
+template< typename R >
+class shard_task_impl : public shard_task {
+private:
+    packaged_task< R() >    pt_;
+
+public:
+    template< typename Fn >
+    explicit shard_task_impl( Fn && fn) :
+        pt_{ std::forward< Fn >( fn) } {
+    }
+
+    future< R > get_future() {
+        return pt_.get_future();
+    }
+
+    void run() override {
+        pt_();
+    }
+};
+
+}
+
+// thread-per-core runtime: each shard is a thread with its own scheduler
+// (algo::round_robin), optionally pinned to a CPU; fibers never migrate
+// between shards
+// shards exchange work by message passing: each pair of shards is connected
+// by a single-producer/single-consumer ring, polled by the dispatcher of
+// the receiving shard, no lock is shared between shards
+class BOOST_FIBERS_DECL sharded {
+public:
+    // returned by this_shard() if the calling thread is not a shard
+    static constexpr std::size_t    npos = static_cast< std::size_t >( -1);
+
+private:
+    struct shard;
+
+    typedef detail::spsc_ring< detail::shard_task * >   ring_type;
+
+    std::size_t                                 size_;
+    bool                                        pin_;
+    bool                                        busy_poll_;
+    // ring from shard i to shard j at rings_[i * size_ + j]
+    std::vector< std::unique_ptr< ring_type > > rings_;
+    std::vector< std::unique_ptr< shard > >     shards_;
+
+    void run_( std::size_t) noexcept;
+
+    bool poll_( std::size_t) noexcept;
+
+    void stop_() noexcept;
+
+    // takes ownership of the task
+    void submit_( std::size_t, detail::shard_task *);
+
+public:
+    // starts size shards; shard i is pinned to the i-th CPU the process
+    // is allowed to run on (modulo the number of CPUs)
+    // busy_poll: idle shards spin on their rings instead of waiting to be
+    // notified
+    explicit sharded( std::size_t size = std::thread::hardware_concurrency(),
+                      bool pin = true,
+                      bool busy_poll = false,
+                      std::size_t capacity = 1024);
+
+    sharded( sharded const&) = delete;
+    sharded & operator=( sharded const&) = delete;
+
+    // stops the shards and joins their threads, the fibers running on the
+    // shards are completed before; must not be called by a shard
+    ~sharded();
+
+    std::size_t size() const noexcept {
+        return size_;
+    }
+
+    // index of the shard of the calling thread or npos
+    static std::size_t this_shard() noexcept;
+
+    // executes fn in a new fiber on the given shard
+    // might be called from any thread; if the ring to the shard is full,
+    // the calling fiber yields until the shard consumed a task
+    template< typename Fn >
+    future< typename std::result_of< typename std::decay< Fn >::type() >::type >
+    submit_to( std::size_t shard, Fn && fn) {
+        typedef typename std::result_of<
+            typename std::decay< Fn >::type()
+        >::type     result_t;
+
+        std::unique_ptr< detail::shard_task_impl< result_t > > t{
+            new detail::shard_task_impl< result_t >{ std::forward< Fn >( fn) } };
+        future< result_t > f{ t->get_future() };
+        submit_( shard, t.release() );
+        return f;
+    }
+};
+
+}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_SHARDED_H
@@ -0,0 +1,105 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_TRACER_H
+#define BOOST_FIBERS_TRACER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/tsc.hpp>
+#include <boost/fiber/observer.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+
+// records scheduling events into a ring buffer per thread and writes
+// them in the Chrome trace event format (chrome://tracing, Perfetto)
+class BOOST_FIBERS_DECL tracer : public observer {
+private:
+    struct slot {
+        std::uint64_t       ticks;
+        context::id         id;
+        context::id         from;
+        void const      *   object;
+        event_type          type;
+        block_reason        reason;
+    };
+
+    struct buffer;
+
+    std::size_t                                 capacity_;
+    std::uint64_t                               serial_;
+    observer                                *   previous_{ nullptr };
+    bool                                        running_{ false };
+    detail::tsc_sample                          started_{};
+    detail::tsc_sample                          stopped_{};
+    mutable std::mutex                          mtx_{};
+    std::vector< std::unique_ptr< buffer > >    buffers_{};
+
+    buffer * register_() noexcept;
+
+    void record_( event_type, context::id, context::id, block_reason, void const *) noexcept;
+
+public:
+    // capacity: events kept per thread, rounded up to a power of two;
+    // older events are overwritten
+    explicit tracer( std::size_t capacity = 64 * 1024);
+
+    ~tracer();
+
+    tracer( tracer const&) = delete;
+    tracer & operator=( tracer const&) = delete;
+
+    // installs the tracer as observer
+    void start() noexcept;
+
+    // restores the previous observer
+    void stop() noexcept;
+
+    // writes the parts of the event into the ring buffer, no event is built
+    void record( event_type, context *, context *, block_reason,
+                 void const *, void const *) noexcept;
+
+    void on_event( event const&) noexcept;
+
+    // events recorded, and overwritten because a ring buffer was full
+    std::size_t size() const noexcept;
+
+    std::size_t overwritten() const noexcept;
+
+    // writes the recorded events as JSON; must not be called while events
+    // are recorded
+    void write( std::ostream &) const;
+};
+
+}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_TRACER_H
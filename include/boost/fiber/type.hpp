@@ -47,7 +47,9 @@ enum class type {
     main_context       = 1 << 1,
     dispatcher_context = 1 << 2,
     worker_context     = 1 << 3,
-    pinned_context     = main_context | dispatcher_context
+    // worker context that must not migrate to another thread
+    bound_context      = 1 << 4,
+    pinned_context     = main_context | dispatcher_context | bound_context
 };
 
 inline
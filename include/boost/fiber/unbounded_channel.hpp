@@ -8,7 +8,11 @@
 #ifndef BOOST_FIBERS_UNBOUNDED_CHANNEL_H
 #define BOOST_FIBERS_UNBOUNDED_CHANNEL_H
 
-#warn "template unbounded_channel is deprecated"
+#if defined(_MSC_VER)
+# pragma message("template unbounded_channel is deprecated")
+#else
+# warning "template unbounded_channel is deprecated"
+#endif
 
 #include <atomic>
 #include <algorithm>
@@ -242,7 +246,7 @@ public:
     template< typename Rep, typename Period >
     channel_op_status pop_wait_for( value_type & va,
                                     std::chrono::duration< Rep, Period > const& timeout_duration) {
-        return pop_wait_until( va, std::chrono::steady_clock::now() + timeout_duration);
+        return pop_wait_until( va, detail::now() + timeout_duration);
     }
 
     template< typename Clock, typename Duration >
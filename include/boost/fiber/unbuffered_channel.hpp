@@ -22,6 +22,7 @@
 #include <boost/fiber/detail/convert.hpp>
 #include <boost/fiber/detail/spinlock.hpp>
 #include <boost/fiber/exceptions.hpp>
+#include <boost/fiber/observer.hpp>
 
 #ifdef BOOST_HAS_ABI_HEADERS
 #  include BOOST_ABI_PREFIX
@@ -146,6 +147,7 @@ public:
                     waiting_consumers_.pop_front();
                     ctx->set_ready( consumer_ctx);
                 }
+                detail::observe_block( ctx, block_reason::channel_push, this, BOOST_FIBERS_CALLER);
                 // suspend till value has been consumed
                 ctx->suspend( lk);
                 // resumed, value has been consumed
@@ -160,6 +162,7 @@ public:
                     continue;
                 }
                 ctx->wait_link( waiting_producers_);
+                detail::observe_block( ctx, block_reason::channel_push, this, BOOST_FIBERS_CALLER);
                 // suspend this producer
                 ctx->suspend( lk);
                 // resumed, slot mabye free
@@ -182,6 +185,7 @@ public:
                     waiting_consumers_.pop_front();
                     ctx->set_ready( consumer_ctx);
                 }
+                detail::observe_block( ctx, block_reason::channel_push, this, BOOST_FIBERS_CALLER);
                 // suspend till value has been consumed
                 ctx->suspend( lk);
                 // resumed, value has been consumed
@@ -196,6 +200,7 @@ public:
                     continue;
                 }
                 ctx->wait_link( waiting_producers_);
+                detail::observe_block( ctx, block_reason::channel_push, this, BOOST_FIBERS_CALLER);
                 // suspend this producer
                 ctx->suspend( lk);
                 // resumed, slot mabye free
@@ -207,14 +212,14 @@ public:
     channel_op_status push_wait_for( value_type const& value,
                                      std::chrono::duration< Rep, Period > const& timeout_duration) {
         return push_wait_until( value,
-                                std::chrono::steady_clock::now() + timeout_duration);
+                                detail::now() + timeout_duration);
     }
 
     template< typename Rep, typename Period >
     channel_op_status push_wait_for( value_type && value,
                                      std::chrono::duration< Rep, Period > const& timeout_duration) {
         return push_wait_until( std::forward< value_type >( value),
-                                std::chrono::steady_clock::now() + timeout_duration);
+                                detail::now() + timeout_duration);
     }
 
     template< typename Clock, typename Duration >
@@ -235,6 +240,7 @@ public:
                     waiting_consumers_.pop_front();
                     ctx->set_ready( consumer_ctx);
                 }
+                detail::observe_block( ctx, block_reason::channel_push, this, BOOST_FIBERS_CALLER);
                 // suspend this producer
                 if ( ! ctx->wait_until( timeout_time, lk) ) {
                     // clear slot
@@ -259,6 +265,7 @@ public:
                     continue;
                 }
                 ctx->wait_link( waiting_producers_);
+                detail::observe_block( ctx, block_reason::channel_push, this, BOOST_FIBERS_CALLER);
                 // suspend this producer
                 if ( ! ctx->wait_until( timeout_time, lk) ) {
                     // relock local lk
@@ -290,6 +297,7 @@ public:
                     waiting_consumers_.pop_front();
                     ctx->set_ready( consumer_ctx);
                 }
+                detail::observe_block( ctx, block_reason::channel_push, this, BOOST_FIBERS_CALLER);
                 // suspend this producer
                 if ( ! ctx->wait_until( timeout_time, lk) ) {
                     // clear slot
@@ -314,6 +322,7 @@ public:
                     continue;
                 }
                 ctx->wait_link( waiting_producers_);
+                detail::observe_block( ctx, block_reason::channel_push, this, BOOST_FIBERS_CALLER);
                 // suspend this producer
                 if ( ! ctx->wait_until( timeout_time, lk) ) {
                     // relock local lk
@@ -357,6 +366,7 @@ public:
                     continue;
                 }
                 ctx->wait_link( waiting_consumers_);
+                detail::observe_block( ctx, block_reason::channel_pop, this, BOOST_FIBERS_CALLER);
                 // suspend this consumer
                 ctx->suspend( lk);
                 // resumed, slot mabye set
@@ -396,6 +406,7 @@ public:
                     continue;
                 }
                 ctx->wait_link( waiting_consumers_);
+                detail::observe_block( ctx, block_reason::channel_pop, this, BOOST_FIBERS_CALLER);
                 // suspend this consumer
                 ctx->suspend( lk);
                 // resumed, slot mabye set
@@ -407,7 +418,7 @@ public:
     channel_op_status pop_wait_for( value_type & value,
                                     std::chrono::duration< Rep, Period > const& timeout_duration) {
         return pop_wait_until( value,
-                               std::chrono::steady_clock::now() + timeout_duration);
+                               detail::now() + timeout_duration);
     }
 
     template< typename Clock, typename Duration >
@@ -443,6 +454,7 @@ public:
                     continue;
                 }
                 ctx->wait_link( waiting_consumers_);
+                detail::observe_block( ctx, block_reason::channel_pop, this, BOOST_FIBERS_CALLER);
                 // suspend this consumer
                 if ( ! ctx->wait_until( timeout_time, lk) ) {
                     // relock local lk
@@ -0,0 +1,155 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// actor vs. channel based message passing
+//   ping-pong: two actors (fibers) of one thread pass a counter back and forth
+//   fan-in:    producer threads send to one actor (fiber) of the main thread
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/fiber/all.hpp>
+
+using channel_type = boost::fibers::buffered_channel< std::uint64_t >;
+using actor_type = boost::fibers::actor< std::uint64_t >;
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+
+duration_type ping_pong_channel( std::uint64_t round_trips) {
+    channel_type ping{ 2 }, pong{ 2 };
+    time_point_type start{ clock_type::now() };
+    boost::fibers::fiber f{ [&ping,&pong](){
+        std::uint64_t i;
+        while ( boost::fibers::channel_op_status::success == ping.pop( i) ) {
+            pong.push( i);
+        }
+    }};
+    for ( std::uint64_t i = 0; i < round_trips; ++i) {
+        ping.push( i);
+        pong.value_pop();
+    }
+    ping.close();
+    f.join();
+    return clock_type::now() - start;
+}
+
+duration_type ping_pong_actor( std::uint64_t round_trips) {
+    boost::fibers::mutex mtx;
+    boost::fibers::condition_variable cnd;
+    bool done = false;
+    time_point_type start{ clock_type::now() };
+    {
+        actor_type * pong_ptr = nullptr;
+        actor_type ping{ [&pong_ptr,&mtx,&cnd,&done,round_trips]( std::uint64_t && i){
+            if ( round_trips == i) {
+                std::unique_lock< boost::fibers::mutex > lk( mtx);
+                done = true;
+                cnd.notify_one();
+            } else {
+                pong_ptr->send( i + 1);
+            }
+        }};
+        actor_type pong{ [&ping]( std::uint64_t && i){
+            ping.send( i);
+        }};
+        pong_ptr = & pong;
+        pong.send( 0);
+        std::unique_lock< boost::fibers::mutex > lk( mtx);
+        cnd.wait( lk, [&done](){ return done; });
+    }
+    return clock_type::now() - start;
+}
+
+duration_type fan_in_channel( std::size_t producers, std::uint64_t messages) {
+    channel_type c{ 1024 };
+    std::uint64_t sum{ 0 };
+    time_point_type start{ clock_type::now() };
+    std::vector< std::thread > threads;
+    for ( std::size_t i = 0; i < producers; ++i) {
+        threads.emplace_back([&c,messages](){
+            for ( std::uint64_t j = 0; j < messages; ++j) {
+                c.push( j);
+            }
+        });
+    }
+    for ( std::uint64_t i = 0; i < producers * messages; ++i) {
+        sum += c.value_pop();
+    }
+    duration_type duration = clock_type::now() - start;
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    if ( producers * messages * ( messages - 1) / 2 != sum) {
+        throw std::runtime_error( "fan-in: invalid result");
+    }
+    return duration;
+}
+
+duration_type fan_in_actor( std::size_t producers, std::uint64_t messages) {
+    std::uint64_t sum{ 0 };
+    time_point_type start{ clock_type::now() };
+    {
+        actor_type a{ [&sum]( std::uint64_t && i){
+            sum += i;
+        }};
+        std::vector< std::thread > threads;
+        for ( std::size_t i = 0; i < producers; ++i) {
+            threads.emplace_back([&a,messages](){
+                for ( std::uint64_t j = 0; j < messages; ++j) {
+                    a.send( j);
+                }
+            });
+        }
+        for ( std::thread & t : threads) {
+            t.join();
+        }
+        // ~actor() waits till all messages are processed
+    }
+    duration_type duration = clock_type::now() - start;
+    if ( producers * messages * ( messages - 1) / 2 != sum) {
+        throw std::runtime_error( "fan-in: invalid result");
+    }
+    return duration;
+}
+
+void print( std::string const& name, duration_type duration, std::uint64_t count) {
+    std::cout << name << count << " messages in "
+              << std::chrono::duration_cast< std::chrono::milliseconds >( duration).count() << " ms, "
+              << std::chrono::duration_cast< std::chrono::nanoseconds >( duration).count() / count
+              << " ns/message" << std::endl;
+}
+
+int main( int argc, char * argv[]) {
+    try {
+        std::uint64_t messages{ 1000000 };
+        std::size_t producers{ 4 };
+        if ( 1 < argc) {
+            messages = std::strtoull( argv[1], nullptr, 10);
+        }
+        if ( 2 < argc) {
+            producers = std::strtoul( argv[2], nullptr, 10);
+        }
+        print( "ping-pong channel: ", ping_pong_channel( messages), 2 * messages);
+        print( "ping-pong actor:   ", ping_pong_actor( messages), 2 * messages);
+        print( "fan-in channel:    ", fan_in_channel( producers, messages), producers * messages);
+        print( "fan-in actor:      ", fan_in_actor( producers, messages), producers * messages);
+        std::cout << "done." << std::endl;
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+    return EXIT_FAILURE;
+}
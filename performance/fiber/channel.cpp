@@ -0,0 +1,198 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// throughput of the channels with 1..N producers and as many consumers,
+// see ../thread/channel_std.cpp for the baseline
+//   <channel>_<n>x<n>:          producer and consumer fibers of one thread
+//   <channel>_<n>x<n>_threads:  each producer and consumer fiber runs in
+//                               a thread of its own
+// an op is a value passed from a producer to a consumer
+//   fan_in_16_<variant>:        a short-lived channel of capacity 16 is
+//                               created, 10 values are pushed and popped
+//                               (as a skynet node does); an op is a channel,
+//                               with the capacity given at runtime (heap),
+//                               embedded and embedded with dense slots
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/fiber/all.hpp>
+#include <boost/fiber/bounded_channel.hpp>
+#include <boost/fiber/unbounded_channel.hpp>
+
+#include "../report.hpp"
+
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+
+constexpr std::size_t capacity = 1024;
+
+template< typename Channel >
+struct factory;
+
+template<>
+struct factory< boost::fibers::buffered_channel< std::uint64_t > > {
+    static char const* name() {
+        return "buffered_channel";
+    }
+
+    static boost::fibers::buffered_channel< std::uint64_t > * create() {
+        return new boost::fibers::buffered_channel< std::uint64_t >{ capacity };
+    }
+};
+
+template<>
+struct factory< boost::fibers::unbuffered_channel< std::uint64_t > > {
+    static char const* name() {
+        return "unbuffered_channel";
+    }
+
+    static boost::fibers::unbuffered_channel< std::uint64_t > * create() {
+        return new boost::fibers::unbuffered_channel< std::uint64_t >{};
+    }
+};
+
+template<>
+struct factory< boost::fibers::unbounded_channel< std::uint64_t > > {
+    static char const* name() {
+        return "unbounded_channel";
+    }
+
+    static boost::fibers::unbounded_channel< std::uint64_t > * create() {
+        return new boost::fibers::unbounded_channel< std::uint64_t >{};
+    }
+};
+
+template<>
+struct factory< boost::fibers::bounded_channel< std::uint64_t > > {
+    static char const* name() {
+        return "bounded_channel";
+    }
+
+    static boost::fibers::bounded_channel< std::uint64_t > * create() {
+        return new boost::fibers::bounded_channel< std::uint64_t >{ capacity };
+    }
+};
+
+template< typename Channel >
+duration_type transfer( std::uint64_t ops, std::size_t n, bool threads) {
+    std::unique_ptr< Channel > chan{ factory< Channel >::create() };
+    std::uint64_t per_producer = ops / n;
+    std::vector< std::uint64_t > sums( n, 0);
+    auto produce = [&chan,per_producer](){
+        for ( std::uint64_t i = 0; i < per_producer; ++i) {
+            chan->push( i);
+        }
+    };
+    auto consume = [&chan,&sums]( std::size_t idx){
+        std::uint64_t value = 0, sum = 0;
+        while ( boost::fibers::channel_op_status::success == chan->pop( value) ) {
+            sum += value;
+        }
+        sums[idx] = sum;
+    };
+    time_point_type start{ clock_type::now() };
+    if ( threads) {
+        std::vector< std::thread > producers, consumers;
+        for ( std::size_t i = 0; i < n; ++i) {
+            consumers.emplace_back( consume, i);
+            producers.emplace_back( produce);
+        }
+        for ( std::thread & t : producers) {
+            t.join();
+        }
+        chan->close();
+        for ( std::thread & t : consumers) {
+            t.join();
+        }
+    } else {
+        std::vector< boost::fibers::fiber > producers, consumers;
+        for ( std::size_t i = 0; i < n; ++i) {
+            consumers.emplace_back( consume, i);
+            producers.emplace_back( produce);
+        }
+        for ( boost::fibers::fiber & f : producers) {
+            f.join();
+        }
+        chan->close();
+        for ( boost::fibers::fiber & f : consumers) {
+            f.join();
+        }
+    }
+    duration_type duration = clock_type::now() - start;
+    std::uint64_t sum = 0;
+    for ( std::uint64_t s : sums) {
+        sum += s;
+    }
+    if ( n * ( per_producer * ( per_producer - 1) / 2) != sum) {
+        throw std::runtime_error( std::string{ factory< Channel >::name() } + ": invalid result");
+    }
+    return duration;
+}
+
+template< typename Channel, typename ... Args >
+duration_type fan_in( std::uint64_t ops, Args ... args) {
+    std::uint64_t sum = 0;
+    time_point_type start{ clock_type::now() };
+    for ( std::uint64_t i = 0; i < ops; ++i) {
+        Channel chan{ args ... };
+        for ( std::uint64_t j = 0; j < 10; ++j) {
+            chan.push( j);
+        }
+        for ( std::uint64_t j = 0; j < 10; ++j) {
+            sum += chan.value_pop();
+        }
+    }
+    duration_type duration = clock_type::now() - start;
+    if ( 45 * ops != sum) {
+        throw std::runtime_error( "fan_in: invalid result");
+    }
+    return duration;
+}
+
+template< typename Channel >
+void run( bench_report & r) {
+    std::string name = factory< Channel >::name();
+    for ( std::size_t n : r.thread_counts() ) {
+        std::uint64_t ops = r.ops() / n * n;
+        std::uint64_t ops_threads = r.ops() / 10 / n * n;
+        std::string suffix = "_" + std::to_string( n) + "x" + std::to_string( n);
+        r.add( name + suffix, 1, ops, transfer< Channel >( ops, n, false) );
+        r.add( name + suffix + "_threads", 2 * n, ops_threads, transfer< Channel >( ops_threads, n, true) );
+    }
+}
+
+int main( int argc, char * argv[]) {
+    try {
+        bench_report r{ "channel", "fiber", argc, argv, 1000000 };
+        run< boost::fibers::buffered_channel< std::uint64_t > >( r);
+        run< boost::fibers::unbuffered_channel< std::uint64_t > >( r);
+        run< boost::fibers::unbounded_channel< std::uint64_t > >( r);
+        run< boost::fibers::bounded_channel< std::uint64_t > >( r);
+        r.add( "fan_in_16_heap", 1, r.ops(),
+               fan_in< boost::fibers::buffered_channel< std::uint64_t > >( r.ops(), 16) );
+        r.add( "fan_in_16_inline", 1, r.ops(),
+               fan_in< boost::fibers::buffered_channel< std::uint64_t, 16 > >( r.ops() ) );
+        r.add( "fan_in_16_inline_dense", 1, r.ops(),
+               fan_in< boost::fibers::buffered_channel<
+                    std::uint64_t, 16, boost::fibers::slot_layout::dense > >( r.ops() ) );
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+    return EXIT_FAILURE;
+}
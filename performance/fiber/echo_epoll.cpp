@@ -0,0 +1,149 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// echo over socketpairs and pipes: each client fiber sends a message and
+// waits for the echo; the server fibers block on boost::fibers::read()
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <boost/fiber/all.hpp>
+
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+
+constexpr std::size_t msg_size = 64;
+
+bool read_all( int fd, char * buf, std::size_t size) {
+    std::size_t got{ 0 };
+    while ( got < size) {
+        ::ssize_t n = boost::fibers::read( fd, buf + got, size - got);
+        if ( 0 >= n) {
+            return false;
+        }
+        got += n;
+    }
+    return true;
+}
+
+bool write_all( int fd, char const* buf, std::size_t size) {
+    std::size_t sent{ 0 };
+    while ( sent < size) {
+        ::ssize_t n = boost::fibers::write( fd, buf + sent, size - sent);
+        if ( 0 >= n) {
+            return false;
+        }
+        sent += n;
+    }
+    return true;
+}
+
+// in: fd the server reads from, out: fd the server writes to
+void server( int in, int out) {
+    char buf[msg_size];
+    while ( read_all( in, buf, msg_size) ) {
+        if ( ! write_all( out, buf, msg_size) ) {
+            break;
+        }
+    }
+}
+
+void client( int in, int out, std::size_t messages) {
+    char buf[msg_size];
+    std::memset( buf, 'x', msg_size);
+    for ( std::size_t i = 0; i < messages; ++i) {
+        if ( ! write_all( out, buf, msg_size) || ! read_all( in, buf, msg_size) ) {
+            break;
+        }
+    }
+}
+
+void set_nonblocking( int fd) {
+    ::fcntl( fd, F_SETFL, ::fcntl( fd, F_GETFL) | O_NONBLOCK);
+}
+
+duration_type run( bool use_pipes, std::size_t connections, std::size_t messages) {
+    std::vector< int > fds;
+    std::vector< boost::fibers::fiber > fibers;
+    time_point_type start{ clock_type::now() };
+    for ( std::size_t i = 0; i < connections; ++i) {
+        if ( use_pipes) {
+            int c2s[2], s2c[2];
+            if ( 0 != ::pipe2( c2s, O_NONBLOCK) || 0 != ::pipe2( s2c, O_NONBLOCK) ) {
+                throw std::runtime_error("pipe2() failed");
+            }
+            fds.insert( fds.end(), { c2s[0], c2s[1], s2c[0], s2c[1] });
+            fibers.emplace_back( server, c2s[0], s2c[1]);
+            fibers.emplace_back( [=](){
+                client( s2c[0], c2s[1], messages);
+                // EOF terminates the server
+                boost::fibers::close( c2s[1]);
+            });
+        } else {
+            int sv[2];
+            if ( 0 != ::socketpair( AF_UNIX, SOCK_STREAM, 0, sv) ) {
+                throw std::runtime_error("socketpair() failed");
+            }
+            set_nonblocking( sv[0]);
+            set_nonblocking( sv[1]);
+            fds.insert( fds.end(), { sv[0], sv[1] });
+            fibers.emplace_back( server, sv[1], sv[1]);
+            fibers.emplace_back( [=](){
+                client( sv[0], sv[0], messages);
+                ::shutdown( sv[0], SHUT_WR);
+            });
+        }
+    }
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    duration_type duration = clock_type::now() - start;
+    for ( int fd : fds) {
+        boost::fibers::close( fd);
+    }
+    return duration;
+}
+
+int main( int argc, char * argv[]) {
+    try {
+        std::size_t connections{ 100 };
+        std::size_t messages{ 10000 };
+        if ( 1 < argc) {
+            connections = std::strtoul( argv[1], nullptr, 10);
+        }
+        if ( 2 < argc) {
+            messages = std::strtoul( argv[2], nullptr, 10);
+        }
+        boost::fibers::use_scheduling_algorithm< boost::fibers::algo::epoll >();
+        for ( bool use_pipes : { false, true }) {
+            duration_type duration = run( use_pipes, connections, messages);
+            std::uint64_t total = connections * messages;
+            std::cout << ( use_pipes ? "pipe:       " : "socketpair: ")
+                      << connections << " connections, " << total << " round trips in "
+                      << std::chrono::duration_cast< std::chrono::milliseconds >( duration).count() << " ms, "
+                      << std::chrono::duration_cast< std::chrono::nanoseconds >( duration).count() / total
+                      << " ns/round trip" << std::endl;
+        }
+        std::cout << "done." << std::endl;
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,444 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// scalability of work_stealing and shared_work with irregular parallelism
+// (skynet is a perfectly balanced tree)
+//   uts:   unbalanced tree search, binomial tree: the root has 2000
+//          children, every other node has 8 children with probability
+//          0.124 and none otherwise (about 250000 nodes, subtrees of very
+//          different size); a fiber per node
+//   fib:   recursive fibonacci, a fiber per call down to n == 2
+//   dag:   random task DAG of 100 layers of 1..200 tasks, each depends on
+//          1..4 tasks of the previous layer and costs a Pareto-distributed
+//          amount of work; a task is launched when its last predecessor
+//          finishes
+// each benchmark runs for 1, 2, 4, ... threads; reported are the time, the
+// speed-up relative to one thread, and - if the library has been built with
+// BOOST_FIBERS_STATS (b2 define=BOOST_FIBERS_STATS) - the steals, failed
+// steal attempts and the fraction of time the threads did not run a fiber
+// of the benchmark (threads * time - sum of the fibers' CPU time, i.e.
+// waiting for work and the overhead of scheduling).
+// idle threads spin looking for work unless --suspend is given.
+//
+// usage: irregular [--bench=uts|fib|dag|all] [--algo=work_stealing|shared_work|all]
+//                  [--threads=N] [--suspend] [--json]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/fiber/all.hpp>
+
+#include "barrier.hpp"
+#include "bind/bind_processor.hpp"
+
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+using allocator_type = boost::fibers::fixedsize_stack;
+
+constexpr std::size_t stack_size = 16 * 1024;
+
+// CPU time of the terminated fibers of the benchmark
+std::atomic< std::int64_t > busy_ns{ 0 };
+
+// called at the end of each fiber
+void account() noexcept {
+    busy_ns.fetch_add( boost::this_fiber::stats().cpu_time.count(), std::memory_order_relaxed);
+}
+
+std::uint64_t mix( std::uint64_t x) {
+    // splitmix64
+    x += 0x9e3779b97f4a7c15;
+    x = ( x ^ ( x >> 30) ) * 0xbf58476d1ce4e5b9;
+    x = ( x ^ ( x >> 27) ) * 0x94d049bb133111eb;
+    return x ^ ( x >> 31);
+}
+
+std::uint64_t spin( std::uint64_t x, std::uint32_t n) {
+    for ( std::uint32_t i = 0; i < n; ++i) {
+        x = mix( x);
+    }
+    return x;
+}
+
+// unbalanced tree search
+constexpr std::uint32_t uts_root_children = 2000;
+constexpr std::uint32_t uts_children = 8;
+constexpr double uts_q = 0.124;
+constexpr std::uint32_t uts_work = 100;
+
+std::uint64_t uts( allocator_type salloc, std::uint64_t state, bool root) {
+    state = spin( state, uts_work);
+    std::uint32_t n = root
+        ? uts_root_children
+        : ( ( state >> 11) / 9007199254740992. < uts_q ? uts_children : 0);
+    if ( 0 == n) {
+        return 1;
+    }
+    std::vector< std::uint64_t > counts( n, 0);
+    std::vector< boost::fibers::fiber > children;
+    children.reserve( n);
+    for ( std::uint32_t i = 0; i < n; ++i) {
+        children.emplace_back( boost::fibers::launch::dispatch,
+                               std::allocator_arg, salloc,
+                               [salloc,&counts,state,i](){
+                                   counts[i] = uts( salloc, state + i + 1, false);
+                                   account();
+                               });
+    }
+    for ( boost::fibers::fiber & f : children) {
+        f.join();
+    }
+    std::uint64_t count = 1;
+    for ( std::uint64_t c : counts) {
+        count += c;
+    }
+    return count;
+}
+
+// fibonacci
+constexpr unsigned int fib_n = 27;
+
+std::uint64_t fib( allocator_type salloc, unsigned int n) {
+    if ( 2 > n) {
+        return n;
+    }
+    std::uint64_t a = 0;
+    boost::fibers::fiber f{ boost::fibers::launch::dispatch,
+                            std::allocator_arg, salloc,
+                            [salloc,&a,n](){
+                                a = fib( salloc, n - 1);
+                                account();
+                            }};
+    std::uint64_t b = fib( salloc, n - 2);
+    f.join();
+    return a + b;
+}
+
+// random task DAG
+constexpr std::uint32_t dag_layers = 100;
+constexpr std::uint32_t dag_max_width = 200;
+constexpr std::uint32_t dag_max_preds = 4;
+
+struct dag_task {
+    std::vector< std::uint32_t >    preds{};
+    std::vector< std::uint32_t >    succs{};
+    std::uint32_t                   cost{ 0 };
+    std::atomic< std::uint32_t >    pending{ 0 };
+    std::uint64_t                   value{ 0 };
+};
+
+struct dag {
+    std::size_t                             size{ 0 };
+    std::unique_ptr< dag_task[] >           tasks{};
+    std::vector< std::uint32_t >            sources{};
+    std::atomic< std::size_t >              remaining{ 0 };
+    boost::fibers::promise< void >          done{};
+};
+
+std::unique_ptr< dag > make_dag() {
+    std::minstd_rand rnd{ 4711 };
+    std::uniform_int_distribution< std::uint32_t > widths{ 1, dag_max_width };
+    std::uniform_int_distribution< std::uint32_t > preds{ 1, dag_max_preds };
+    std::uniform_real_distribution< double > u{ 0., 1. };
+    std::vector< std::uint32_t > layers;
+    std::size_t size = 0;
+    for ( std::uint32_t l = 0; l < dag_layers; ++l) {
+        layers.push_back( widths( rnd) );
+        size += layers.back();
+    }
+    std::unique_ptr< dag > g{ new dag{} };
+    g->size = size;
+    g->tasks.reset( new dag_task[size]);
+    g->remaining = size;
+    std::size_t prev = 0, first = 0;
+    for ( std::uint32_t l = 0; l < dag_layers; ++l) {
+        for ( std::uint32_t i = 0; i < layers[l]; ++i) {
+            dag_task & t = g->tasks[first + i];
+            // Pareto, alpha 1.5: most tasks are cheap, a few are very expensive
+            t.cost = static_cast< std::uint32_t >(
+                    ( std::min)( 100. / std::pow( 1. - u( rnd), 1. / 1.5), 200000.) );
+            if ( 0 == l) {
+                g->sources.push_back( static_cast< std::uint32_t >( i) );
+                continue;
+            }
+            std::uniform_int_distribution< std::uint32_t > pick{ 0, layers[l - 1] - 1 };
+            for ( std::uint32_t j = preds( rnd); 0 < j; --j) {
+                std::uint32_t p = static_cast< std::uint32_t >( prev) + pick( rnd);
+                if ( t.preds.end() == std::find( t.preds.begin(), t.preds.end(), p) ) {
+                    t.preds.push_back( p);
+                    g->tasks[p].succs.push_back( static_cast< std::uint32_t >( first + i) );
+                }
+            }
+            t.pending = static_cast< std::uint32_t >( t.preds.size() );
+        }
+        prev = first;
+        first += layers[l];
+    }
+    return g;
+}
+
+void dag_run( allocator_type salloc, dag & g, std::uint32_t id) {
+    dag_task & t = g.tasks[id];
+    std::uint64_t value = id;
+    for ( std::uint32_t p : t.preds) {
+        value += g.tasks[p].value;
+    }
+    t.value = spin( value, t.cost);
+    for ( std::uint32_t s : t.succs) {
+        if ( 1 == g.tasks[s].pending.fetch_sub( 1, std::memory_order_acq_rel) ) {
+            boost::fibers::fiber{ std::allocator_arg, salloc, dag_run, salloc, std::ref( g), s }.detach();
+        }
+    }
+    account();
+    if ( 1 == g.remaining.fetch_sub( 1, std::memory_order_acq_rel) ) {
+        g.done.set_value();
+    }
+}
+
+std::uint64_t dag_checksum( dag & g) {
+    std::uint64_t sum = 0;
+    for ( std::size_t i = 0; i < g.size; ++i) {
+        sum += g.tasks[i].value;
+    }
+    return sum;
+}
+
+// scheduler statistics summed over the threads of a run
+struct counters {
+    std::uint64_t               steals{ 0 };
+    std::uint64_t               failed_steals{ 0 };
+    bool                        enabled{ false };
+};
+
+counters snapshot( std::vector< std::thread::id > const& ids) {
+    counters c;
+    for ( boost::fibers::scheduler_stats const& s : boost::fibers::all_scheduler_stats() ) {
+        if ( ids.end() == std::find( ids.begin(), ids.end(), s.thread_id) ) {
+            continue;
+        }
+        c.enabled = s.enabled;
+        c.steals += s.steals;
+        c.failed_steals += s.failed_steals;
+    }
+    return c;
+}
+
+struct result {
+    std::string                 bench;
+    std::string                 algo;
+    std::size_t                 threads;
+    duration_type               duration;
+    double                      speedup;
+    counters                    stats;
+    double                      idle;
+    std::uint64_t               value;
+};
+
+// runs fn in a fiber of the first of n threads using algo
+result run( std::string const& algo, std::size_t n, bool suspend, std::function< std::uint64_t() > const& fn) {
+    barrier b( n);
+    std::mutex mtx;
+    boost::fibers::condition_variable_any cnd;
+    bool done = false;
+    std::vector< std::thread::id > ids( n);
+    result r{};
+    r.algo = algo;
+    r.threads = n;
+    auto thread = [&](std::size_t idx){
+        bind_to_processor( idx % ( std::max)( 1u, std::thread::hardware_concurrency() ) );
+        if ( "work_stealing" == algo) {
+            boost::fibers::use_scheduling_algorithm< boost::fibers::algo::work_stealing >( n - 1, idx, suspend);
+        } else {
+            boost::fibers::use_scheduling_algorithm< boost::fibers::algo::shared_work >( suspend);
+        }
+        ids[idx] = std::this_thread::get_id();
+        b.wait();
+        if ( 0 == idx) {
+            counters before = snapshot( ids);
+            busy_ns = 0;
+            time_point_type start{ clock_type::now() };
+            boost::fibers::fiber f{ [&r,&fn](){
+                r.value = fn();
+                account();
+            }};
+            f.join();
+            r.duration = clock_type::now() - start;
+            counters after = snapshot( ids);
+            r.stats.enabled = after.enabled;
+            r.stats.steals = after.steals - before.steals;
+            r.stats.failed_steals = after.failed_steals - before.failed_steals;
+            std::unique_lock< std::mutex > lk( mtx);
+            done = true;
+            lk.unlock();
+            cnd.notify_all();
+        } else {
+            std::unique_lock< std::mutex > lk( mtx);
+            cnd.wait( lk, [&done](){ return done; });
+        }
+    };
+    // the calling thread is not used, each run starts with fresh schedulers
+    std::vector< std::thread > threads;
+    for ( std::size_t i = 0; i < n; ++i) {
+        threads.emplace_back( thread, i);
+    }
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    std::int64_t total = ( std::max)( std::int64_t{ 1 },
+            static_cast< std::int64_t >( n * std::chrono::duration_cast< std::chrono::nanoseconds >( r.duration).count() ) );
+    r.idle = ( std::max)( 0., 1. - static_cast< double >( busy_ns.load() ) / total);
+    return r;
+}
+
+void print( result const& r, bool json, bool & first) {
+    double ms = std::chrono::duration< double, std::milli >( r.duration).count();
+    if ( json) {
+        std::cout << ( first ? "" : ",\n")
+                  << "  {\"bench\":\"" << r.bench
+                  << "\",\"algo\":\"" << r.algo
+                  << "\",\"threads\":" << r.threads
+                  << ",\"result\":" << r.value
+                  << ",\"ns\":" << std::chrono::duration_cast< std::chrono::nanoseconds >( r.duration).count()
+                  << ",\"speedup\":" << std::fixed << std::setprecision( 2) << r.speedup;
+        if ( r.stats.enabled) {
+            std::cout << ",\"steals\":" << r.stats.steals
+                      << ",\"failed_steals\":" << r.stats.failed_steals
+                      << ",\"idle\":" << std::setprecision( 3) << r.idle;
+        }
+        std::cout << "}";
+    } else {
+        std::cout << std::left << std::setw( 5) << r.bench << std::setw( 15) << r.algo << std::right
+                  << std::setw( 3) << r.threads << " threads: "
+                  << std::fixed << std::setprecision( 1) << std::setw( 9) << ms << " ms, speed-up "
+                  << std::setprecision( 2) << r.speedup;
+        if ( r.stats.enabled) {
+            std::cout << ", " << r.stats.steals << " steals (" << r.stats.failed_steals << " failed), idle "
+                      << std::setprecision( 1) << 100. * r.idle << "%";
+        }
+        std::cout << std::endl;
+    }
+    first = false;
+}
+
+char const* value( char const* arg, char const* name) {
+    std::size_t n = std::strlen( name);
+    return 0 == std::strncmp( arg, name, n) && '=' == arg[n] ? arg + n + 1 : nullptr;
+}
+
+int main( int argc, char * argv[]) {
+    try {
+        std::string bench_opt{ "all" }, algo_opt{ "all" };
+        std::size_t max_threads = ( std::max)( 2u, std::thread::hardware_concurrency() );
+        bool json = false, suspend = false;
+        for ( int i = 1; i < argc; ++i) {
+            char const* v = nullptr;
+            if ( 0 == std::strcmp( argv[i], "--json") ) {
+                json = true;
+            } else if ( 0 == std::strcmp( argv[i], "--suspend") ) {
+                suspend = true;
+            } else if ( nullptr != ( v = value( argv[i], "--bench") ) ) {
+                bench_opt = v;
+            } else if ( nullptr != ( v = value( argv[i], "--algo") ) ) {
+                algo_opt = v;
+            } else if ( nullptr != ( v = value( argv[i], "--threads") ) ) {
+                max_threads = std::strtoul( v, nullptr, 10);
+            } else {
+                std::cerr << "usage: " << argv[0]
+                          << " [--bench=uts|fib|dag|all] [--algo=work_stealing|shared_work|all]"
+                             " [--threads=N] [--suspend] [--json]" << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        if ( 0 == max_threads) {
+            throw std::invalid_argument( "threads must be positive");
+        }
+        allocator_type salloc{ stack_size };
+        std::unique_ptr< dag > g;
+        struct benchmark {
+            std::string                         name;
+            // called before each run, not measured
+            std::function< void() >             setup;
+            std::function< std::uint64_t() >    fn;
+        };
+        std::vector< benchmark > benches{
+            { "uts", [](){}, [salloc](){ return uts( salloc, 0, true); } },
+            { "fib", [](){}, [salloc](){ return fib( salloc, fib_n); } },
+            { "dag", [&g](){ g = make_dag(); }, [salloc,&g](){
+                    for ( std::uint32_t s : g->sources) {
+                        boost::fibers::fiber{ std::allocator_arg, salloc, dag_run, salloc, std::ref( * g), s }.detach();
+                    }
+                    g->done.get_future().wait();
+                    return dag_checksum( * g);
+                } }
+        };
+        std::vector< std::string > algos;
+        if ( "all" == algo_opt) {
+            algos = { "work_stealing", "shared_work" };
+        } else if ( "work_stealing" == algo_opt || "shared_work" == algo_opt) {
+            algos = { algo_opt };
+        } else {
+            throw std::invalid_argument( "unknown algorithm " + algo_opt);
+        }
+        if ( json) {
+            std::cout << "{\"suite\":\"irregular\",\"results\":[\n";
+        }
+        bool first = true, found = false;
+        for ( auto const& bench : benches) {
+            if ( "all" != bench_opt && bench.name != bench_opt) {
+                continue;
+            }
+            found = true;
+            std::uint64_t expected = 0;
+            for ( std::string const& algo : algos) {
+                duration_type base{ duration_type::zero() };
+                for ( std::size_t n = 1; n <= max_threads; n = n < max_threads && max_threads < 2 * n ? max_threads : 2 * n) {
+                    bench.setup();
+                    result r = run( algo, n, suspend, bench.fn);
+                    r.bench = bench.name;
+                    if ( 0 == expected) {
+                        expected = r.value;
+                    } else if ( expected != r.value) {
+                        throw std::runtime_error( bench.name + ": invalid result");
+                    }
+                    if ( 1 == n) {
+                        base = r.duration;
+                    }
+                    r.speedup = static_cast< double >( base.count() ) / r.duration.count();
+                    print( r, json, first);
+                }
+            }
+        }
+        if ( json) {
+            std::cout << "\n]}" << std::endl;
+        }
+        if ( ! found) {
+            throw std::invalid_argument( "unknown benchmark " + bench_opt);
+        }
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,241 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// memory footprint of idle fibers: creates N fibers (default 1M) blocked on
+// a channel, for each stack allocator, and reports
+//   - resident and virtual memory per fiber (from /proc/self/statm, the
+//     growth of the process while the fibers exist),
+//   - the time to create the fibers and run them until they are blocked,
+//   - the time to wake them and release them.
+// each allocator is measured in a process of its own (fork()) so that the
+// memory kept by one allocator does not show up as baseline of the next.
+// all fibers wait on one channel, i.e. the numbers are the costs of the
+// fibers, not of channels.
+// protected_fixedsize_stack needs two mappings per stack, its fibers are
+// limited by vm.max_map_count. if an allocator throws, the fibers created
+// so far are measured and the failure is reported.
+//
+// usage: memory [--fibers=N] [--stack=bytes] [--json]
+// segmented_stack is measured if built with BOOST_USE_SEGMENTED_STACKS
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <boost/fiber/all.hpp>
+
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+
+struct options {
+    std::size_t     fibers{ 1000000 };
+    // 0: default size of the allocator
+    std::size_t     stack{ 0 };
+    bool            json{ false };
+};
+
+// written by the child to the pipe
+struct result {
+    std::uint64_t   requested;
+    std::uint64_t   created;
+    std::int64_t    rss;        // bytes
+    std::int64_t    vm;         // bytes
+    std::int64_t    create_ns;
+    std::int64_t    teardown_ns;
+    char            error[128];
+};
+
+bool statm( std::int64_t & vm, std::int64_t & rss) {
+    std::FILE * f = std::fopen( "/proc/self/statm", "r");
+    if ( nullptr == f) {
+        return false;
+    }
+    long size = 0, resident = 0;
+    bool ok = 2 == std::fscanf( f, "%ld %ld", & size, & resident);
+    std::fclose( f);
+    long page = ::sysconf( _SC_PAGESIZE);
+    vm = static_cast< std::int64_t >( size) * page;
+    rss = static_cast< std::int64_t >( resident) * page;
+    return ok;
+}
+
+// maximal number of fibers with a guard page below their stacks
+std::size_t map_limit() {
+    long count = 65530;
+    if ( std::FILE * f = std::fopen( "/proc/sys/vm/max_map_count", "r") ) {
+        if ( 1 != std::fscanf( f, "%ld", & count) ) {
+            count = 65530;
+        }
+        std::fclose( f);
+    }
+    // keep some mappings for the rest of the process
+    return count > 2048 ? static_cast< std::size_t >( count - 1024) / 2 : 0;
+}
+
+template< typename StackAllocator >
+result measure( StackAllocator salloc, std::size_t n, std::size_t limit) {
+    result r{};
+    if ( limit < n) {
+        std::snprintf( r.error, sizeof( r.error), "limited by vm.max_map_count");
+        n = limit;
+    }
+    r.requested = n;
+    boost::fibers::unbuffered_channel< int > chan;
+    std::size_t blocked = 0, alive = 0;
+    auto idle = [&chan,&blocked,&alive](){
+        ++blocked;
+        int value = 0;
+        chan.pop( value);
+        --alive;
+    };
+    std::int64_t vm0 = 0, rss0 = 0, vm1 = 0, rss1 = 0;
+    statm( vm0, rss0);
+    time_point_type start{ clock_type::now() };
+    try {
+        for ( std::size_t i = 0; i < n; ++i) {
+            boost::fibers::fiber{ std::allocator_arg, salloc, idle }.detach();
+            ++alive;
+        }
+    } catch ( std::exception const& e) {
+        std::snprintf( r.error, sizeof( r.error), "after %zu fibers: %s", alive, e.what() );
+    }
+    r.created = alive;
+    // run the fibers until all are blocked on the channel
+    while ( blocked < alive) {
+        boost::this_fiber::yield();
+    }
+    r.create_ns = std::chrono::duration_cast< std::chrono::nanoseconds >( clock_type::now() - start).count();
+    statm( vm1, rss1);
+    r.vm = vm1 - vm0;
+    r.rss = rss1 - rss0;
+    start = clock_type::now();
+    chan.close();
+    while ( 0 < alive) {
+        boost::this_fiber::yield();
+    }
+    // the terminated fibers are released by the dispatcher
+    boost::this_fiber::yield();
+    r.teardown_ns = std::chrono::duration_cast< std::chrono::nanoseconds >( clock_type::now() - start).count();
+    return r;
+}
+
+template< typename StackAllocator >
+StackAllocator make_allocator( std::size_t size) {
+    return 0 == size ? StackAllocator{} : StackAllocator{ size };
+}
+
+template< typename StackAllocator >
+bool run( char const* name, options const& opts, bool & first,
+          std::size_t limit = static_cast< std::size_t >( -1) ) {
+    int fds[2];
+    if ( 0 != ::pipe( fds) ) {
+        std::perror( "pipe");
+        return false;
+    }
+    ::pid_t pid = ::fork();
+    if ( 0 > pid) {
+        std::perror( "fork");
+        return false;
+    }
+    if ( 0 == pid) {
+        ::close( fds[0]);
+        result r = measure( make_allocator< StackAllocator >( opts.stack), opts.fibers, limit);
+        bool ok = sizeof( r) == ::write( fds[1], & r, sizeof( r) );
+        ::_exit( ok ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    ::close( fds[1]);
+    result r{};
+    bool ok = sizeof( r) == ::read( fds[0], & r, sizeof( r) );
+    ::close( fds[0]);
+    int status = 0;
+    ::waitpid( pid, & status, 0);
+    if ( ! ok) {
+        // killed, e.g. by the OOM killer
+        if ( WIFSIGNALED( status) ) {
+            std::snprintf( r.error, sizeof( r.error), "terminated by signal %d", WTERMSIG( status) );
+        } else {
+            std::snprintf( r.error, sizeof( r.error), "terminated (status %d)", status);
+        }
+        r.requested = opts.fibers;
+    }
+    double per_fiber_rss = 0 == r.created ? 0. : static_cast< double >( r.rss) / r.created;
+    double per_fiber_vm = 0 == r.created ? 0. : static_cast< double >( r.vm) / r.created;
+    if ( opts.json) {
+        std::cout << ( first ? "" : ",\n")
+                  << "  {\"allocator\":\"" << name
+                  << "\",\"stack\":" << opts.stack
+                  << ",\"fibers\":" << r.created
+                  << ",\"rss_per_fiber\":" << std::fixed << std::setprecision( 0) << per_fiber_rss
+                  << ",\"vm_per_fiber\":" << per_fiber_vm
+                  << ",\"create_ns\":" << r.create_ns
+                  << ",\"teardown_ns\":" << r.teardown_ns
+                  << ",\"error\":\"" << r.error << "\"}";
+    } else {
+        std::cout << std::left << std::setw( 28) << name << std::right
+                  << std::setw( 8) << r.created << " fibers: "
+                  << std::fixed << std::setprecision( 0)
+                  << per_fiber_rss << " B rss, " << per_fiber_vm << " B vm per fiber, create "
+                  << std::setprecision( 3) << r.create_ns / 1e6 << " ms, teardown "
+                  << r.teardown_ns / 1e6 << " ms";
+        if ( '\0' != r.error[0]) {
+            std::cout << " (" << r.error << ")";
+        }
+        std::cout << std::endl;
+    }
+    first = false;
+    return ok && r.created == r.requested;
+}
+
+char const* value( char const* arg, char const* name) {
+    std::size_t n = std::strlen( name);
+    return 0 == std::strncmp( arg, name, n) && '=' == arg[n] ? arg + n + 1 : nullptr;
+}
+
+int main( int argc, char * argv[]) {
+    options opts;
+    for ( int i = 1; i < argc; ++i) {
+        char const* v = nullptr;
+        if ( 0 == std::strcmp( argv[i], "--json") ) {
+            opts.json = true;
+        } else if ( nullptr != ( v = value( argv[i], "--fibers") ) ) {
+            opts.fibers = std::strtoul( v, nullptr, 10);
+        } else if ( nullptr != ( v = value( argv[i], "--stack") ) ) {
+            opts.stack = std::strtoul( v, nullptr, 10);
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--fibers=N] [--stack=bytes] [--json]" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    if ( opts.json) {
+        std::cout << "{\"suite\":\"memory\",\"sizeof_context\":" << sizeof( boost::fibers::context)
+                  << ",\"results\":[\n";
+    } else {
+        std::cout << "sizeof(context): " << sizeof( boost::fibers::context) << " B" << std::endl;
+    }
+    bool first = true, ok = true;
+    ok &= run< boost::fibers::fixedsize_stack >( "fixedsize_stack", opts, first);
+    ok &= run< boost::fibers::pooled_fixedsize_stack >( "pooled_fixedsize_stack", opts, first);
+    ok &= run< boost::fibers::protected_fixedsize_stack >( "protected_fixedsize_stack", opts, first, map_limit() );
+#if defined(BOOST_USE_SEGMENTED_STACKS)
+    ok &= run< boost::fibers::segmented_stack >( "segmented_stack", opts, first);
+#endif
+    if ( opts.json) {
+        std::cout << "\n]}" << std::endl;
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,457 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// simulated RPC server: N worker threads run fibers serving requests that
+// arrive over local socketpairs
+//
+// a client thread sends requests open-loop (at a fixed rate, independent of
+// the responses) over the connections; an I/O thread reads the requests on
+// the server side and passes them through a channel to handler fibers.
+// each request
+//   - does some CPU work (a random number of iterations),
+//   - looks up and updates a cache guarded by a fiber mutex,
+//   - hops through a channel to a backend fiber and waits for its answer
+//     (future::get()),
+//   - every 20th request sleeps 50-250us (a timed wait, simulating a slow
+//     downstream call)
+// before the response is written back. The client measures the latency
+// from the time a request was scheduled to be sent until its response has
+// been read, i.e. queueing delays are included (no coordinated omission).
+//
+// usage: rpc [--algo=round_robin|shared_work|work_stealing|all]
+//            [--threads=N] [--rate=requests/s] [--seconds=S]
+//            [--connections=N] [--work=iterations] [--json]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <boost/fiber/all.hpp>
+
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+
+struct options {
+    std::string     algo{ "all" };
+    std::size_t     threads{ ( std::max)( 2u, std::thread::hardware_concurrency() ) };
+    std::uint64_t   rate{ 10000 };
+    std::uint64_t   seconds{ 2 };
+    std::size_t     connections{ 16 };
+    std::uint32_t   work{ 2000 };
+    std::size_t     handlers{ 16 };     // per worker thread
+    std::size_t     backends{ 2 };      // per worker thread
+    bool            json{ false };
+};
+
+struct request {
+    std::uint64_t   id;
+    // when the request was scheduled to be sent, ns of clock_type
+    std::int64_t    sent;
+    std::uint32_t   key;
+    std::uint32_t   work;
+};
+
+struct response {
+    std::uint64_t   id;
+    std::int64_t    sent;
+    std::uint64_t   value;
+};
+
+struct connection {
+    int                     server_fd{ -1 };
+    int                     client_fd{ -1 };
+    // responses are written by the handler fibers of all worker threads
+    boost::fibers::mutex    write_mtx{};
+    // partial request, read by the I/O thread
+    std::vector< char >     in{};
+    std::vector< char >     out{};
+};
+
+struct work_item {
+    request         req;
+    connection  *   conn;
+};
+
+struct backend_job {
+    std::uint64_t                               input;
+    boost::fibers::promise< std::uint64_t >     result{};
+};
+
+struct server {
+    options const                                       &   opts;
+    std::vector< std::unique_ptr< connection > >            conns;
+    boost::fibers::buffered_channel< work_item >            requests{ 1024 };
+    boost::fibers::buffered_channel< backend_job * >        backend{ 1024 };
+    boost::fibers::mutex                                    cache_mtx{};
+    std::unordered_map< std::uint32_t, std::uint64_t >      cache{};
+    std::atomic< std::size_t >                              handlers{ 0 };
+    std::atomic< std::size_t >                              backends{ 0 };
+    std::atomic< std::uint64_t >                            timed_waits{ 0 };
+    std::atomic< bool >                                     stop_io{ false };
+    // the worker threads wait for done
+    std::mutex                                              done_mtx{};
+    boost::fibers::condition_variable_any                   done_cnd{};
+    bool                                                    done{ false };
+
+    explicit server( options const& o) :
+        opts( o) {
+    }
+};
+
+std::uint64_t spin( std::uint64_t x, std::uint32_t n) {
+    // xorshift
+    for ( std::uint32_t i = 0; i < n; ++i) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+    }
+    return x;
+}
+
+void write_all( int fd, void const* data, std::size_t size) {
+    char const* p = static_cast< char const* >( data);
+    while ( 0 < size) {
+        ::ssize_t n = ::write( fd, p, size);
+        if ( 0 > n) {
+            if ( EINTR == errno) {
+                continue;
+            }
+            throw std::runtime_error( std::string{ "write: " } + std::strerror( errno) );
+        }
+        p += n;
+        size -= static_cast< std::size_t >( n);
+    }
+}
+
+// appends what is readable on fd to buf and passes the complete messages
+// to fn; returns false if the peer closed the connection
+template< typename Message, typename Fn >
+bool read_messages( int fd, std::vector< char > & buf, Fn && fn) {
+    char data[4096];
+    ::ssize_t n = ::read( fd, data, sizeof( data) );
+    if ( 0 > n) {
+        if ( EINTR == errno || EAGAIN == errno || EWOULDBLOCK == errno) {
+            return true;
+        }
+        throw std::runtime_error( std::string{ "read: " } + std::strerror( errno) );
+    }
+    if ( 0 == n) {
+        return false;
+    }
+    buf.insert( buf.end(), data, data + n);
+    std::size_t off = 0;
+    for ( ; off + sizeof( Message) <= buf.size(); off += sizeof( Message) ) {
+        Message m;
+        std::memcpy( & m, buf.data() + off, sizeof( Message) );
+        fn( m);
+    }
+    buf.erase( buf.begin(), buf.begin() + off);
+    return true;
+}
+
+void handler( server & s) {
+    work_item item;
+    while ( boost::fibers::channel_op_status::success == s.requests.pop( item) ) {
+        request const& req = item.req;
+        // CPU work
+        std::uint64_t value = spin( req.id + 1, req.work);
+        // shared cache
+        {
+            std::unique_lock< boost::fibers::mutex > lk( s.cache_mtx);
+            auto i = s.cache.find( req.key);
+            if ( s.cache.end() != i) {
+                value ^= i->second;
+                i->second = value;
+            } else {
+                s.cache.emplace( req.key, value);
+            }
+        }
+        // channel hop to a backend fiber
+        backend_job job{ value };
+        boost::fibers::future< std::uint64_t > f = job.result.get_future();
+        s.backend.push( & job);
+        value = f.get();
+        // slow downstream call, every 20th request
+        if ( 0 == req.id % 20) {
+            boost::this_fiber::sleep_for( std::chrono::microseconds( 50 + value % 200) );
+            s.timed_waits.fetch_add( 1, std::memory_order_relaxed);
+        }
+        response resp{ req.id, req.sent, value };
+        std::unique_lock< boost::fibers::mutex > lk( item.conn->write_mtx);
+        write_all( item.conn->server_fd, & resp, sizeof( resp) );
+    }
+    if ( 1 == s.handlers.fetch_sub( 1) ) {
+        // the last handler stops the backends
+        s.backend.close();
+    }
+}
+
+void backend( server & s) {
+    backend_job * job = nullptr;
+    while ( boost::fibers::channel_op_status::success == s.backend.pop( job) ) {
+        job->result.set_value( spin( job->input, 100) );
+    }
+    s.backends.fetch_sub( 1);
+}
+
+void worker( server & s, std::string const& algo, std::size_t idx, std::size_t n) {
+    if ( "shared_work" == algo) {
+        boost::fibers::use_scheduling_algorithm< boost::fibers::algo::shared_work >( true);
+    } else if ( "work_stealing" == algo) {
+        boost::fibers::use_scheduling_algorithm< boost::fibers::algo::work_stealing >( n - 1, idx, true);
+    }
+    for ( std::size_t i = 0; i < s.opts.handlers; ++i) {
+        boost::fibers::fiber{ handler, std::ref( s) }.detach();
+    }
+    for ( std::size_t i = 0; i < s.opts.backends; ++i) {
+        boost::fibers::fiber{ backend, std::ref( s) }.detach();
+    }
+    // keep the thread running fibers until the server is shut down
+    std::unique_lock< std::mutex > lk( s.done_mtx);
+    s.done_cnd.wait( lk, [&s](){ return s.done; });
+}
+
+void io( server & s) {
+    int ep = ::epoll_create1( 0);
+    for ( std::unique_ptr< connection > & c : s.conns) {
+        ::epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.ptr = c.get();
+        ::epoll_ctl( ep, EPOLL_CTL_ADD, c->server_fd, & ev);
+    }
+    ::epoll_event events[64];
+    while ( ! s.stop_io.load() ) {
+        int n = ::epoll_wait( ep, events, 64, 10);
+        for ( int i = 0; i < n; ++i) {
+            connection * c = static_cast< connection * >( events[i].data.ptr);
+            read_messages< request >( c->server_fd, c->in, [&s,c]( request const& req){
+                s.requests.push( work_item{ req, c });
+            });
+        }
+    }
+    ::close( ep);
+}
+
+struct result {
+    std::string                             algo;
+    std::size_t                             threads;
+    std::uint64_t                           sent;
+    std::uint64_t                           received;
+    double                                  throughput;
+    std::uint64_t                           timed_waits;
+    boost::fibers::latency_histogram        latency;
+};
+
+result run( options const& opts, std::string const& algo) {
+    server s{ opts };
+    for ( std::size_t i = 0; i < opts.connections; ++i) {
+        int fds[2];
+        if ( 0 != ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds) ) {
+            throw std::runtime_error( std::string{ "socketpair: " } + std::strerror( errno) );
+        }
+        s.conns.emplace_back( new connection{} );
+        s.conns.back()->server_fd = fds[0];
+        s.conns.back()->client_fd = fds[1];
+    }
+    s.handlers = opts.threads * opts.handlers;
+    s.backends = opts.threads * opts.backends;
+    std::vector< std::thread > workers;
+    for ( std::size_t i = 0; i < opts.threads; ++i) {
+        workers.emplace_back( worker, std::ref( s), std::cref( algo), i, opts.threads);
+    }
+    std::thread io_thread{ io, std::ref( s) };
+
+    std::uint64_t total = opts.rate * opts.seconds;
+    duration_type interval = std::chrono::duration_cast< duration_type >(
+            std::chrono::nanoseconds( 1000000000) / opts.rate);
+    time_point_type start = clock_type::now() + std::chrono::milliseconds( 10);
+    result r{ algo, opts.threads, total, 0, 0., 0, {} };
+    // reads the responses
+    time_point_type last = start;
+    std::thread reader{ [&s,&r,&last,total](){
+        int ep = ::epoll_create1( 0);
+        for ( std::unique_ptr< connection > & c : s.conns) {
+            ::epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.ptr = c.get();
+            ::epoll_ctl( ep, EPOLL_CTL_ADD, c->client_fd, & ev);
+        }
+        ::epoll_event events[64];
+        time_point_type give_up = (time_point_type::max)();
+        while ( r.received < total && clock_type::now() < give_up) {
+            int n = ::epoll_wait( ep, events, 64, 10);
+            for ( int i = 0; i < n; ++i) {
+                connection * c = static_cast< connection * >( events[i].data.ptr);
+                read_messages< response >( c->client_fd, c->out, [&r,&last]( response const& resp){
+                    last = clock_type::now();
+                    r.latency.record( last - time_point_type{ duration_type{ resp.sent } });
+                    ++r.received;
+                });
+            }
+            if ( (time_point_type::max)() == give_up && 0 == n && r.received + 1000 < total &&
+                 clock_type::now() - last > std::chrono::seconds( 10) ) {
+                // stalled
+                give_up = clock_type::now();
+            }
+        }
+        ::close( ep);
+    }};
+    // sends the requests open-loop
+    std::minstd_rand rnd{ 42 };
+    std::uniform_int_distribution< std::uint32_t > keys{ 0, 9999 };
+    std::uniform_int_distribution< std::uint32_t > work{ 0, 2 * opts.work };
+    for ( std::uint64_t i = 0; i < total; ++i) {
+        time_point_type scheduled = start + i * interval;
+        time_point_type now = clock_type::now();
+        if ( std::chrono::microseconds( 200) < scheduled - now) {
+            std::this_thread::sleep_until( scheduled - std::chrono::microseconds( 100) );
+        }
+        while ( clock_type::now() < scheduled) {
+        }
+        request req{ i, scheduled.time_since_epoch().count(), keys( rnd), work( rnd) };
+        write_all( s.conns[i % s.conns.size()]->client_fd, & req, sizeof( req) );
+    }
+    reader.join();
+    r.throughput = r.received / std::chrono::duration< double >( last - start).count();
+    r.timed_waits = s.timed_waits.load();
+    // shut down: I/O thread, handlers, backends, worker threads
+    s.stop_io = true;
+    io_thread.join();
+    s.requests.close();
+    while ( 0 != s.handlers.load() || 0 != s.backends.load() ) {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1) );
+    }
+    {
+        std::unique_lock< std::mutex > lk( s.done_mtx);
+        s.done = true;
+    }
+    s.done_cnd.notify_all();
+    for ( std::thread & t : workers) {
+        t.join();
+    }
+    for ( std::unique_ptr< connection > & c : s.conns) {
+        ::close( c->server_fd);
+        ::close( c->client_fd);
+    }
+    return r;
+}
+
+std::int64_t us( std::chrono::nanoseconds ns) {
+    return std::chrono::duration_cast< std::chrono::microseconds >( ns).count();
+}
+
+void print( result const& r, options const& opts) {
+    if ( opts.json) {
+        std::cout << "  {\"algo\":\"" << r.algo
+                  << "\",\"threads\":" << r.threads
+                  << ",\"rate\":" << opts.rate
+                  << ",\"sent\":" << r.sent
+                  << ",\"received\":" << r.received
+                  << ",\"throughput\":" << std::fixed << std::setprecision( 1) << r.throughput
+                  << ",\"timed_waits\":" << r.timed_waits
+                  << ",\"p50_ns\":" << r.latency.p50().count()
+                  << ",\"p90_ns\":" << r.latency.percentile( 90.).count()
+                  << ",\"p99_ns\":" << r.latency.p99().count()
+                  << ",\"p999_ns\":" << r.latency.p999().count()
+                  << ",\"max_ns\":" << r.latency.max().count() << "}";
+        return;
+    }
+    std::cout << std::left << std::setw( 14) << r.algo << std::right
+              << r.threads << " threads, " << r.received << "/" << r.sent << " responses, "
+              << std::fixed << std::setprecision( 0) << r.throughput << " req/s, latency us"
+              << " p50 " << us( r.latency.p50() )
+              << " p90 " << us( r.latency.percentile( 90.) )
+              << " p99 " << us( r.latency.p99() )
+              << " p99.9 " << us( r.latency.p999() )
+              << " max " << us( r.latency.max() )
+              << ", " << r.timed_waits << " timed waits" << std::endl;
+}
+
+char const* value( char const* arg, char const* name) {
+    std::size_t n = std::strlen( name);
+    return 0 == std::strncmp( arg, name, n) && '=' == arg[n] ? arg + n + 1 : nullptr;
+}
+
+int main( int argc, char * argv[]) {
+    try {
+        options opts;
+        for ( int i = 1; i < argc; ++i) {
+            char const* v = nullptr;
+            if ( 0 == std::strcmp( argv[i], "--json") ) {
+                opts.json = true;
+            } else if ( nullptr != ( v = value( argv[i], "--algo") ) ) {
+                opts.algo = v;
+            } else if ( nullptr != ( v = value( argv[i], "--threads") ) ) {
+                opts.threads = std::strtoul( v, nullptr, 10);
+            } else if ( nullptr != ( v = value( argv[i], "--rate") ) ) {
+                opts.rate = std::strtoull( v, nullptr, 10);
+            } else if ( nullptr != ( v = value( argv[i], "--seconds") ) ) {
+                opts.seconds = std::strtoull( v, nullptr, 10);
+            } else if ( nullptr != ( v = value( argv[i], "--connections") ) ) {
+                opts.connections = std::strtoul( v, nullptr, 10);
+            } else if ( nullptr != ( v = value( argv[i], "--work") ) ) {
+                opts.work = static_cast< std::uint32_t >( std::strtoul( v, nullptr, 10) );
+            } else {
+                std::cerr << "usage: " << argv[0]
+                          << " [--algo=round_robin|shared_work|work_stealing|all] [--threads=N]"
+                             " [--rate=requests/s] [--seconds=S] [--connections=N] [--work=iterations] [--json]"
+                          << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        if ( 0 == opts.threads || 0 == opts.rate || 0 == opts.connections) {
+            throw std::invalid_argument( "threads, rate and connections must be positive");
+        }
+        std::vector< std::string > algos;
+        if ( "all" == opts.algo) {
+            algos = { "round_robin", "shared_work", "work_stealing" };
+        } else if ( "round_robin" == opts.algo || "shared_work" == opts.algo || "work_stealing" == opts.algo) {
+            algos = { opts.algo };
+        } else {
+            throw std::invalid_argument( "unknown algorithm " + opts.algo);
+        }
+        if ( opts.json) {
+            std::cout << "{\"suite\":\"rpc\",\"results\":[\n";
+        }
+        for ( std::size_t i = 0; i < algos.size(); ++i) {
+            result r = run( opts, algos[i]);
+            if ( opts.json && 0 < i) {
+                std::cout << ",\n";
+            }
+            print( r, opts);
+        }
+        if ( opts.json) {
+            std::cout << "\n]}" << std::endl;
+        }
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,113 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// cross-shard message passing of the sharded runtime
+//   round-trip: shard 0 submits to shard 1 and waits for the result
+//   throughput: each shard submits to its neighbour, with a window of
+//               outstanding futures
+//   local:      as throughput, but each shard submits to itself
+// each benchmark runs with notified and with busy-polling shards
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/fiber/all.hpp>
+
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+
+constexpr std::size_t window = 256;
+
+duration_type round_trip( std::uint64_t messages, bool busy_poll) {
+    boost::fibers::sharded rt{ 2, true, busy_poll };
+    return rt.submit_to( 0, [&rt,messages](){
+        time_point_type start{ clock_type::now() };
+        for ( std::uint64_t i = 0; i < messages; ++i) {
+            if ( i + 1 != rt.submit_to( 1, [i](){ return i + 1; }).get() ) {
+                throw std::runtime_error( "round-trip: invalid result");
+            }
+        }
+        return clock_type::now() - start;
+    }).get();
+}
+
+duration_type throughput( std::size_t shards, std::uint64_t messages, bool busy_poll, bool local) {
+    boost::fibers::sharded rt{ shards, true, busy_poll };
+    std::vector< boost::fibers::future< std::uint64_t > > results;
+    time_point_type start{ clock_type::now() };
+    for ( std::size_t i = 0; i < shards; ++i) {
+        std::size_t to = local ? i : ( i + 1) % shards;
+        results.push_back( rt.submit_to( i, [&rt,messages,to](){
+            std::deque< boost::fibers::future< std::uint64_t > > pending;
+            std::uint64_t sum = 0;
+            for ( std::uint64_t j = 0; j < messages; ++j) {
+                if ( window == pending.size() ) {
+                    sum += pending.front().get();
+                    pending.pop_front();
+                }
+                pending.push_back( rt.submit_to( to, [j](){ return j; }) );
+            }
+            for ( boost::fibers::future< std::uint64_t > & f : pending) {
+                sum += f.get();
+            }
+            return sum;
+        }) );
+    }
+    for ( boost::fibers::future< std::uint64_t > & f : results) {
+        if ( messages * ( messages - 1) / 2 != f.get() ) {
+            throw std::runtime_error( "throughput: invalid result");
+        }
+    }
+    return clock_type::now() - start;
+}
+
+void print( std::string const& name, duration_type duration, std::uint64_t count) {
+    std::cout << name << count << " messages in "
+              << std::chrono::duration_cast< std::chrono::milliseconds >( duration).count() << " ms, "
+              << std::chrono::duration_cast< std::chrono::nanoseconds >( duration).count() / count
+              << " ns/message, "
+              << static_cast< std::uint64_t >(
+                    count / std::chrono::duration< double >( duration).count() )
+              << " messages/s" << std::endl;
+}
+
+int main( int argc, char * argv[]) {
+    try {
+        std::uint64_t messages{ 100000 };
+        std::size_t shards{ std::thread::hardware_concurrency() };
+        if ( 1 < argc) {
+            messages = std::strtoull( argv[1], nullptr, 10);
+        }
+        if ( 2 < argc) {
+            shards = std::strtoul( argv[2], nullptr, 10);
+        }
+        if ( 2 > shards) {
+            shards = 2;
+        }
+        std::cout << shards << " shards" << std::endl;
+        print( "round-trip notify:    ", round_trip( messages, false), messages);
+        print( "round-trip busy-poll: ", round_trip( messages, true), messages);
+        print( "throughput notify:    ", throughput( shards, messages, false, false), shards * messages);
+        print( "throughput busy-poll: ", throughput( shards, messages, true, false), shards * messages);
+        print( "local notify:         ", throughput( shards, messages, false, true), shards * messages);
+        std::cout << "done." << std::endl;
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+    return EXIT_FAILURE;
+}
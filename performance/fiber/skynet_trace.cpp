@@ -0,0 +1,158 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// skynet_stealing traced by boost::fibers::tracer; the library has to be
+// built with BOOST_FIBERS_HOOKS, the Jamfile requests fiber-hooks=on:
+//   b2 libs/fiber/performance/fiber//skynet_trace
+// open the written file in chrome://tracing or https://ui.perfetto.dev
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/fiber/all.hpp>
+
+#include "barrier.hpp"
+#include "bind/bind_processor.hpp"
+
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+using channel_type = boost::fibers::buffered_channel< std::uint64_t >;
+using allocator_type = boost::fibers::fixedsize_stack;
+using lock_type = std::unique_lock< std::mutex >;
+
+static bool done = false;
+static std::mutex mtx{};
+static boost::fibers::condition_variable_any cnd{};
+
+// microbenchmark
+void skynet( allocator_type & salloc, channel_type & c, std::size_t num, std::size_t size, std::size_t div) {
+    if ( 1 == size) {
+        c.push( num);
+    } else {
+        channel_type rc{ 16 };
+        for ( std::size_t i = 0; i < div; ++i) {
+            auto sub_num = num + i * size / div;
+            boost::fibers::fiber{ boost::fibers::launch::dispatch,
+                                  std::allocator_arg, salloc,
+                                  skynet,
+                                  std::ref( salloc), std::ref( rc), sub_num, size / div, div }.detach();
+        }
+        std::uint64_t sum{ 0 };
+        for ( std::size_t i = 0; i < div; ++i) {
+            sum += rc.value_pop();
+        }
+        c.push( sum);
+    }
+}
+
+void thread( unsigned int max_idx, unsigned int idx, barrier * b) {
+    bind_to_processor( idx);
+    boost::fibers::use_scheduling_algorithm< boost::fibers::algo::work_stealing >( max_idx, idx);
+    b->wait();
+    lock_type lk( mtx);
+    cnd.wait( lk, [](){ return done; });
+    BOOST_ASSERT( done);
+}
+
+duration_type run( allocator_type & salloc, std::size_t size, std::size_t div) {
+    channel_type rc{ 2 };
+    time_point_type start{ clock_type::now() };
+    skynet( salloc, rc, 0, size, div);
+    std::uint64_t result = rc.value_pop();
+    duration_type duration = clock_type::now() - start;
+    std::cout << "Result: " << result << " in " << duration.count() / 1000000 << " ms" << std::endl;
+    return duration;
+}
+
+// cost of recording an event as issued by the library, and the part of it
+// spent reading the TSC
+double record_cost( double & tsc) {
+    boost::fibers::tracer t{ 1024 };
+    boost::fibers::context * ctx = boost::fibers::context::active();
+    std::size_t n = 10000000;
+    t.start();
+    time_point_type start{ clock_type::now() };
+    for ( std::size_t i = 0; i < n; ++i) {
+        boost::fibers::detail::notify_observer( boost::fibers::event_type::resume, ctx, ctx,
+                                                boost::fibers::block_reason::none, nullptr, nullptr);
+    }
+    duration_type duration = clock_type::now() - start;
+    t.stop();
+    start = clock_type::now();
+    for ( std::size_t i = 0; i < n; ++i) {
+        boost::fibers::detail::tsc();
+    }
+    tsc = static_cast< double >( std::chrono::duration_cast< std::chrono::nanoseconds >( clock_type::now() - start).count() ) / n;
+    return static_cast< double >( std::chrono::duration_cast< std::chrono::nanoseconds >( duration).count() ) / n;
+}
+
+int main( int argc, char * argv[]) {
+    try {
+        std::string file = 1 < argc ? argv[1] : "skynet_trace.json";
+        unsigned int cpus = std::thread::hardware_concurrency();
+        barrier b( cpus);
+        unsigned int max_idx = cpus - 1;
+        boost::fibers::use_scheduling_algorithm< boost::fibers::algo::work_stealing >( max_idx, max_idx);
+        bind_to_processor( max_idx);
+        // the same stacks as skynet_stealing
+        std::size_t stack_size{ 4048 };
+        std::size_t size{ 100000 };
+        std::size_t div{ 10 };
+        std::vector< std::thread > threads;
+        for ( unsigned int idx = 0; idx < max_idx; ++idx) {
+            threads.push_back( std::thread( thread, max_idx, idx, & b) );
+        };
+        allocator_type salloc{ stack_size };
+        b.wait();
+        std::cout << "untraced: ";
+        duration_type untraced = run( salloc, size, div);
+        // keeps the last 1M events per thread
+        boost::fibers::tracer tr{ 1024 * 1024 };
+        tr.start();
+        std::cout << "traced:   ";
+        duration_type traced = run( salloc, size, div);
+        tr.stop();
+        lock_type lk( mtx);
+        done = true;
+        lk.unlock();
+        cnd.notify_all();
+        for ( std::thread & t : threads) {
+            t.join();
+        }
+        if ( 0 == tr.size() ) {
+            std::cout << "no events recorded, build the library with BOOST_FIBERS_HOOKS" << std::endl;
+        } else {
+            std::cout << tr.size() << " events, " << tr.overwritten() << " overwritten" << std::endl;
+            double tsc = 0.;
+            double cost = record_cost( tsc);
+            std::cout << "recording: " << cost << " ns/event, " << tsc << " ns of it reading the TSC" << std::endl;
+            std::cout << "overhead:  "
+                      << static_cast< double >( std::chrono::duration_cast< std::chrono::nanoseconds >( traced - untraced).count() ) / tr.size()
+                      << " ns/event (including issuing the event)" << std::endl;
+            std::ofstream os( file);
+            tr.write( os);
+            std::cout << "written to " << file << std::endl;
+        }
+        std::cout << "done." << std::endl;
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+	return EXIT_FAILURE;
+}
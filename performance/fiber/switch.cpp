@@ -0,0 +1,112 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// context switches of fibers, see ../thread/switch_std.cpp for the baseline
+//   ping_pong:   two fibers pass a token back and forth (an op is a round
+//                trip), on the same thread and on two threads
+//   yield:       fibers of one thread yield to each other
+//   create_join: a fiber is launched and joined
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/fiber/all.hpp>
+
+#include "../report.hpp"
+
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+using channel_type = boost::fibers::buffered_channel< std::uint64_t >;
+
+void pong( channel_type & ping, channel_type & pong) {
+    std::uint64_t i = 0;
+    while ( boost::fibers::channel_op_status::success == ping.pop( i) ) {
+        pong.push( i + 1);
+    }
+}
+
+duration_type ping_pong( std::uint64_t ops, bool cross_thread) {
+    channel_type ping{ 2 }, pongs{ 2 };
+    std::thread t;
+    boost::fibers::fiber f;
+    if ( cross_thread) {
+        t = std::thread{ [&ping,&pongs](){ pong( ping, pongs); } };
+    } else {
+        f = boost::fibers::fiber{ [&ping,&pongs](){ pong( ping, pongs); } };
+    }
+    time_point_type start{ clock_type::now() };
+    for ( std::uint64_t i = 0; i < ops; ++i) {
+        ping.push( i);
+        if ( i + 1 != pongs.value_pop() ) {
+            throw std::runtime_error( "ping-pong: invalid result");
+        }
+    }
+    duration_type duration = clock_type::now() - start;
+    ping.close();
+    if ( cross_thread) {
+        t.join();
+    } else {
+        f.join();
+    }
+    return duration;
+}
+
+duration_type yield( std::uint64_t ops, std::size_t fibers) {
+    std::uint64_t per_fiber = ops / fibers;
+    std::vector< boost::fibers::fiber > fs;
+    time_point_type start{ clock_type::now() };
+    for ( std::size_t i = 0; i < fibers; ++i) {
+        fs.emplace_back( [per_fiber](){
+            for ( std::uint64_t j = 0; j < per_fiber; ++j) {
+                boost::this_fiber::yield();
+            }
+        });
+    }
+    for ( boost::fibers::fiber & f : fs) {
+        f.join();
+    }
+    return clock_type::now() - start;
+}
+
+duration_type create_join( std::uint64_t ops, boost::fibers::launch policy) {
+    std::uint64_t sum = 0;
+    time_point_type start{ clock_type::now() };
+    for ( std::uint64_t i = 0; i < ops; ++i) {
+        boost::fibers::fiber{ policy, [&sum,i](){ sum += i; } }.join();
+    }
+    duration_type duration = clock_type::now() - start;
+    if ( ops * ( ops - 1) / 2 != sum) {
+        throw std::runtime_error( "create-join: invalid result");
+    }
+    return duration;
+}
+
+int main( int argc, char * argv[]) {
+    try {
+        bench_report r{ "switch", "fiber", argc, argv, 1000000 };
+        std::uint64_t ops = r.ops();
+        r.add( "ping_pong_same_thread", 1, ops, ping_pong( ops, false) );
+        r.add( "ping_pong_cross_thread", 2, ops / 10, ping_pong( ops / 10, true) );
+        r.add( "yield_2_fibers", 1, ops, yield( ops, 2) );
+        r.add( "yield_100_fibers", 1, ops, yield( ops, 100) );
+        r.add( "create_join_post", 1, ops / 10, create_join( ops / 10, boost::fibers::launch::post) );
+        r.add( "create_join_dispatch", 1, ops / 10, create_join( ops / 10, boost::fibers::launch::dispatch) );
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,173 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// synchronization primitives of fibers, see ../thread/sync_std.cpp for the
+// baseline
+//   mutex:         fibers of 1..N threads increment a counter guarded by
+//                  a mutex (an op is a lock/unlock)
+//   condvar:       two fibers take turns via a condition_variable (an op
+//                  is a round trip), on the same thread and on two threads
+//   future:        a promise is fulfilled and its future is read, by the
+//                  same fiber and by a fiber of another thread
+//   sleep_for:     the time a sleep_for() oversleeps (an op is a sleep,
+//                  ns/op is the mean overshoot)
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/fiber/all.hpp>
+
+#include "../report.hpp"
+
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+
+duration_type mutex( std::uint64_t ops, std::size_t threads) {
+    boost::fibers::mutex mtx;
+    std::uint64_t counter = 0;
+    std::uint64_t per_thread = ops / threads;
+    auto fn = [&mtx,&counter,per_thread](){
+        // two fibers per thread contend in the thread as well
+        auto work = [&mtx,&counter,per_thread](){
+            for ( std::uint64_t i = 0; i < per_thread / 2; ++i) {
+                std::unique_lock< boost::fibers::mutex > lk( mtx);
+                ++counter;
+            }
+        };
+        boost::fibers::fiber f{ work };
+        work();
+        f.join();
+    };
+    std::vector< std::thread > ts;
+    time_point_type start{ clock_type::now() };
+    for ( std::size_t i = 1; i < threads; ++i) {
+        ts.emplace_back( fn);
+    }
+    fn();
+    for ( std::thread & t : ts) {
+        t.join();
+    }
+    duration_type duration = clock_type::now() - start;
+    if ( threads * ( per_thread / 2) * 2 != counter) {
+        throw std::runtime_error( "mutex: invalid result");
+    }
+    return duration;
+}
+
+duration_type condvar( std::uint64_t ops, bool cross_thread) {
+    boost::fibers::mutex mtx;
+    boost::fibers::condition_variable cnd;
+    std::uint64_t turn = 0;
+    // even turns are played by the caller, odd turns by the other fiber
+    auto play = [&mtx,&cnd,&turn,ops]( std::uint64_t parity){
+        std::unique_lock< boost::fibers::mutex > lk( mtx);
+        for (;;) {
+            cnd.wait( lk, [&turn,ops,parity](){ return 2 * ops <= turn || parity == turn % 2; });
+            if ( 2 * ops <= turn) {
+                break;
+            }
+            ++turn;
+            cnd.notify_one();
+        }
+    };
+    std::thread t;
+    boost::fibers::fiber f;
+    time_point_type start{ clock_type::now() };
+    if ( cross_thread) {
+        t = std::thread{ play, 1 };
+    } else {
+        f = boost::fibers::fiber{ play, 1 };
+    }
+    play( 0);
+    if ( cross_thread) {
+        t.join();
+    } else {
+        f.join();
+    }
+    return clock_type::now() - start;
+}
+
+duration_type future_same_fiber( std::uint64_t ops) {
+    std::uint64_t sum = 0;
+    time_point_type start{ clock_type::now() };
+    for ( std::uint64_t i = 0; i < ops; ++i) {
+        boost::fibers::promise< std::uint64_t > p;
+        boost::fibers::future< std::uint64_t > f = p.get_future();
+        p.set_value( i);
+        sum += f.get();
+    }
+    duration_type duration = clock_type::now() - start;
+    if ( ops * ( ops - 1) / 2 != sum) {
+        throw std::runtime_error( "future: invalid result");
+    }
+    return duration;
+}
+
+duration_type future_cross_thread( std::uint64_t ops) {
+    std::vector< boost::fibers::promise< std::uint64_t > > promises( ops);
+    std::vector< boost::fibers::future< std::uint64_t > > futures;
+    for ( boost::fibers::promise< std::uint64_t > & p : promises) {
+        futures.push_back( p.get_future() );
+    }
+    std::uint64_t sum = 0;
+    time_point_type start{ clock_type::now() };
+    std::thread t{ [&promises](){
+        for ( std::uint64_t i = 0; i < promises.size(); ++i) {
+            promises[i].set_value( i);
+        }
+    }};
+    for ( boost::fibers::future< std::uint64_t > & f : futures) {
+        sum += f.get();
+    }
+    duration_type duration = clock_type::now() - start;
+    t.join();
+    if ( ops * ( ops - 1) / 2 != sum) {
+        throw std::runtime_error( "future: invalid result");
+    }
+    return duration;
+}
+
+duration_type sleep_overshoot( std::uint64_t ops, std::chrono::microseconds d) {
+    duration_type overshoot = duration_type::zero();
+    for ( std::uint64_t i = 0; i < ops; ++i) {
+        time_point_type start{ clock_type::now() };
+        boost::this_fiber::sleep_for( d);
+        overshoot += clock_type::now() - start - d;
+    }
+    return overshoot;
+}
+
+int main( int argc, char * argv[]) {
+    try {
+        bench_report r{ "sync", "fiber", argc, argv, 1000000 };
+        std::uint64_t ops = r.ops();
+        for ( std::size_t n : r.thread_counts() ) {
+            std::uint64_t ops_n = ops / 10 / n / 2 * n * 2;
+            r.add( "mutex_" + std::to_string( 2 * n) + "_fibers", n, ops_n, mutex( ops_n, n) );
+        }
+        r.add( "condvar_same_thread", 1, ops, condvar( ops, false) );
+        r.add( "condvar_cross_thread", 2, ops / 10, condvar( ops / 10, true) );
+        r.add( "future_same_fiber", 1, ops, future_same_fiber( ops) );
+        r.add( "future_cross_thread", 2, ops / 10, future_cross_thread( ops / 10) );
+        r.add( "sleep_for_100us_overshoot", 1, 1000, sleep_overshoot( 1000, std::chrono::microseconds( 100) ) );
+        r.add( "sleep_for_1ms_overshoot", 1, 200, sleep_overshoot( 200, std::chrono::microseconds( 1000) ) );
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,128 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+// results of the micro-benchmarks; written as text or, with --json, as one
+// JSON document to stdout:
+//   { "suite": "...", "results": [ { "name": "...", "impl": "fiber",
+//     "threads": 1, "ops": 1000, "ns": 12345, "ns_per_op": 12.3 }, ... ] }
+// options: --json, --ops=N (scales the operations of each benchmark),
+// --threads=N (maximal number of threads, producers and consumers)
+
+#ifndef REPORT_H
+#define REPORT_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+struct bench_result {
+    std::string                 name;
+    std::string                 impl;
+    std::size_t                 threads;
+    std::uint64_t               ops;
+    std::chrono::nanoseconds    duration;
+
+    double ns_per_op() const {
+        return 0 == ops ? 0. : static_cast< double >( duration.count() ) / ops;
+    }
+};
+
+class bench_report {
+private:
+    std::string                     suite_;
+    std::string                     impl_;
+    bool                            json_{ false };
+    std::uint64_t                   ops_{ 0 };
+    std::size_t                     threads_{ 0 };
+    std::vector< bench_result >     results_{};
+
+    static char const* value_( char const* arg, char const* name) {
+        std::size_t n = std::strlen( name);
+        return 0 == std::strncmp( arg, name, n) && '=' == arg[n] ? arg + n + 1 : nullptr;
+    }
+
+public:
+    bench_report( std::string suite, std::string impl, int argc, char * argv[],
+                  std::uint64_t ops) :
+        suite_{ std::move( suite) },
+        impl_{ std::move( impl) },
+        ops_{ ops },
+        threads_{ ( std::max)( 2u, std::thread::hardware_concurrency() ) } {
+        for ( int i = 1; i < argc; ++i) {
+            char const* v = nullptr;
+            if ( 0 == std::strcmp( argv[i], "--json") ) {
+                json_ = true;
+            } else if ( nullptr != ( v = value_( argv[i], "--ops") ) ) {
+                ops_ = std::strtoull( v, nullptr, 10);
+            } else if ( nullptr != ( v = value_( argv[i], "--threads") ) ) {
+                threads_ = std::strtoul( v, nullptr, 10);
+            } else {
+                std::cerr << "usage: " << argv[0] << " [--json] [--ops=N] [--threads=N]" << std::endl;
+                std::exit( EXIT_FAILURE);
+            }
+        }
+    }
+
+    std::uint64_t ops() const {
+        return ops_;
+    }
+
+    std::size_t threads() const {
+        return threads_;
+    }
+
+    // 1, 2, 4, ... up to threads()
+    std::vector< std::size_t > thread_counts() const {
+        std::vector< std::size_t > counts;
+        for ( std::size_t n = 1; n < threads_; n *= 2) {
+            counts.push_back( n);
+        }
+        counts.push_back( threads_);
+        return counts;
+    }
+
+    template< typename Duration >
+    void add( std::string name, std::size_t threads, std::uint64_t ops, Duration duration) {
+        bench_result r{ std::move( name), impl_, threads, ops,
+                        std::chrono::duration_cast< std::chrono::nanoseconds >( duration) };
+        if ( ! json_) {
+            std::cout << std::left << std::setw( 36) << r.name << std::right
+                      << std::setw( 4) << r.threads << " threads "
+                      << std::setw( 10) << r.ops << " ops "
+                      << std::fixed << std::setprecision( 1) << std::setw( 12) << r.ns_per_op()
+                      << " ns/op" << std::endl;
+        }
+        results_.push_back( std::move( r) );
+    }
+
+    ~bench_report() {
+        if ( ! json_) {
+            return;
+        }
+        std::cout << "{\"suite\":\"" << suite_ << "\",\"results\":[";
+        for ( std::size_t i = 0; i < results_.size(); ++i) {
+            bench_result const& r = results_[i];
+            std::cout << ( 0 == i ? "" : ",") << "\n  {\"name\":\"" << r.name
+                      << "\",\"impl\":\"" << r.impl
+                      << "\",\"threads\":" << r.threads
+                      << ",\"ops\":" << r.ops
+                      << ",\"ns\":" << r.duration.count()
+                      << ",\"ns_per_op\":" << std::fixed << std::setprecision( 2) << r.ns_per_op() << "}";
+        }
+        std::cout << "\n]}" << std::endl;
+    }
+};
+
+#endif // REPORT_H
@@ -196,6 +196,29 @@ public:
         }
     }
 
+    channel_op_status pop( value_type & value) {
+        for (;;) {
+            channel_op_status status{ try_pop_( value) };
+            if ( channel_op_status::success == status) {
+                not_full_cnd_.notify_one();
+                return status;
+            } else if ( channel_op_status::empty == status) {
+                std::unique_lock< std::mutex > lk{ mtx_ };
+                if ( is_closed() ) {
+                    return channel_op_status::closed;
+                }
+                if ( ! is_empty_() ) {
+                    continue;
+                }
+                ++waiting_consumer_;
+                not_empty_cnd_.wait( lk, [this](){ return is_closed() || ! is_empty_(); });
+                --waiting_consumer_;
+            } else {
+                return status;
+            }
+        }
+    }
+
     value_type value_pop() {
         for (;;) {
             slot * s{ nullptr };
@@ -0,0 +1,134 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// baseline of ../fiber/channel.cpp with std::thread: 1..N producer and as
+// many consumer threads
+//   buffered_channel_<n>x<n>:  bounded MPMC queue (buffered_channel.hpp)
+//   locked_queue_<n>x<n>:      std::deque guarded by std::mutex
+// an op is a value passed from a producer to a consumer
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffered_channel.hpp"
+#include "../report.hpp"
+
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+
+constexpr std::size_t capacity = 1024;
+
+// unbounded queue as commonly written with the standard library
+template< typename T >
+class locked_queue {
+private:
+    std::mutex                  mtx_{};
+    std::condition_variable     cnd_{};
+    std::deque< T >             queue_{};
+    bool                        closed_{ false };
+
+public:
+    void push( T const& value) {
+        {
+            std::unique_lock< std::mutex > lk( mtx_);
+            queue_.push_back( value);
+        }
+        cnd_.notify_one();
+    }
+
+    channel_op_status pop( T & value) {
+        std::unique_lock< std::mutex > lk( mtx_);
+        cnd_.wait( lk, [this](){ return closed_ || ! queue_.empty(); });
+        if ( queue_.empty() ) {
+            return channel_op_status::closed;
+        }
+        value = queue_.front();
+        queue_.pop_front();
+        return channel_op_status::success;
+    }
+
+    void close() {
+        {
+            std::unique_lock< std::mutex > lk( mtx_);
+            closed_ = true;
+        }
+        cnd_.notify_all();
+    }
+};
+
+template< typename Channel >
+duration_type transfer( Channel & chan, std::uint64_t ops, std::size_t n) {
+    std::uint64_t per_producer = ops / n;
+    std::vector< std::uint64_t > sums( n, 0);
+    std::vector< std::thread > producers, consumers;
+    time_point_type start{ clock_type::now() };
+    for ( std::size_t i = 0; i < n; ++i) {
+        consumers.emplace_back( [&chan,&sums,i](){
+            std::uint64_t value = 0, sum = 0;
+            while ( channel_op_status::success == chan.pop( value) ) {
+                sum += value;
+            }
+            sums[i] = sum;
+        });
+        producers.emplace_back( [&chan,per_producer](){
+            for ( std::uint64_t j = 0; j < per_producer; ++j) {
+                chan.push( j);
+            }
+        });
+    }
+    for ( std::thread & t : producers) {
+        t.join();
+    }
+    chan.close();
+    for ( std::thread & t : consumers) {
+        t.join();
+    }
+    duration_type duration = clock_type::now() - start;
+    std::uint64_t sum = 0;
+    for ( std::uint64_t s : sums) {
+        sum += s;
+    }
+    if ( n * ( per_producer * ( per_producer - 1) / 2) != sum) {
+        throw std::runtime_error( "transfer: invalid result");
+    }
+    return duration;
+}
+
+int main( int argc, char * argv[]) {
+    try {
+        bench_report r{ "channel", "std::thread", argc, argv, 1000000 };
+        for ( std::size_t n : r.thread_counts() ) {
+            std::uint64_t ops = r.ops() / 10 / n * n;
+            std::string suffix = "_" + std::to_string( n) + "x" + std::to_string( n);
+            {
+                buffered_channel< std::uint64_t > chan{ capacity };
+                r.add( "buffered_channel" + suffix, 2 * n, ops, transfer( chan, ops, n) );
+            }
+            {
+                locked_queue< std::uint64_t > chan;
+                r.add( "locked_queue" + suffix, 2 * n, ops, transfer( chan, ops, n) );
+            }
+        }
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,97 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// baseline of ../fiber/switch.cpp with std::thread
+//   ping_pong:   two threads pass a token back and forth (an op is a round
+//                trip)
+//   yield:       threads call std::this_thread::yield()
+//   create_join: a thread is launched and joined
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffered_channel.hpp"
+#include "../report.hpp"
+
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+using channel_type = buffered_channel< std::uint64_t >;
+
+duration_type ping_pong( std::uint64_t ops) {
+    channel_type ping{ 2 }, pong{ 2 };
+    std::thread t{ [&ping,&pong](){
+        std::uint64_t i = 0;
+        while ( channel_op_status::success == ping.pop( i) ) {
+            pong.push( i + 1);
+        }
+    }};
+    time_point_type start{ clock_type::now() };
+    for ( std::uint64_t i = 0; i < ops; ++i) {
+        ping.push( i);
+        if ( i + 1 != pong.value_pop() ) {
+            throw std::runtime_error( "ping-pong: invalid result");
+        }
+    }
+    duration_type duration = clock_type::now() - start;
+    ping.close();
+    t.join();
+    return duration;
+}
+
+duration_type yield( std::uint64_t ops, std::size_t threads) {
+    std::uint64_t per_thread = ops / threads;
+    std::vector< std::thread > ts;
+    time_point_type start{ clock_type::now() };
+    for ( std::size_t i = 0; i < threads; ++i) {
+        ts.emplace_back( [per_thread](){
+            for ( std::uint64_t j = 0; j < per_thread; ++j) {
+                std::this_thread::yield();
+            }
+        });
+    }
+    for ( std::thread & t : ts) {
+        t.join();
+    }
+    return clock_type::now() - start;
+}
+
+duration_type create_join( std::uint64_t ops) {
+    std::uint64_t sum = 0;
+    time_point_type start{ clock_type::now() };
+    for ( std::uint64_t i = 0; i < ops; ++i) {
+        std::thread{ [&sum,i](){ sum += i; } }.join();
+    }
+    duration_type duration = clock_type::now() - start;
+    if ( ops * ( ops - 1) / 2 != sum) {
+        throw std::runtime_error( "create-join: invalid result");
+    }
+    return duration;
+}
+
+int main( int argc, char * argv[]) {
+    try {
+        bench_report r{ "switch", "std::thread", argc, argv, 1000000 };
+        std::uint64_t ops = r.ops();
+        r.add( "ping_pong_cross_thread", 2, ops / 10, ping_pong( ops / 10) );
+        r.add( "yield_2_threads", 2, ops, yield( ops, 2) );
+        r.add( "yield_100_threads", 100, ops, yield( ops, 100) );
+        r.add( "create_join", 1, ops / 100, create_join( ops / 100) );
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+    return EXIT_FAILURE;
+}
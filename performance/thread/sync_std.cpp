@@ -0,0 +1,155 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// baseline of ../fiber/sync.cpp with std::thread
+//   mutex:         1..N threads increment a counter guarded by a std::mutex
+//                  (an op is a lock/unlock)
+//   condvar:       two threads take turns via a std::condition_variable
+//                  (an op is a round trip)
+//   future:        a std::promise is fulfilled and its std::future is read,
+//                  by the same thread and by another thread
+//   sleep_for:     the time std::this_thread::sleep_for() oversleeps (an
+//                  op is a sleep, ns/op is the mean overshoot)
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../report.hpp"
+
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+
+duration_type mutex( std::uint64_t ops, std::size_t threads) {
+    std::mutex mtx;
+    std::uint64_t counter = 0;
+    std::uint64_t per_thread = ops / threads;
+    auto fn = [&mtx,&counter,per_thread](){
+        for ( std::uint64_t i = 0; i < per_thread; ++i) {
+            std::unique_lock< std::mutex > lk( mtx);
+            ++counter;
+        }
+    };
+    std::vector< std::thread > ts;
+    time_point_type start{ clock_type::now() };
+    for ( std::size_t i = 1; i < threads; ++i) {
+        ts.emplace_back( fn);
+    }
+    fn();
+    for ( std::thread & t : ts) {
+        t.join();
+    }
+    duration_type duration = clock_type::now() - start;
+    if ( threads * per_thread != counter) {
+        throw std::runtime_error( "mutex: invalid result");
+    }
+    return duration;
+}
+
+duration_type condvar( std::uint64_t ops) {
+    std::mutex mtx;
+    std::condition_variable cnd;
+    std::uint64_t turn = 0;
+    // even turns are played by the caller, odd turns by the other thread
+    auto play = [&mtx,&cnd,&turn,ops]( std::uint64_t parity){
+        std::unique_lock< std::mutex > lk( mtx);
+        for (;;) {
+            cnd.wait( lk, [&turn,ops,parity](){ return 2 * ops <= turn || parity == turn % 2; });
+            if ( 2 * ops <= turn) {
+                break;
+            }
+            ++turn;
+            cnd.notify_one();
+        }
+    };
+    time_point_type start{ clock_type::now() };
+    std::thread t{ play, 1 };
+    play( 0);
+    t.join();
+    return clock_type::now() - start;
+}
+
+duration_type future_same_thread( std::uint64_t ops) {
+    std::uint64_t sum = 0;
+    time_point_type start{ clock_type::now() };
+    for ( std::uint64_t i = 0; i < ops; ++i) {
+        std::promise< std::uint64_t > p;
+        std::future< std::uint64_t > f = p.get_future();
+        p.set_value( i);
+        sum += f.get();
+    }
+    duration_type duration = clock_type::now() - start;
+    if ( ops * ( ops - 1) / 2 != sum) {
+        throw std::runtime_error( "future: invalid result");
+    }
+    return duration;
+}
+
+duration_type future_cross_thread( std::uint64_t ops) {
+    std::vector< std::promise< std::uint64_t > > promises( ops);
+    std::vector< std::future< std::uint64_t > > futures;
+    for ( std::promise< std::uint64_t > & p : promises) {
+        futures.push_back( p.get_future() );
+    }
+    std::uint64_t sum = 0;
+    time_point_type start{ clock_type::now() };
+    std::thread t{ [&promises](){
+        for ( std::uint64_t i = 0; i < promises.size(); ++i) {
+            promises[i].set_value( i);
+        }
+    }};
+    for ( std::future< std::uint64_t > & f : futures) {
+        sum += f.get();
+    }
+    duration_type duration = clock_type::now() - start;
+    t.join();
+    if ( ops * ( ops - 1) / 2 != sum) {
+        throw std::runtime_error( "future: invalid result");
+    }
+    return duration;
+}
+
+duration_type sleep_overshoot( std::uint64_t ops, std::chrono::microseconds d) {
+    duration_type overshoot = duration_type::zero();
+    for ( std::uint64_t i = 0; i < ops; ++i) {
+        time_point_type start{ clock_type::now() };
+        std::this_thread::sleep_for( d);
+        overshoot += clock_type::now() - start - d;
+    }
+    return overshoot;
+}
+
+int main( int argc, char * argv[]) {
+    try {
+        bench_report r{ "sync", "std::thread", argc, argv, 1000000 };
+        std::uint64_t ops = r.ops();
+        for ( std::size_t n : r.thread_counts() ) {
+            std::uint64_t ops_n = ops / 10 / n * n;
+            r.add( "mutex_" + std::to_string( n) + "_threads", n, ops_n, mutex( ops_n, n) );
+        }
+        r.add( "condvar_cross_thread", 2, ops / 10, condvar( ops / 10) );
+        r.add( "future_same_thread", 1, ops, future_same_thread( ops) );
+        r.add( "future_cross_thread", 2, ops / 10, future_cross_thread( ops / 10) );
+        r.add( "sleep_for_100us_overshoot", 1, 1000, sleep_overshoot( 1000, std::chrono::microseconds( 100) ) );
+        r.add( "sleep_for_1ms_overshoot", 1, 200, sleep_overshoot( 200, std::chrono::microseconds( 1000) ) );
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+    return EXIT_FAILURE;
+}
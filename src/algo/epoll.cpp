@@ -0,0 +1,250 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/algo/epoll.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <limits>
+#include <system_error>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <boost/assert.hpp>
+
+#include "boost/fiber/exceptions.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace algo {
+
+// epoll instance of this thread
+static thread_local epoll * instance_{ nullptr };
+
+epoll::fd_entry &
+epoll::entry_( int fd) {
+    BOOST_ASSERT( 0 <= fd);
+    if ( entries_.size() <= static_cast< std::size_t >( fd) ) {
+        entries_.resize( fd + 1);
+    }
+    fd_entry & e = entries_[fd];
+    if ( ! e.registered) {
+        // register for both directions, edge-triggered
+        // the registration persists till forget() is called
+        ::epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.fd = fd;
+        if ( 0 != ::epoll_ctl( epfd_, EPOLL_CTL_ADD, fd, & ev) && EEXIST != errno) {
+            throw fiber_error{
+                    std::error_code( errno, std::system_category() ),
+                    "boost fiber: epoll_ctl() failed" };
+        }
+        e.registered = true;
+    }
+    return e;
+}
+
+void
+epoll::wakeup_( int fd, std::uint32_t events) noexcept {
+    if ( entries_.size() <= static_cast< std::size_t >( fd) ) {
+        return;
+    }
+    fd_entry & e = entries_[fd];
+    // errors and hang-ups wake both directions, the following
+    // read()/write() reports the condition
+    if ( 0 != ( events & ( EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR) ) ) {
+        if ( nullptr != e.reader) {
+            context * ctx = e.reader;
+            e.reader = nullptr;
+            context::active()->set_ready( ctx);
+        } else {
+            e.readable = true;
+        }
+    }
+    if ( 0 != ( events & ( EPOLLOUT | EPOLLHUP | EPOLLERR) ) ) {
+        if ( nullptr != e.writer) {
+            context * ctx = e.writer;
+            e.writer = nullptr;
+            context::active()->set_ready( ctx);
+        } else {
+            e.writable = true;
+        }
+    }
+}
+
+epoll::epoll() :
+    epfd_{ ::epoll_create1( EPOLL_CLOEXEC) } {
+    if ( -1 == epfd_) {
+        throw fiber_error{
+                std::error_code( errno, std::system_category() ),
+                "boost fiber: epoll_create1() failed" };
+    }
+    evfd_ = ::eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if ( -1 == evfd_) {
+        int err = errno;
+        ::close( epfd_);
+        throw fiber_error{
+                std::error_code( err, std::system_category() ),
+                "boost fiber: eventfd() failed" };
+    }
+    ::epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = evfd_;
+    if ( 0 != ::epoll_ctl( epfd_, EPOLL_CTL_ADD, evfd_, & ev) ) {
+        int err = errno;
+        ::close( evfd_);
+        ::close( epfd_);
+        throw fiber_error{
+                std::error_code( err, std::system_category() ),
+                "boost fiber: epoll_ctl() failed" };
+    }
+    instance_ = this;
+}
+
+epoll::~epoll() {
+    if ( this == instance_) {
+        instance_ = nullptr;
+    }
+    ::close( evfd_);
+    ::close( epfd_);
+}
+
+void
+epoll::awakened( context * ctx) noexcept {
+    BOOST_ASSERT( nullptr != ctx);
+    BOOST_ASSERT( ! ctx->ready_is_linked() );
+    ctx->ready_link( rqueue_);
+}
+
+context *
+epoll::pick_next() noexcept {
+    context * victim{ nullptr };
+    if ( ! rqueue_.empty() ) {
+        victim = & rqueue_.front();
+        rqueue_.pop_front();
+        BOOST_ASSERT( nullptr != victim);
+        BOOST_ASSERT( ! victim->ready_is_linked() );
+    }
+    return victim;
+}
+
+bool
+epoll::has_ready_fibers() const noexcept {
+    return ! rqueue_.empty();
+}
+
+void
+epoll::suspend_until( std::chrono::steady_clock::time_point const& time_point) noexcept {
+    int timeout = -1;
+    if ( (std::chrono::steady_clock::time_point::max)() != time_point) {
+        std::chrono::steady_clock::duration d = time_point - std::chrono::steady_clock::now();
+        if ( std::chrono::steady_clock::duration::zero() < d) {
+            std::chrono::milliseconds ms = std::chrono::duration_cast< std::chrono::milliseconds >( d);
+            // round up, epoll_wait() must not return before the deadline
+            if ( ms < d) {
+                ++ms;
+            }
+            // epoll_wait() takes an int (about 24.8 days); a deadline further
+            // away is reached by suspending again after the timeout
+            timeout = static_cast< int >(
+                    ( std::min)( ms.count(),
+                                 static_cast< std::chrono::milliseconds::rep >( ( std::numeric_limits< int >::max)() ) ) );
+        } else {
+            timeout = 0;
+        }
+    }
+    int n = ::epoll_wait( epfd_, events_, static_cast< int >( max_events), timeout);
+    for ( int i = 0; i < n; ++i) {
+        if ( evfd_ == events_[i].data.fd) {
+            std::uint64_t value;
+            while ( 0 < ::read( evfd_, & value, sizeof( value) ) );
+            // re-arm notify(); acquires the context pushed by the notifier
+            notified_.exchange( false, std::memory_order_acq_rel);
+        } else {
+            wakeup_( events_[i].data.fd, events_[i].events);
+        }
+    }
+}
+
+void
+epoll::notify() noexcept {
+    // at most one eventfd write per suspend_until()
+    if ( ! notified_.exchange( true, std::memory_order_acq_rel) ) {
+        std::uint64_t value{ 1 };
+        while ( -1 == ::write( evfd_, & value, sizeof( value) ) && EINTR == errno);
+    }
+}
+
+bool
+epoll::wait( int fd, std::uint32_t events,
+             std::chrono::steady_clock::time_point const& time_point) {
+    BOOST_ASSERT( 0 != ( events & ( EPOLLIN | EPOLLOUT) ) );
+    context * active_ctx = context::active();
+    bool read = 0 != ( events & EPOLLIN);
+    fd_entry & e = entry_( fd);
+    // consume readiness reported while nobody was waiting
+    if ( read ? e.readable : e.writable) {
+        ( read ? e.readable : e.writable) = false;
+        return true;
+    }
+    context *& waiter = read ? e.reader : e.writer;
+    if ( nullptr != waiter) {
+        throw fiber_error{
+                std::make_error_code( std::errc::device_or_resource_busy),
+                "boost fiber: another fiber waits on this file descriptor" };
+    }
+    waiter = active_ctx;
+    if ( (std::chrono::steady_clock::time_point::max)() == time_point) {
+        active_ctx->suspend();
+    } else {
+        active_ctx->wait_until( time_point);
+    }
+    // entries_ might have been resized while suspended
+    fd_entry & r = entries_[fd];
+    context *& w = read ? r.reader : r.writer;
+    if ( active_ctx == w) {
+        // deadline reached
+        w = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void
+epoll::forget( int fd) noexcept {
+    if ( 0 > fd || entries_.size() <= static_cast< std::size_t >( fd) ) {
+        return;
+    }
+    fd_entry & e = entries_[fd];
+    if ( e.registered) {
+        ::epoll_ctl( epfd_, EPOLL_CTL_DEL, fd, nullptr);
+    }
+    // waiting fibers observe EBADF with their next operation
+    context * ctx = context::active();
+    if ( nullptr != e.reader) {
+        ctx->set_ready( e.reader);
+    }
+    if ( nullptr != e.writer) {
+        ctx->set_ready( e.writer);
+    }
+    e = fd_entry{};
+}
+
+epoll *
+epoll::instance() noexcept {
+    return instance_;
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
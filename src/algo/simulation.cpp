@@ -0,0 +1,102 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/algo/simulation.hpp"
+
+#include <iterator>
+
+#include <boost/assert.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace algo {
+
+simulation::simulation( std::uint64_t seed) :
+    generator_{ seed },
+    now_{ std::chrono::steady_clock::now() } {
+}
+
+void
+simulation::awakened( context * ctx) noexcept {
+    BOOST_ASSERT( nullptr != ctx);
+
+    BOOST_ASSERT( ! ctx->ready_is_linked() );
+    ctx->ready_link( rqueue_);
+    ++size_;
+}
+
+context *
+simulation::pick_next() noexcept {
+    context * victim{ nullptr };
+    if ( ! rqueue_.empty() ) {
+        // the result of std::mt19937_64 is specified by the standard,
+        // the distributions are not: reduce modulo the size, so that
+        // a seed picks the same fibers with each standard library
+        std::size_t idx = static_cast< std::size_t >( generator_() % size_);
+        // walk from the nearer end of the intrusive ready-queue
+        rqueue_t::iterator i;
+        if ( idx <= size_ / 2) {
+            i = rqueue_.begin();
+            std::advance( i, idx);
+        } else {
+            i = rqueue_.end();
+            std::advance( i, - static_cast< std::ptrdiff_t >( size_ - idx) );
+        }
+        victim = & * i;
+        rqueue_.erase( i);
+        --size_;
+        BOOST_ASSERT( nullptr != victim);
+        BOOST_ASSERT( ! victim->ready_is_linked() );
+    }
+    return victim;
+}
+
+bool
+simulation::has_ready_fibers() const noexcept {
+    return ! rqueue_.empty();
+}
+
+void
+simulation::suspend_until( std::chrono::steady_clock::time_point const& time_point) noexcept {
+    if ( (std::chrono::steady_clock::time_point::max)() == time_point) {
+        // only another thread might make a fiber ready
+        std::unique_lock< std::mutex > lk( mtx_);
+        cnd_.wait( lk, [&](){ return flag_; });
+        flag_ = false;
+    } else if ( now_ < time_point) {
+        // no fiber is ready before the next deadline: jump to it
+        now_ = time_point;
+    }
+}
+
+void
+simulation::notify() noexcept {
+    std::unique_lock< std::mutex > lk( mtx_);
+    flag_ = true;
+    lk.unlock();
+    cnd_.notify_all();
+}
+
+std::chrono::steady_clock::time_point
+simulation::now() const noexcept {
+    return now_;
+}
+
+void
+simulation::advance( std::chrono::steady_clock::duration const& d) noexcept {
+    BOOST_ASSERT( std::chrono::steady_clock::duration::zero() <= d);
+    now_ += d;
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -7,10 +7,17 @@
 
 #include "boost/fiber/algo/work_stealing.hpp"
 
+#include <algorithm>
+#include <memory>
 #include <random>
+#include <system_error>
+#include <thread>
+#include <vector>
 
 #include <boost/assert.hpp>
 
+#include "boost/fiber/exceptions.hpp"
+#include "boost/fiber/observer.hpp"
 #include "boost/fiber/type.hpp"
 
 #ifdef BOOST_HAS_ABI_HEADERS
@@ -21,19 +28,184 @@ namespace boost {
 namespace fibers {
 namespace algo {
 
-void
-work_stealing::init_( std::size_t max_idx) {
-    schedulers_.resize( max_idx + 1);
+namespace {
+
+// a slot of the group; slots are never deallocated, so that a thief
+// might access a slot while its thread leaves the group
+struct alignas(cache_alignment) slot : public detail::cache_aligned {
+    std::atomic< work_stealing * >  algo{ nullptr };
+    // number of threads accessing algo
+    std::atomic< std::size_t >      users{ 0 };
+    // algo joined at the first free index; guarded by the group's mutex
+    bool                            claimed{ false };
+};
+
+}
+
+// the threads of the group, indexed by work_stealing::index()
+// the array of slots is published lock-free and only grows, replaced
+// arrays are kept (as context_spmc_queue does)
+class work_stealing::group {
+private:
+    std::mutex                                      mtx_{};
+    std::vector< std::unique_ptr< slot > >          slots_{};
+    std::vector< std::unique_ptr< slot *[] > >      arrays_{};
+    std::atomic< slot ** >                          array_{ nullptr };
+    std::atomic< std::size_t >                      size_{ 0 };
+
+    void grow_( std::size_t size) {
+        if ( size <= slots_.size() ) {
+            return;
+        }
+        std::unique_ptr< slot *[] > a{ new slot *[size] };
+        for ( std::size_t i = 0; i < size; ++i) {
+            if ( i == slots_.size() ) {
+                slots_.emplace_back( new slot{});
+            }
+            a[i] = slots_[i].get();
+        }
+        // readers load size_ before array_
+        array_.store( a.get(), std::memory_order_release);
+        size_.store( size, std::memory_order_release);
+        arrays_.push_back( std::move( a) );
+    }
+
+public:
+    std::size_t size() const noexcept {
+        return size_.load( std::memory_order_acquire);
+    }
+
+    slot * at( std::size_t idx) const noexcept {
+        BOOST_ASSERT( idx < size() );
+        return array_.load( std::memory_order_acquire)[idx];
+    }
+
+    void set( std::size_t idx, std::size_t max_idx, work_stealing * algo) {
+        std::unique_lock< std::mutex > lk( mtx_);
+        grow_( ( std::max)( idx, max_idx) + 1);
+        slot * s = slots_[idx].get();
+        if ( s->claimed) {
+            // the thread joined at the first free index would no longer
+            // be stolen from, and its release() would not take effect
+            throw fiber_error{
+                    std::make_error_code( std::errc::device_or_resource_busy),
+                    "boost fiber: work_stealing index in use" };
+        }
+        // replaces a previous algorithm of the same index
+        s->algo.store( algo, std::memory_order_seq_cst);
+    }
+
+    std::size_t claim( work_stealing * algo) {
+        std::unique_lock< std::mutex > lk( mtx_);
+        std::size_t idx = 0;
+        for (; idx < slots_.size(); ++idx) {
+            if ( nullptr == slots_[idx]->algo.load( std::memory_order_relaxed) ) {
+                break;
+            }
+        }
+        grow_( idx + 1);
+        slots_[idx]->algo.store( algo, std::memory_order_seq_cst);
+        slots_[idx]->claimed = true;
+        return idx;
+    }
+
+    void release( std::size_t idx, work_stealing * algo) noexcept {
+        slot * s = at( idx);
+        {
+            std::unique_lock< std::mutex > lk( mtx_);
+            if ( ! s->algo.compare_exchange_strong( algo, nullptr, std::memory_order_seq_cst) ) {
+                // replaced by another algorithm
+                return;
+            }
+            s->claimed = false;
+        }
+        // wait till the thieves have left
+        while ( 0 != s->users.load( std::memory_order_seq_cst) ) {
+            std::this_thread::yield();
+        }
+    }
+
+    // calls fn with the algorithm registered at idx (if any and not self)
+    template< typename Fn >
+    bool with_peer( std::size_t idx, work_stealing * self, Fn && fn) noexcept {
+        slot * s = at( idx);
+        s->users.fetch_add( 1, std::memory_order_seq_cst);
+        work_stealing * algo = s->algo.load( std::memory_order_seq_cst);
+        bool result = false;
+        if ( nullptr != algo && self != algo) {
+            result = fn( algo);
+        }
+        s->users.fetch_sub( 1, std::memory_order_release);
+        return result;
+    }
+};
+
+namespace {
+
+std::shared_ptr< work_stealing::group > const& process_group() {
+    static std::shared_ptr< work_stealing::group > g{ work_stealing::make_group() };
+    return g;
+}
+
+}
+
+std::shared_ptr< work_stealing::group >
+work_stealing::make_group() {
+    return std::make_shared< group >();
 }
 
 work_stealing::work_stealing( std::size_t max_idx, std::size_t idx, bool suspend) :
+    work_stealing{ process_group(), max_idx, idx, suspend } {
+}
+
+work_stealing::work_stealing( bool suspend) :
+    work_stealing{ process_group(), suspend } {
+}
+
+work_stealing::work_stealing( std::shared_ptr< group > g,
+                              std::size_t max_idx, std::size_t idx, bool suspend) :
+    group_{ std::move( g) },
     idx_{ idx },
     max_idx_{ max_idx },
+    sched_{ context::active()->get_scheduler() },
     suspend_{ suspend } {
-    static std::once_flag flag;
-    std::call_once( flag, & work_stealing::init_, max_idx_);
-    schedulers_[idx_] = this;
+    BOOST_ASSERT( group_);
+    BOOST_ASSERT( idx_ <= max_idx_);
+    group_->set( idx_, max_idx_, this);
+}
 
+work_stealing::work_stealing( std::shared_ptr< group > g, bool suspend) :
+    group_{ std::move( g) },
+    idx_{ 0 },
+    max_idx_{ 0 },
+    sched_{ context::active()->get_scheduler() },
+    suspend_{ suspend } {
+    BOOST_ASSERT( group_);
+    idx_ = group_->claim( this);
+}
+
+work_stealing::~work_stealing() {
+    if ( ! retiring_) {
+        group_->release( idx_, this);
+    }
+}
+
+bool
+work_stealing::post_to_peer_( context * ctx) noexcept {
+    std::size_t size = group_->size();
+    for ( std::size_t i = 0; i < size; ++i) {
+        std::size_t idx = ( peer_idx_ + i) % size;
+        if ( group_->with_peer( idx, this, [ctx]( work_stealing * peer){
+                    // attached by the peer's dispatcher
+                    peer->sched_->remote_migrate( ctx);
+                    return true; }) ) {
+            peer_idx_ = idx + 1;
+            // taken from the ready-queue of this scheduler
+            detail::stat_inc_shared( sched_->counters(), & detail::scheduler_counters::stolen);
+            return true;
+        }
+    }
+    return false;
 }
 
 void
@@ -49,20 +221,40 @@ work_stealing::awakened( context * ctx) noexcept {
 context *
 work_stealing::pick_next() noexcept {
     context * ctx = rqueue_.pop();
+    if ( retiring_) {
+        // pass ready fibers to the group, run them only if the
+        // group is empty
+        while ( nullptr != ctx && post_to_peer_( ctx) ) {
+            ctx = rqueue_.pop();
+        }
+    }
     if ( nullptr != ctx) {
         context::active()->attach( ctx);
     } else if ( ! lqueue_.empty() ) {
         ctx = & lqueue_.front();
         lqueue_.pop_front();
-    } else if ( nullptr == ctx) {
-        static thread_local std::minstd_rand generator;
-        std::size_t idx = 0;
-        do {
-            idx = std::uniform_int_distribution< std::size_t >{ 0, max_idx_ }( generator);
-        } while ( idx == idx_);
-        ctx = schedulers_[idx]->steal();
-        if ( nullptr != ctx) {
-            context::active()->attach( ctx);
+    } else if ( ! retiring_) {
+        std::size_t size = group_->size();
+        // no victim if this is the only thread
+        if ( 1 < size) {
+            static thread_local std::minstd_rand generator;
+            std::size_t idx = 0;
+            do {
+                idx = std::uniform_int_distribution< std::size_t >{ 0, size - 1 }( generator);
+            } while ( idx == idx_);
+            group_->with_peer( idx, this, [&ctx]( work_stealing * victim){
+                ctx = victim->steal();
+                if ( nullptr != ctx) {
+                    detail::stat_inc_shared( victim->sched_->counters(), & detail::scheduler_counters::stolen);
+                }
+                return true; });
+            if ( nullptr != ctx) {
+                context::active()->attach( ctx);
+                detail::stat_inc( sched_->counters(), & detail::scheduler_counters::steals);
+                detail::observe( event_type::steal, ctx, context::active() );
+            } else {
+                detail::stat_inc( sched_->counters(), & detail::scheduler_counters::failed_steals);
+            }
         }
     }
     return ctx;
@@ -71,6 +263,8 @@ work_stealing::pick_next() noexcept {
 void
 work_stealing::suspend_until( std::chrono::steady_clock::time_point const& time_point) noexcept {
     if ( suspend_) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        idle_since_.store( start.time_since_epoch().count(), std::memory_order_release);
         if ( (std::chrono::steady_clock::time_point::max)() == time_point) {
             std::unique_lock< std::mutex > lk( mtx_);
             cnd_.wait( lk, [this](){ return flag_; });
@@ -80,7 +274,26 @@ work_stealing::suspend_until( std::chrono::steady_clock::time_point const& time_
             cnd_.wait_until( lk, time_point, [this](){ return flag_; });
             flag_ = false;
         }
+        // single writer
+        idle_ns_.store( idle_ns_.load( std::memory_order_relaxed) +
+                            std::chrono::duration_cast< std::chrono::nanoseconds >(
+                                std::chrono::steady_clock::now() - start).count(),
+                        std::memory_order_release);
+        idle_since_.store( 0, std::memory_order_release);
+    }
+}
+
+std::chrono::nanoseconds
+work_stealing::idle_time() const noexcept {
+    // approximate: a wait ending concurrently might be counted twice
+    std::chrono::steady_clock::rep since = idle_since_.load( std::memory_order_acquire);
+    std::chrono::nanoseconds idle{ idle_ns_.load( std::memory_order_acquire) };
+    if ( 0 != since) {
+        idle += std::chrono::duration_cast< std::chrono::nanoseconds >(
+                    std::chrono::steady_clock::now() -
+                    std::chrono::steady_clock::time_point{ std::chrono::steady_clock::duration{ since } });
     }
+    return idle;
 }
 
 void
@@ -93,7 +306,16 @@ work_stealing::notify() noexcept {
     }
 }
 
-std::vector< work_stealing * > work_stealing::schedulers_{};
+void
+work_stealing::retire() noexcept {
+    BOOST_ASSERT( sched_ == context::active()->get_scheduler() );
+    if ( retiring_) {
+        return;
+    }
+    // nobody steals from or posts to this thread after release()
+    group_->release( idx_, this);
+    retiring_ = true;
+}
 
 }}}
 
@@ -0,0 +1,194 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/blocking.hpp"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+#include "boost/fiber/exceptions.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+namespace {
+
+// elastic thread pool executing blocking_task
+// a thread is spawned if the queued tasks outnumber the idle threads and
+// the threads not yet started (up to max_threads_), idle threads terminate
+// after idle_timeout_
+// the threads share ownership of the pool, so that the pool outlives
+// the static holder destroyed at process exit
+class blocking_pool : public std::enable_shared_from_this< blocking_pool > {
+private:
+    std::mutex                              mtx_{};
+    std::condition_variable                 cnd_{};
+    blocking_task                       *   head_{ nullptr };
+    blocking_task                       *   tail_{ nullptr };
+    std::size_t                             threads_{ 0 };
+    // a woken thread counts as idle until it holds the mutex again and
+    // dequeues a task: it might not have run yet when the next task is
+    // submitted
+    std::size_t                             idle_{ 0 };
+    // threads spawned, not yet looking for a task
+    std::size_t                             starting_{ 0 };
+    // tasks queued, not yet dequeued by a thread
+    std::size_t                             pending_{ 0 };
+    std::size_t                             max_threads_{ 64 };
+    std::chrono::steady_clock::duration     idle_timeout_{ std::chrono::seconds( 10) };
+    bool                                    shutdown_{ false };
+
+    blocking_task * pop_() noexcept {
+        blocking_task * task = head_;
+        if ( nullptr != task) {
+            head_ = task->nxt_;
+            if ( nullptr == head_) {
+                tail_ = nullptr;
+            }
+            task->nxt_ = nullptr;
+            --pending_;
+        }
+        return task;
+    }
+
+    static void worker_( std::shared_ptr< blocking_pool > self) noexcept {
+        std::unique_lock< std::mutex > lk( self->mtx_);
+        --self->starting_;
+        for (;;) {
+            blocking_task * task = self->pop_();
+            if ( nullptr != task) {
+                lk.unlock();
+                task->run();
+                // task might be gone after complete()
+                task->complete();
+                lk.lock();
+                continue;
+            }
+            if ( self->shutdown_) {
+                break;
+            }
+            ++self->idle_;
+            bool timeout = std::cv_status::timeout == self->cnd_.wait_for( lk, self->idle_timeout_);
+            --self->idle_;
+            if ( timeout && nullptr == self->head_) {
+                break;
+            }
+        }
+        --self->threads_;
+    }
+
+public:
+    void submit( blocking_task * task) {
+        std::unique_lock< std::mutex > lk( mtx_);
+        if ( pending_ + 1 > idle_ + starting_ && threads_ < max_threads_) {
+            // might throw std::system_error, task is not enqueued then
+            std::thread( & blocking_pool::worker_, shared_from_this() ).detach();
+            ++threads_;
+            ++starting_;
+        }
+        if ( nullptr == tail_) {
+            head_ = tail_ = task;
+        } else {
+            tail_->nxt_ = task;
+            tail_ = task;
+        }
+        ++pending_;
+        if ( 0 < idle_) {
+            lk.unlock();
+            cnd_.notify_one();
+        }
+    }
+
+    void max_threads( std::size_t max_threads) {
+        if ( 0 == max_threads) {
+            throw fiber_error{
+                    std::make_error_code( std::errc::invalid_argument),
+                    "boost fiber: offload pool requires at least one thread" };
+        }
+        std::unique_lock< std::mutex > lk( mtx_);
+        max_threads_ = max_threads;
+    }
+
+    void idle_timeout( std::chrono::steady_clock::duration const& idle_timeout) {
+        std::unique_lock< std::mutex > lk( mtx_);
+        idle_timeout_ = idle_timeout;
+    }
+
+    void shutdown() noexcept {
+        std::unique_lock< std::mutex > lk( mtx_);
+        shutdown_ = true;
+        lk.unlock();
+        cnd_.notify_all();
+    }
+};
+
+struct blocking_pool_holder {
+    std::shared_ptr< blocking_pool >    pool{ std::make_shared< blocking_pool >() };
+
+    ~blocking_pool_holder() {
+        pool->shutdown();
+    }
+};
+
+blocking_pool & get_pool() {
+    static blocking_pool_holder holder;
+    return * holder.pool;
+}
+
+}
+
+void
+blocking_task::complete() noexcept {
+    // copy ctx_: the task is destroyed as soon as the fiber resumes
+    context * ctx = ctx_;
+    if ( state_waiting == state_.exchange( state_complete, std::memory_order_acq_rel) ) {
+        // the fiber has been suspended (or is being suspended) in its own
+        // thread, which drains the remote ready-queue only after the switch
+        ctx->get_scheduler()->set_remote_ready( ctx);
+    }
+}
+
+void
+blocking_task::wait() noexcept {
+    state_t expected = state_init;
+    if ( state_.compare_exchange_strong( expected, state_waiting,
+                                         std::memory_order_acq_rel,
+                                         std::memory_order_acquire) ) {
+        ctx_->suspend();
+    }
+    BOOST_ASSERT( state_complete == state_.load( std::memory_order_acquire) );
+}
+
+void
+blocking_submit( blocking_task * task) {
+    get_pool().submit( task);
+}
+
+}
+
+void
+set_blocking_max_threads( std::size_t max_threads) {
+    detail::get_pool().max_threads( max_threads);
+}
+
+void
+set_blocking_idle_timeout( std::chrono::steady_clock::duration const& idle_timeout) {
+    detail::get_pool().idle_timeout( idle_timeout);
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,231 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/contention_profiler.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <tuple>
+#include <unordered_map>
+
+#include "boost/fiber/detail/cache_aligned.hpp"
+#include "boost/fiber/detail/spinlock.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+namespace {
+
+// primitive and call site
+struct site {
+    void const      *   object;
+    void const      *   caller;
+    block_reason        reason;
+
+    bool operator<( site const& other) const noexcept {
+        return std::tie( object, caller, reason) < std::tie( other.object, other.caller, other.reason);
+    }
+};
+
+struct waits {
+    std::size_t                 count{ 0 };
+    std::chrono::nanoseconds    total{ 0 };
+    std::chrono::nanoseconds    max{ 0 };
+
+    void add( std::chrono::nanoseconds d) noexcept {
+        ++count;
+        total += d;
+        max = ( std::max)( max, d);
+    }
+
+    void add( waits const& other) noexcept {
+        count += other.count;
+        total += other.total;
+        max = ( std::max)( max, other.max);
+    }
+};
+
+struct pending {
+    site                                        where;
+    std::chrono::steady_clock::time_point       since;
+};
+
+// a fiber might block in one thread and be resumed in another one (after
+// it has been stolen); the fibers are spread over the shards to reduce the
+// contention of the profiler itself
+constexpr std::size_t shards = 31;
+
+}
+
+struct contention_profiler::shard : public detail::cache_aligned {
+    detail::spinlock                                    splk{};
+    // fibers blocked
+    std::unordered_map< context::id, pending >          blocked{};
+    std::map< site, waits >                             sites{};
+};
+
+contention_profiler::shard &
+contention_profiler::shard_of( context::id id) noexcept {
+    // contexts are aligned
+    return shards_[( std::hash< context::id >{}( id) >> 4) % shards];
+}
+
+contention_profiler::contention_profiler() :
+    observer{ true },
+    shards_{ new shard[shards] } {
+}
+
+contention_profiler::~contention_profiler() {
+    stop();
+}
+
+void
+contention_profiler::start() noexcept {
+    if ( ! running_) {
+        running_ = true;
+        previous_ = set_observer( this);
+    }
+}
+
+void
+contention_profiler::stop() noexcept {
+    if ( running_) {
+        set_observer( previous_);
+        running_ = false;
+    }
+}
+
+void
+contention_profiler::on_event( event const& e) noexcept {
+    switch ( e.type) {
+    case event_type::block: {
+        if ( block_reason::none == e.reason || block_reason::sleep == e.reason) {
+            return;
+        }
+        shard & s = shard_of( e.id);
+        detail::spinlock_lock lk( s.splk);
+        try {
+            s.blocked[e.id] = pending{ site{ e.object, e.caller, e.reason }, e.timestamp };
+        } catch (...) {
+        }
+        break;
+    }
+    case event_type::resume: {
+        shard & s = shard_of( e.id);
+        detail::spinlock_lock lk( s.splk);
+        std::unordered_map< context::id, pending >::iterator i = s.blocked.find( e.id);
+        if ( s.blocked.end() == i) {
+            return;
+        }
+        try {
+            s.sites[i->second.where].add(
+                std::chrono::duration_cast< std::chrono::nanoseconds >( e.timestamp - i->second.since) );
+        } catch (...) {
+        }
+        s.blocked.erase( i);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void
+contention_profiler::name( void const * object, std::string const& name) {
+    std::unique_lock< std::mutex > lk( mtx_);
+    names_[object] = name;
+}
+
+void
+contention_profiler::reset() noexcept {
+    for ( std::size_t i = 0; i < shards; ++i) {
+        detail::spinlock_lock lk( shards_[i].splk);
+        shards_[i].blocked.clear();
+        shards_[i].sites.clear();
+    }
+}
+
+std::vector< contention_record >
+contention_profiler::top( std::size_t n) const {
+    std::map< site, waits > merged;
+    for ( std::size_t i = 0; i < shards; ++i) {
+        detail::spinlock_lock lk( shards_[i].splk);
+        for ( std::map< site, waits >::value_type const& v : shards_[i].sites) {
+            merged[v.first].add( v.second);
+        }
+    }
+    std::vector< contention_record > records;
+    records.reserve( merged.size() );
+    {
+        std::unique_lock< std::mutex > lk( mtx_);
+        for ( std::map< site, waits >::value_type const& v : merged) {
+            contention_record r;
+            r.object = v.first.object;
+            std::map< void const*, std::string >::const_iterator i = names_.find( v.first.object);
+            if ( names_.end() != i) {
+                r.name = i->second;
+            }
+            r.caller = v.first.caller;
+            r.reason = v.first.reason;
+            r.count = v.second.count;
+            r.total = v.second.total;
+            r.max = v.second.max;
+            records.push_back( r);
+        }
+    }
+    std::sort( records.begin(), records.end(),
+               []( contention_record const& l, contention_record const& r){
+                   return l.total > r.total; });
+    if ( n < records.size() ) {
+        records.resize( n);
+    }
+    return records;
+}
+
+void
+contention_profiler::report( std::ostream & os, std::size_t n) const {
+    std::vector< contention_record > records = top( n);
+    std::ios_base::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+    os << std::right
+       << std::setw( 14) << "total[us]"
+       << std::setw( 10) << "count"
+       << std::setw( 12) << "max[us]"
+       << "  " << std::left << std::setw( 20) << "reason"
+       << std::setw( 20) << "call site"
+       << "object\n";
+    os << std::fixed << std::setprecision( 1);
+    for ( contention_record const& r : records) {
+        std::ostringstream caller;
+        caller << r.caller;
+        os << std::right
+           << std::setw( 14) << r.total.count() / 1000.
+           << std::setw( 10) << r.count
+           << std::setw( 12) << r.max.count() / 1000.
+           << "  " << std::left << std::setw( 20) << detail::reason_name( r.reason)
+           << std::setw( 20) << caller.str()
+           << r.object;
+        if ( ! r.name.empty() ) {
+            os << " (" << r.name << ")";
+        }
+        os << '\n';
+    }
+    os.flags( flags);
+    os.precision( precision);
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
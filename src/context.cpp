@@ -6,11 +6,14 @@
 
 #include "boost/fiber/context.hpp"
 
+#include <cstdint>
 #include <cstdlib>
 #include <mutex>
 #include <new>
 
+#include "boost/fiber/detail/tsc.hpp"
 #include "boost/fiber/exceptions.hpp"
+#include "boost/fiber/observer.hpp"
 #include "boost/fiber/scheduler.hpp"
 
 #ifdef BOOST_HAS_ABI_HEADERS
@@ -20,6 +23,12 @@
 namespace boost {
 namespace fibers {
 
+#if defined(BOOST_FIBERS_STATS) && ! defined(BOOST_FIBERS_NO_ATOMICS)
+// the time-stamp counter is calibrated against the steady_clock since the
+// library has been loaded
+static detail::tsc_sample const tsc_origin{};
+#endif
+
 static intrusive_ptr< context > make_dispatcher_context( scheduler * sched) {
     BOOST_ASSERT( nullptr != sched);
     default_stack salloc; // use default satck-size
@@ -190,6 +199,10 @@ context::context( main_context_t) noexcept :
 #else
     c_{} {
 #endif
+#if defined(BOOST_FIBERS_STATS) && ! defined(BOOST_FIBERS_NO_ATOMICS)
+    // the thread is running the main context
+    run_since_.store( detail::tsc(), std::memory_order_relaxed);
+#endif
 }
 
 // dispatcher fiber context
@@ -247,12 +260,37 @@ context::get_id() const noexcept {
     return id( const_cast< context * >( this) );
 }
 
+fiber_stats
+context::stats() const noexcept {
+    fiber_stats s;
+#if defined(BOOST_FIBERS_STATS) && ! defined(BOOST_FIBERS_NO_ATOMICS)
+    s.enabled = true;
+    detail::tsc_sample now{};
+    // approximate if the fiber is suspended or resumed concurrently
+    std::uint64_t ticks = cpu_ticks_.load( std::memory_order_relaxed);
+    std::uint64_t since = run_since_.load( std::memory_order_relaxed);
+    if ( 0 != since && since < now.ticks) {
+        ticks += now.ticks - since;
+    }
+    s.cpu_time = std::chrono::nanoseconds{
+        static_cast< std::chrono::nanoseconds::rep >( ticks / detail::tsc_rate( tsc_origin, now) ) };
+    s.switches = switches_.load( std::memory_order_relaxed);
+    s.ready_time = std::chrono::nanoseconds{ ready_ns_.load( std::memory_order_relaxed) };
+#endif
+    return s;
+}
+
 void
 context::resume() noexcept {
     context * prev = this;
     // context_initializer::active_ will point to `this`
     // prev will point to previous active context
     std::swap( context_initializer::active_, prev);
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    get_scheduler()->resumed( this, prev);
+#endif
+    detail::observe( event_type::resume, this, prev);
+    prev->saved_sp_ = BOOST_FIBERS_FRAME;
 #if (BOOST_EXECUTION_CONTEXT==1)
     detail::data_t d{};
 #else
@@ -267,6 +305,11 @@ context::resume( detail::spinlock_lock & lk) noexcept {
     // context_initializer::active_ will point to `this`
     // prev will point to previous active context
     std::swap( context_initializer::active_, prev);
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    get_scheduler()->resumed( this, prev);
+#endif
+    detail::observe( event_type::resume, this, prev);
+    prev->saved_sp_ = BOOST_FIBERS_FRAME;
 #if (BOOST_EXECUTION_CONTEXT==1)
     detail::data_t d{ & lk };
 #else
@@ -281,6 +324,11 @@ context::resume( context * ready_ctx) noexcept {
     // context_initializer::active_ will point to `this`
     // prev will point to previous active context
     std::swap( context_initializer::active_, prev);
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    get_scheduler()->resumed( this, prev);
+#endif
+    detail::observe( event_type::resume, this, prev);
+    prev->saved_sp_ = BOOST_FIBERS_FRAME;
 #if (BOOST_EXECUTION_CONTEXT==1)
     detail::data_t d{ ready_ctx };
 #else
@@ -300,7 +348,7 @@ context::suspend( detail::spinlock_lock & lk) noexcept {
 }
 
 void
-context::join() {
+context::join( void const * caller) {
     // get active context
     context * active_ctx = context::active();
     // protect for concurrent access
@@ -311,9 +359,12 @@ context::join() {
         // of the context which has to be joined by
         // the active context
         active_ctx->wait_link( wait_queue_);
-        lk.unlock();
+        detail::observe( event_type::block, active_ctx, active_ctx, block_reason::join, this, caller);
         // suspend active context
-        get_scheduler()->suspend();
+        // the lock is released after the switch, otherwise a context
+        // terminating in another thread might resume active_ctx
+        // before its continuation has been stored
+        active_ctx->suspend( lk);
         // remove from wait-queue
         active_ctx->wait_unlink();
         // active context resumed
@@ -358,6 +409,11 @@ context::suspend_with_cc() noexcept {
     // context_initializer::active_ will point to `this`
     // prev will point to previous active context
     std::swap( context_initializer::active_, prev);
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    get_scheduler()->resumed( this, prev);
+#endif
+    detail::observe( event_type::resume, this, prev);
+    prev->saved_sp_ = BOOST_FIBERS_FRAME;
     detail::data_t d{ prev };
     // context switch
     return c_( & d);
@@ -392,6 +448,7 @@ bool
 context::wait_until( std::chrono::steady_clock::time_point const& tp) noexcept {
     BOOST_ASSERT( nullptr != get_scheduler() );
     BOOST_ASSERT( this == context_initializer::active_);
+    detail::observe( event_type::block, this, this, block_reason::sleep);
     return get_scheduler()->wait_until( this, tp);
 }
 
@@ -415,6 +472,11 @@ context::set_ready( context * ctx) noexcept {
     //        (other scheduler assigned)
     if ( scheduler_ == ctx->get_scheduler() ) {
         // local
+        detail::observe( event_type::ready, ctx, this);
+#if defined(BOOST_FIBERS_STATS)
+        ctx->ready_since_ = std::chrono::steady_clock::now();
+        ctx->remote_ready_ = false;
+#endif
         get_scheduler()->set_ready( ctx);
     } else {
         // remote
@@ -422,6 +484,7 @@ context::set_ready( context * ctx) noexcept {
     }
 #else
     BOOST_ASSERT( get_scheduler() == ctx->get_scheduler() );
+    detail::observe( event_type::ready, ctx, this);
     get_scheduler()->set_ready( ctx);
 #endif
 }
@@ -0,0 +1,257 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/elastic_pool.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <system_error>
+
+#include "boost/fiber/algo/work_stealing.hpp"
+#include "boost/fiber/exceptions.hpp"
+#include "boost/fiber/future/promise.hpp"
+#include "boost/fiber/operations.hpp"
+#include "boost/fiber/scheduler.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+struct elastic_pool::worker {
+    std::shared_ptr< algo::work_stealing::group >   group{};
+    algo::work_stealing                 *   algo{ nullptr };
+    scheduler                           *   sched{ nullptr };
+    promise< void >                         retire{};
+    future< void >                          retired{ retire.get_future() };
+    std::atomic< bool >                     done{ false };
+    // idle time at the last sample
+    std::chrono::nanoseconds                idle{ 0 };
+    std::mutex                              mtx{};
+    std::condition_variable                 cnd{};
+    bool                                    started{ false };
+    std::thread                             thread{};
+};
+
+namespace {
+
+// a thread is added if at least as many fibers as threads are ready
+// while the threads are idle for less than this ratio of the time
+constexpr double busy_ratio = 0.1;
+// a thread is retired if no fiber is ready and the threads are idle for
+// more than this ratio of the time in idle_samples consecutive samples
+constexpr double idle_ratio = 0.5;
+constexpr std::size_t idle_samples = 10;
+
+}
+
+void
+elastic_pool::run_( worker * w) noexcept {
+    scheduler * sched = context::active()->get_scheduler();
+    algo::work_stealing * algo = new algo::work_stealing{ w->group, true };
+    sched->set_algo( std::unique_ptr< algo::algorithm >{ algo } );
+    {
+        std::unique_lock< std::mutex > lk( w->mtx);
+        w->sched = sched;
+        w->algo = algo;
+        w->started = true;
+    }
+    w->cnd.notify_all();
+    w->retired.wait();
+    algo->retire();
+    // the ready fibers are passed to the remaining threads, fibers waiting
+    // or sleeping in this thread as soon as they become ready
+    // sleep at least once: fibers posted before retire() are attached by
+    // the dispatcher; the pinned runner of scheduler::defer() does not
+    // keep the thread, it runs the functions still deferred and terminates
+    // when the scheduler is destroyed
+    do {
+        this_fiber::sleep_for( std::chrono::milliseconds( 1) );
+    } while ( sched->has_user_fibers() );
+    w->done = true;
+}
+
+void
+elastic_pool::run_controller_() noexcept {
+    std::unique_lock< std::mutex > lk( mtx_);
+    while ( ! shutdown_) {
+        cnd_.wait_for( lk, interval_);
+        if ( shutdown_) {
+            break;
+        }
+        join_retired_( lk);
+        adapt_( lk);
+    }
+}
+
+void
+elastic_pool::adapt_( std::unique_lock< std::mutex > & lk) {
+    std::size_t ready = 0;
+    std::chrono::nanoseconds idle{ 0 };
+    for ( std::unique_ptr< worker > & w : active_) {
+        ready += w->algo->ready_count();
+        std::chrono::nanoseconds total = w->algo->idle_time();
+        idle += total - w->idle;
+        w->idle = total;
+    }
+    double ratio = static_cast< double >( idle.count() ) /
+        ( static_cast< double >(
+            std::chrono::duration_cast< std::chrono::nanoseconds >( interval_).count() ) *
+          active_.size() );
+    if ( active_.size() <= ready && busy_ratio > ratio) {
+        idle_samples_ = 0;
+        if ( active_.size() < max_threads_) {
+            try {
+                add_( lk);
+            } catch ( std::system_error const&) {
+                // retried at the next sample
+            }
+        }
+    } else if ( 0 == ready && idle_ratio < ratio) {
+        if ( idle_samples <= ++idle_samples_ && min_threads_ < active_.size() ) {
+            retire_( lk);
+            idle_samples_ = 0;
+        }
+    } else {
+        idle_samples_ = 0;
+    }
+}
+
+void
+elastic_pool::add_( std::unique_lock< std::mutex > &) {
+    std::unique_ptr< worker > w{ new worker{} };
+    w->group = group_;
+    w->thread = std::thread{ & elastic_pool::run_, w.get() };
+    {
+        std::unique_lock< std::mutex > lk( w->mtx);
+        w->cnd.wait( lk, [&w](){ return w->started; });
+    }
+    w->idle = w->algo->idle_time();
+    active_.push_back( std::move( w) );
+}
+
+void
+elastic_pool::retire_( std::unique_lock< std::mutex > &) noexcept {
+    BOOST_ASSERT( ! active_.empty() );
+    // the most recently added thread
+    std::unique_ptr< worker > w = std::move( active_.back() );
+    active_.pop_back();
+    w->retire.set_value();
+    retiring_.push_back( std::move( w) );
+}
+
+void
+elastic_pool::join_retired_( std::unique_lock< std::mutex > &) noexcept {
+    for ( std::vector< std::unique_ptr< worker > >::iterator i = retiring_.begin(); i != retiring_.end();) {
+        if ( ( * i)->done) {
+            // the thread only destroys its scheduler
+            ( * i)->thread.join();
+            i = retiring_.erase( i);
+        } else {
+            ++i;
+        }
+    }
+}
+
+void
+elastic_pool::post_( context * ctx) noexcept {
+    std::unique_lock< std::mutex > lk( mtx_);
+    if ( active_.empty() ) {
+        // the pool is being destroyed
+        lk.unlock();
+        context::active()->get_scheduler()->remote_post( ctx, ctx);
+        return;
+    }
+    // posted under the lock: a thread retired afterwards dispatches
+    // the fiber before it terminates
+    active_[next_++ % active_.size()]->sched->remote_post( ctx, ctx);
+}
+
+elastic_pool::elastic_pool( std::size_t min_threads, std::size_t max_threads,
+                            std::chrono::steady_clock::duration const& interval) :
+    min_threads_{ min_threads },
+    max_threads_{ max_threads },
+    interval_{ interval } {
+    if ( 0 == min_threads_ || max_threads_ < min_threads_) {
+        throw fiber_error{
+                std::make_error_code( std::errc::invalid_argument),
+                "boost fiber: elastic pool requires 0 < min_threads <= max_threads" };
+    }
+    std::unique_lock< std::mutex > lk( mtx_);
+    try {
+        for ( std::size_t i = 0; i < min_threads_; ++i) {
+            add_( lk);
+        }
+        if ( std::chrono::steady_clock::duration::zero() < interval_) {
+            controller_ = std::thread{ & elastic_pool::run_controller_, this };
+        }
+    } catch (...) {
+        while ( ! active_.empty() ) {
+            retire_( lk);
+        }
+        for ( std::unique_ptr< worker > & w : retiring_) {
+            w->thread.join();
+        }
+        throw;
+    }
+}
+
+elastic_pool::~elastic_pool() {
+    std::unique_lock< std::mutex > lk( mtx_);
+    shutdown_ = true;
+    lk.unlock();
+    cnd_.notify_all();
+    if ( controller_.joinable() ) {
+        controller_.join();
+    }
+    lk.lock();
+    while ( ! active_.empty() ) {
+        retire_( lk);
+    }
+    std::vector< std::unique_ptr< worker > > workers;
+    workers.swap( retiring_);
+    // fibers of the pool might call post()
+    lk.unlock();
+    for ( std::unique_ptr< worker > & w : workers) {
+        w->thread.join();
+    }
+}
+
+std::size_t
+elastic_pool::size() const noexcept {
+    std::unique_lock< std::mutex > lk( mtx_);
+    return active_.size();
+}
+
+bool
+elastic_pool::grow() {
+    std::unique_lock< std::mutex > lk( mtx_);
+    join_retired_( lk);
+    if ( max_threads_ <= active_.size() ) {
+        return false;
+    }
+    add_( lk);
+    return true;
+}
+
+bool
+elastic_pool::shrink() noexcept {
+    std::unique_lock< std::mutex > lk( mtx_);
+    join_retired_( lk);
+    if ( active_.size() <= min_threads_) {
+        return false;
+    }
+    retire_( lk);
+    return true;
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
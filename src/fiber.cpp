@@ -11,6 +11,7 @@
 #include <boost/assert.hpp>
 
 #include "boost/fiber/exceptions.hpp"
+#include "boost/fiber/observer.hpp"
 #include "boost/fiber/scheduler.hpp"
 
 #ifdef BOOST_HAS_ABI_HEADERS
@@ -23,7 +24,14 @@ namespace fibers {
 void
 fiber::start_() noexcept {
     context * ctx = context::active();
+    // the constructor of fiber, or the code launching the fiber if the
+    // constructor has been inlined
+    impl_->spawn_site_ = BOOST_FIBERS_CALLER;
     ctx->attach( impl_.get() );
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    detail::stat_inc( ctx->get_scheduler()->counters(), & detail::scheduler_counters::fibers_created);
+#endif
+    detail::observe( event_type::spawn, impl_.get(), ctx);
     switch ( impl_->get_policy() ) {
     case launch::post:
         // push new fiber to ready-queue
@@ -52,7 +60,7 @@ fiber::join() {
                                     "boost fiber: fiber not joinable");
     }
 
-    impl_->join();
+    impl_->join( BOOST_FIBERS_CALLER);
     impl_.reset();
 }
 
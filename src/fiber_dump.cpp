@@ -0,0 +1,266 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/fiber_dump.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+
+#include "boost/fiber/detail/deferred.hpp"
+#include "boost/fiber/observer.hpp"
+#include "boost/fiber/scheduler.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+namespace {
+
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+// run by the deferred runner of the scheduler; shared with the thread
+// taking the dump, which might give up waiting
+struct dump_request : public detail::deferred {
+    std::shared_ptr< dump_request >     self{};
+    scheduler                       *   sched;
+    bool                                backtraces;
+    std::mutex                          mtx{};
+    std::condition_variable             cnd{};
+    bool                                done{ false };
+    std::vector< fiber_info >           fibers{};
+
+    dump_request( scheduler * sched_, bool backtraces_) noexcept :
+        detail::deferred{ & dump_request::run },
+        sched{ sched_ },
+        backtraces{ backtraces_ } {
+    }
+
+    static void run( detail::deferred * d) noexcept {
+        dump_request * r = static_cast< dump_request * >( d);
+        std::shared_ptr< dump_request > keep = std::move( r->self);
+        std::vector< fiber_info > fibers;
+        try {
+            // the runner is not reported
+            r->sched->dump( fibers, r->backtraces, context::active() );
+        } catch (...) {
+        }
+        std::unique_lock< std::mutex > lk( r->mtx);
+        r->fibers = std::move( fibers);
+        r->done = true;
+        lk.unlock();
+        r->cnd.notify_all();
+    }
+};
+#endif
+
+char const* state_name( fiber_state state) noexcept {
+    switch ( state) {
+    case fiber_state::running:
+        return "running";
+    case fiber_state::ready:
+        return "ready";
+    case fiber_state::blocked:
+        return "blocked";
+    case fiber_state::sleeping:
+        return "sleeping";
+    default:
+        return "unknown";
+    }
+}
+
+}
+
+namespace detail {
+
+std::size_t
+walk_frames( void * fp, void * bottom, void * top, void ** frames, std::size_t max) noexcept {
+    std::size_t n = 0;
+#if ( defined(BOOST_GCC) || defined(BOOST_CLANG) ) && \
+    ( defined(__x86_64__) || defined(__i386__) || defined(__aarch64__) )
+    // follows the chain of frame pointers [fp] = caller's fp, [fp + 1] =
+    // return address; only addresses inside the stack are read
+    std::uintptr_t lo = reinterpret_cast< std::uintptr_t >( bottom);
+    std::uintptr_t hi = reinterpret_cast< std::uintptr_t >( top);
+    std::uintptr_t p = reinterpret_cast< std::uintptr_t >( fp);
+    while ( n < max) {
+        if ( p < lo || hi < p + 2 * sizeof( void *) || 0 != p % sizeof( void *) ) {
+            break;
+        }
+        void ** frame = reinterpret_cast< void ** >( p);
+        if ( nullptr == frame[1]) {
+            break;
+        }
+        frames[n++] = frame[1];
+        std::uintptr_t next = reinterpret_cast< std::uintptr_t >( frame[0]);
+        // the stack grows downwards
+        if ( next <= p) {
+            break;
+        }
+        p = next;
+    }
+#else
+    ( void)fp;
+    ( void)bottom;
+    ( void)top;
+    ( void)frames;
+    ( void)max;
+#endif
+    return n;
+}
+
+fiber_info
+describe( context * ctx, bool active, bool backtrace) {
+    fiber_info info;
+    info.id = ctx->get_id();
+    info.main = ctx->is_context( type::main_context);
+    info.stats = ctx->stats();
+    if ( active) {
+        info.state = fiber_state::running;
+    } else if ( ctx->wait_is_linked() ||
+                ( block_reason::none != ctx->wait_reason_ && block_reason::sleep != ctx->wait_reason_) ) {
+        info.state = fiber_state::blocked;
+        info.reason = ctx->wait_reason_;
+        info.object = ctx->wait_object_;
+    } else if ( ctx->sleep_is_linked() ) {
+        info.state = fiber_state::sleeping;
+        info.reason = block_reason::sleep;
+    }
+    if ( ctx->sleep_is_linked() ) {
+        info.deadline = ctx->tp_;
+    }
+    if ( nullptr != ctx->stack_base_) {
+        char * top = static_cast< char * >( ctx->stack_base_);
+        char * bottom = top - ctx->stack_size_;
+        char * sp = static_cast< char * >( active ? BOOST_FIBERS_FRAME : ctx->saved_sp_);
+        info.stack_size = ctx->stack_size_;
+        if ( bottom <= sp && sp < top) {
+            info.stack_used = static_cast< std::size_t >( top - sp);
+            // the frames of a running fiber change while they are walked
+            if ( backtrace && ! active) {
+                void * frames[64];
+                std::size_t n = walk_frames( sp, bottom, top, frames, 64);
+                info.backtrace.assign( frames, frames + n);
+            }
+        }
+    }
+    return info;
+}
+
+}
+
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+std::vector< scheduler_dump >
+dump_fibers( std::chrono::milliseconds timeout, bool backtraces) {
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeout;
+    std::vector< scheduler_dump > result;
+    std::vector< std::shared_ptr< dump_request > > requests;
+    {
+        // a scheduler is removed from the registry before it is destroyed,
+        // functions deferred while it is registered are run
+        std::unique_lock< std::mutex > lk( scheduler::registry_mtx_() );
+        for ( scheduler & sched : scheduler::registry_() ) {
+            scheduler_dump d;
+            d.thread_id = sched.thread_id_;
+            if ( std::this_thread::get_id() == sched.thread_id_) {
+                // the calling fiber belongs to this scheduler
+                sched.dump( d.fibers, backtraces, nullptr);
+                d.complete = true;
+                requests.emplace_back();
+            } else {
+                std::shared_ptr< dump_request > r = std::make_shared< dump_request >( & sched, backtraces);
+                r->self = r;
+                try {
+                    sched.defer( r.get() );
+                } catch (...) {
+                    r->self.reset();
+                    throw;
+                }
+                requests.push_back( r);
+            }
+            result.push_back( std::move( d) );
+        }
+    }
+    for ( std::size_t i = 0; i < requests.size(); ++i) {
+        if ( ! requests[i]) {
+            continue;
+        }
+        dump_request & r = * requests[i];
+        std::unique_lock< std::mutex > lk( r.mtx);
+        if ( r.cnd.wait_until( lk, deadline, [&r](){ return r.done; }) ) {
+            result[i].fibers = std::move( r.fibers);
+            result[i].complete = true;
+        }
+    }
+    // the running fiber of the schedulers not responding; the registry
+    // lock keeps the schedulers alive
+    std::unique_lock< std::mutex > lk( scheduler::registry_mtx_() );
+    for ( scheduler & sched : scheduler::registry_() ) {
+        for ( scheduler_dump & d : result) {
+            if ( ! d.complete && d.thread_id == sched.thread_id_) {
+                context * running = sched.activity_.running.load( std::memory_order_relaxed);
+                fiber_info info;
+                info.id = context::id{ running };
+                info.state = fiber_state::running;
+                d.fibers.push_back( info);
+            }
+        }
+    }
+    return result;
+}
+#endif
+
+std::ostream &
+operator<<( std::ostream & os, fiber_state state) {
+    return os << state_name( state);
+}
+
+std::ostream &
+operator<<( std::ostream & os, scheduler_dump const& d) {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    os << "thread " << d.thread_id << ": " << d.fibers.size() << " fibers";
+    if ( ! d.complete) {
+        os << " (not responding)";
+    }
+    os << '\n';
+    for ( fiber_info const& f : d.fibers) {
+        os << "  fiber " << f.id << ( f.main ? " (main)" : "") << ' ' << state_name( f.state);
+        if ( fiber_state::blocked == f.state && block_reason::none != f.reason) {
+            os << " on " << detail::reason_name( f.reason);
+            if ( nullptr != f.object) {
+                os << ' ' << f.object;
+            }
+        }
+        if ( (std::chrono::steady_clock::time_point::max)() != f.deadline) {
+            os << ", deadline in "
+               << std::chrono::duration_cast< std::chrono::microseconds >( f.deadline - now).count() << "us";
+        }
+        if ( 0 != f.stack_size) {
+            os << ", stack " << f.stack_used << '/' << f.stack_size << " bytes";
+        }
+        if ( f.stats.enabled) {
+            os << ", cpu "
+               << std::chrono::duration_cast< std::chrono::microseconds >( f.stats.cpu_time).count() << "us, "
+               << f.stats.switches << " switches, ready "
+               << std::chrono::duration_cast< std::chrono::microseconds >( f.stats.ready_time).count() << "us";
+        }
+        os << '\n';
+        for ( std::size_t i = 0; i < f.backtrace.size(); ++i) {
+            os << "    #" << i << ' ' << f.backtrace[i] << '\n';
+        }
+    }
+    return os;
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,87 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/io.hpp"
+
+#include <cerrno>
+
+#include <unistd.h>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+::ssize_t
+read( int fd, void * buf, std::size_t count) {
+    for (;;) {
+        ::ssize_t n = ::read( fd, buf, count);
+        if ( -1 != n) {
+            return n;
+        }
+        if ( EINTR == errno) {
+            continue;
+        }
+        if ( EAGAIN != errno && EWOULDBLOCK != errno) {
+            return -1;
+        }
+        // suspend this fiber till fd becomes readable
+        this_fiber::wait_readable( fd);
+    }
+}
+
+::ssize_t
+write( int fd, void const* buf, std::size_t count) {
+    for (;;) {
+        ::ssize_t n = ::write( fd, buf, count);
+        if ( -1 != n) {
+            return n;
+        }
+        if ( EINTR == errno) {
+            continue;
+        }
+        if ( EAGAIN != errno && EWOULDBLOCK != errno) {
+            return -1;
+        }
+        // suspend this fiber till fd becomes writable
+        this_fiber::wait_writable( fd);
+    }
+}
+
+int
+accept( int fd, ::sockaddr * addr, ::socklen_t * addrlen) {
+    for (;;) {
+        int s = ::accept4( fd, addr, addrlen, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if ( -1 != s) {
+            return s;
+        }
+        if ( EINTR == errno || ECONNABORTED == errno) {
+            continue;
+        }
+        if ( EAGAIN != errno && EWOULDBLOCK != errno) {
+            return -1;
+        }
+        // pending connection signals readability of listening socket
+        this_fiber::wait_readable( fd);
+    }
+}
+
+int
+close( int fd) {
+    algo::epoll * ep = algo::epoll::instance();
+    if ( nullptr != ep) {
+        ep->forget( fd);
+    }
+    return ::close( fd);
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,351 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/monitor.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include <map>
+#include <system_error>
+
+#if defined(BOOST_FIBERS_HAS_PTHREAD_KILL)
+# include <signal.h>
+# include <ucontext.h>
+#endif
+
+#include "boost/fiber/exceptions.hpp"
+#include "boost/fiber/fiber_dump.hpp"
+#include "boost/fiber/scheduler.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+namespace {
+
+struct sample {
+    std::size_t                                 switches;
+    std::chrono::steady_clock::time_point       since;
+    bool                                        reported;
+    bool                                        seen;
+};
+
+void report_stderr( blocked_fiber const& info) {
+    std::cerr << "boost fiber: fiber " << info.fiber_id
+              << " blocks thread " << info.thread_id << " for "
+              << std::chrono::duration_cast< std::chrono::milliseconds >( info.duration).count()
+              << "ms";
+    if ( nullptr != info.spawn_site) {
+        std::cerr << ", launched at " << info.spawn_site;
+    }
+    if ( 0 < info.handed_off) {
+        std::cerr << ", " << info.handed_off << " fibers handed off";
+    }
+    std::cerr << '\n';
+    for ( std::size_t i = 0; i < info.backtrace.size(); ++i) {
+        std::cerr << "    #" << i << ' ' << info.backtrace[i] << '\n';
+    }
+    std::cerr << std::flush;
+}
+
+#if defined(BOOST_FIBERS_HAS_PTHREAD_KILL)
+// one stack sample is taken at a time: the monitor thread requests it
+// (idle -> requested) and interrupts the blocked thread, whose signal
+// handler takes it (requested -> taking -> taken); a late signal finds
+// the request withdrawn
+enum sample_state {
+    sample_idle = 0,
+    sample_requested,
+    sample_taking,
+    sample_taken
+};
+
+struct stack_sample {
+    std::atomic< int >      state{ sample_idle };
+    pthread_t               target;
+    void                *   frames[64];
+    std::size_t             size{ 0 };
+};
+
+stack_sample g_sample;
+std::mutex g_sample_mtx;
+// the handler is installed while monitors sampling the stack exist
+int g_sample_signal = 0;
+std::size_t g_sample_users = 0;
+struct sigaction g_old_action;
+
+void on_sample_signal( int, siginfo_t *, void * uc) {
+    // a late signal of a withdrawn request
+    if ( sample_requested != g_sample.state.load( std::memory_order_acquire) ||
+         ! ::pthread_equal( ::pthread_self(), g_sample.target) ) {
+        return;
+    }
+    int expected = sample_requested;
+    if ( ! g_sample.state.compare_exchange_strong( expected, sample_taking, std::memory_order_acquire) ) {
+        return;
+    }
+    std::size_t n = 0;
+    void * fp = BOOST_FIBERS_FRAME;
+# if BOOST_OS_LINUX && defined(__x86_64__)
+    // start at the interrupted instruction instead of the handler
+    mcontext_t const& mc = static_cast< ucontext_t * >( uc)->uc_mcontext;
+    g_sample.frames[n++] = reinterpret_cast< void * >( mc.gregs[REG_RIP]);
+    fp = reinterpret_cast< void * >( mc.gregs[REG_RBP]);
+# else
+    ( void)uc;
+# endif
+    context * ctx = context::active();
+    // the bounds of the main context's stack are unknown
+    if ( nullptr != ctx && nullptr != ctx->stack_base_) {
+        char * top = static_cast< char * >( ctx->stack_base_);
+        n += detail::walk_frames( fp, top - ctx->stack_size_, top, g_sample.frames + n, 64 - n);
+    }
+    g_sample.size = n;
+    g_sample.state.store( sample_taken, std::memory_order_release);
+}
+
+void install_sample_handler( int signo) {
+    std::unique_lock< std::mutex > lk( g_sample_mtx);
+    if ( 0 < g_sample_users) {
+        if ( g_sample_signal != signo) {
+            throw fiber_error{
+                    std::make_error_code( std::errc::invalid_argument),
+                    "boost fiber: monitors sample the stack with different signals" };
+        }
+        ++g_sample_users;
+        return;
+    }
+    struct sigaction action;
+    action.sa_sigaction = & on_sample_signal;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    ::sigemptyset( & action.sa_mask);
+    if ( 0 != ::sigaction( signo, & action, & g_old_action) ) {
+        throw fiber_error{
+                std::make_error_code( std::errc::invalid_argument),
+                "boost fiber: invalid signal to sample the stack" };
+    }
+    g_sample_signal = signo;
+    g_sample_users = 1;
+}
+
+void uninstall_sample_handler() noexcept {
+    std::unique_lock< std::mutex > lk( g_sample_mtx);
+    if ( 0 == --g_sample_users) {
+        ::sigaction( g_sample_signal, & g_old_action, nullptr);
+        g_sample_signal = 0;
+    }
+}
+
+// interrupts the thread and waits (at most 10ms) until its signal handler
+// has sampled the stack; called while the registry is locked, i.e. the
+// thread exists
+void sample_stack( pthread_t thread, std::vector< void * > & frames) {
+    std::unique_lock< std::mutex > lk( g_sample_mtx);
+    g_sample.target = thread;
+    g_sample.size = 0;
+    g_sample.state.store( sample_requested, std::memory_order_release);
+    if ( 0 != ::pthread_kill( thread, g_sample_signal) ) {
+        g_sample.state.store( sample_idle, std::memory_order_relaxed);
+        return;
+    }
+    std::chrono::steady_clock::time_point deadline =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds( 10);
+    int state;
+    while ( sample_taken != ( state = g_sample.state.load( std::memory_order_acquire) ) ) {
+        if ( sample_requested == state && deadline <= std::chrono::steady_clock::now() ) {
+            int expected = sample_requested;
+            if ( g_sample.state.compare_exchange_strong( expected, sample_idle) ) {
+                // withdrawn, e.g. the signal is blocked
+                return;
+            }
+        }
+        std::this_thread::yield();
+    }
+    frames.assign( g_sample.frames, g_sample.frames + g_sample.size);
+    g_sample.state.store( sample_idle, std::memory_order_relaxed);
+}
+#endif
+
+}
+
+void
+monitor::run_() noexcept {
+    // the monitor thread gets a scheduler by notifying spare_cnd_
+    std::thread::id self = std::this_thread::get_id();
+    std::thread::id spare = spare_.get_id();
+    std::chrono::steady_clock::duration interval =
+        (std::max)( threshold_ / 4,
+                    std::chrono::steady_clock::duration{ std::chrono::milliseconds( 1) });
+    std::map< scheduler *, sample > samples;
+    std::vector< blocked_fiber > blocked;
+    std::unique_lock< std::mutex > lk( mtx_);
+    while ( ! shutdown_) {
+        cnd_.wait_for( lk, interval);
+        if ( shutdown_) {
+            break;
+        }
+        lk.unlock();
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        std::size_t handed = 0;
+        {
+            // schedulers are not destroyed while the registry is locked
+            std::unique_lock< std::mutex > rlk( scheduler::registry_mtx_() );
+            for ( scheduler & sched : scheduler::registry_() ) {
+                if ( self == sched.thread_id_) {
+                    continue;
+                }
+                std::size_t switches = sched.activity_.switches.load( std::memory_order_relaxed);
+                context * running = sched.activity_.running.load( std::memory_order_relaxed);
+                auto i = samples.find( & sched);
+                if ( samples.end() == i || i->second.switches != switches) {
+                    samples[& sched] = sample{ switches, now, false, true };
+                    continue;
+                }
+                i->second.seen = true;
+                // the dispatcher context only runs when no fiber is ready
+                // (it might block in algorithm::suspend_until()); a main
+                // context without fibers (e.g. joining threads) blocks nobody
+                if ( i->second.reported ||
+                     sched.dispatcher_ctx_.get() == running ||
+                     ( sched.main_ctx_ == running &&
+                       0 == sched.activity_.workers.load( std::memory_order_relaxed) ) ||
+                     now - i->second.since < threshold_) {
+                    continue;
+                }
+                i->second.reported = true;
+                blocked_fiber info{ sched.thread_id_, context::id{ running }, now - i->second.since, 0,
+                                    sched.activity_.running_site.load( std::memory_order_relaxed), {} };
+#if defined(BOOST_FIBERS_HAS_PTHREAD_KILL)
+                if ( 0 != sample_signal_) {
+                    sample_stack( sched.native_thread_, info.backtrace);
+                }
+#endif
+                if ( handoff_ && spare != sched.thread_id_) {
+                    context * ctx = nullptr;
+                    std::unique_lock< std::mutex > hlk( mtx_);
+                    while ( nullptr != ( ctx = sched.algo_->steal() ) ) {
+                        handed_.push_back( ctx);
+                        ++info.handed_off;
+                    }
+                    handed += info.handed_off;
+                }
+                blocked.push_back( info);
+            }
+        }
+        // forget destroyed schedulers
+        for ( auto i = samples.begin(); i != samples.end();) {
+            if ( ! i->second.seen) {
+                i = samples.erase( i);
+            } else {
+                i->second.seen = false;
+                ++i;
+            }
+        }
+        if ( 0 < handed) {
+            spare_cnd_.notify_one();
+        }
+        for ( blocked_fiber const& info : blocked) {
+            report_( info);
+        }
+        blocked.clear();
+        lk.lock();
+    }
+}
+
+void
+monitor::run_spare_() noexcept {
+    context * active_ctx = context::active();
+    std::unique_lock< std::mutex > lk( mtx_);
+    while ( ! shutdown_) {
+        if ( handed_.empty() ) {
+            spare_cnd_.wait( lk);
+            continue;
+        }
+        std::vector< context * > handed;
+        handed.swap( handed_);
+        lk.unlock();
+        for ( context * ctx : handed) {
+            // the stolen context has been detached from its scheduler
+            active_ctx->attach( ctx);
+            active_ctx->get_scheduler()->set_ready( ctx);
+        }
+        lk.lock();
+    }
+}
+
+monitor::monitor( std::chrono::steady_clock::duration const& threshold,
+                  report_fn report,
+                  bool handoff,
+                  int sample_signal) :
+    threshold_{ threshold },
+    report_{ report ? std::move( report) : report_fn{ report_stderr } },
+    handoff_{ handoff },
+    sample_signal_{ sample_signal } {
+    if ( std::chrono::steady_clock::duration::zero() >= threshold_) {
+        throw fiber_error{
+                std::make_error_code( std::errc::invalid_argument),
+                "boost fiber: monitor threshold must be positive" };
+    }
+    if ( 0 != sample_signal_) {
+#if defined(BOOST_FIBERS_HAS_PTHREAD_KILL)
+        install_sample_handler( sample_signal_);
+#else
+        throw fiber_error{
+                std::make_error_code( std::errc::operation_not_supported),
+                "boost fiber: sampling the stack is not supported" };
+#endif
+    }
+    try {
+        if ( handoff_) {
+            spare_ = std::thread{ & monitor::run_spare_, this };
+        }
+        thread_ = std::thread{ & monitor::run_, this };
+    } catch (...) {
+        {
+            std::unique_lock< std::mutex > lk( mtx_);
+            shutdown_ = true;
+        }
+        if ( spare_.joinable() ) {
+            spare_cnd_.notify_all();
+            spare_.join();
+        }
+#if defined(BOOST_FIBERS_HAS_PTHREAD_KILL)
+        if ( 0 != sample_signal_) {
+            uninstall_sample_handler();
+        }
+#endif
+        throw;
+    }
+}
+
+monitor::~monitor() {
+    {
+        std::unique_lock< std::mutex > lk( mtx_);
+        shutdown_ = true;
+    }
+    cnd_.notify_all();
+    thread_.join();
+    if ( spare_.joinable() ) {
+        spare_cnd_.notify_all();
+        spare_.join();
+    }
+#if defined(BOOST_FIBERS_HAS_PTHREAD_KILL)
+    if ( 0 != sample_signal_) {
+        uninstall_sample_handler();
+    }
+#endif
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
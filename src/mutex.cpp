@@ -11,6 +11,7 @@
 #include <system_error>
 
 #include "boost/fiber/exceptions.hpp"
+#include "boost/fiber/observer.hpp"
 #include "boost/fiber/scheduler.hpp"
 
 #ifdef BOOST_HAS_ABI_HEADERS
@@ -35,6 +36,7 @@ mutex::lock() {
     }
     BOOST_ASSERT( ! ctx->wait_is_linked() );
     ctx->wait_link( wait_queue_);
+    detail::observe( event_type::block, ctx, ctx, block_reason::mutex, this, BOOST_FIBERS_CALLER);
     // suspend this fiber
     ctx->suspend( lk);
     BOOST_ASSERT( ! ctx->wait_is_linked() );
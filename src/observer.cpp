@@ -0,0 +1,91 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/observer.hpp"
+
+#include <atomic>
+
+#include "boost/fiber/scheduler.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+namespace {
+
+std::atomic< observer * > observer_{ nullptr };
+
+}
+
+observer *
+set_observer( observer * o) noexcept {
+    return observer_.exchange( o, std::memory_order_acq_rel);
+}
+
+void
+observer::record( event_type type, context * ctx, context * from,
+                  block_reason reason, void const * object, void const * caller) noexcept {
+    event e{ type,
+             reason,
+             ctx->get_id(),
+             nullptr != from ? from->get_id() : context::id{},
+             ctx->get_scheduler(),
+             timestamps_
+                ? std::chrono::steady_clock::now()
+                : std::chrono::steady_clock::time_point{},
+             object,
+             caller };
+    on_event( e);
+}
+
+namespace detail {
+
+char const*
+reason_name( block_reason reason) noexcept {
+    switch ( reason) {
+    case block_reason::mutex:
+        return "mutex";
+    case block_reason::condition_variable:
+        return "condition_variable";
+    case block_reason::channel_push:
+        return "channel_push";
+    case block_reason::channel_pop:
+        return "channel_pop";
+    case block_reason::join:
+        return "join";
+    case block_reason::sleep:
+        return "sleep";
+    default:
+        return "none";
+    }
+}
+
+#if defined(BOOST_FIBERS_HOOKS)
+void
+notify_observer( event_type type, context * ctx, context * from,
+                 block_reason reason, void const * object, void const * caller) noexcept {
+    observer * o = observer_.load( std::memory_order_acquire);
+    if ( nullptr != o) {
+        o->record( type, ctx, from, reason, object, caller);
+    }
+}
+#else
+void
+notify_observer( event_type, context *, context *,
+                 block_reason, void const *, void const *) noexcept {
+}
+#endif
+
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
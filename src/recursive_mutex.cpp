@@ -10,6 +10,7 @@
 #include <functional>
 
 #include "boost/fiber/exceptions.hpp"
+#include "boost/fiber/observer.hpp"
 #include "boost/fiber/scheduler.hpp"
 
 #ifdef BOOST_HAS_ABI_HEADERS
@@ -34,6 +35,7 @@ recursive_mutex::lock() {
     }
     BOOST_ASSERT( ! ctx->wait_is_linked() );
     ctx->wait_link( wait_queue_);
+    detail::observe( event_type::block, ctx, ctx, block_reason::mutex, this, BOOST_FIBERS_CALLER);
     // suspend this fiber
     ctx->suspend( lk);
     BOOST_ASSERT( ! ctx->wait_is_linked() );
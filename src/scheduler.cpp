@@ -6,6 +6,7 @@
 
 #include "boost/fiber/scheduler.hpp"
 
+#include <algorithm>
 #include <chrono>
 #include <mutex>
 
@@ -14,6 +15,8 @@
 #include "boost/fiber/algo/round_robin.hpp"
 #include "boost/fiber/context.hpp"
 #include "boost/fiber/exceptions.hpp"
+#include "boost/fiber/fiber_dump.hpp"
+#include "boost/fiber/observer.hpp"
 
 #ifdef BOOST_HAS_ABI_HEADERS
 #  include BOOST_ABI_PREFIX
@@ -25,6 +28,11 @@ namespace fibers {
 context *
 scheduler::get_next_() noexcept {
     context * ctx = algo_->pick_next();
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    if ( nullptr != ctx) {
+        detail::stat_inc( counters_.get(), & detail::scheduler_counters::dequeued);
+    }
+#endif
     //BOOST_ASSERT( nullptr == ctx);
     //BOOST_ASSERT( this == ctx->get_scheduler() );
     return ctx;
@@ -44,6 +52,9 @@ scheduler::release_terminated_() noexcept {
         BOOST_ASSERT( ! ctx->sleep_is_linked() );
         // remove context from worker-queue
         ctx->worker_unlink();
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+        add_workers_( -1);
+#endif
         // remove context from terminated-queue
         i = terminated_queue_.erase( i);
         // if last reference, e.g. fiber::join() or fiber::detach()
@@ -61,6 +72,71 @@ scheduler::remote_ready2ready_() noexcept {
     while ( nullptr != ( ctx = remote_ready_queue_.pop() ) ) {
         // store context in local queues
         set_ready( ctx);
+        detail::stat_inc( counters_.get(), & detail::scheduler_counters::remote_wakeups);
+    }
+}
+
+void
+scheduler::remote_post2ready_() noexcept {
+    context * ctx = nullptr;
+    // get new context from remote post-queue
+    while ( nullptr != ( ctx = remote_post_queue_.pop() ) ) {
+        // the reference of the context is owned by the scheduler,
+        // as for a detached fiber
+        attach_worker_context( ctx);
+        detail::observe( event_type::spawn, ctx, context::active() );
+        set_ready( ctx);
+        detail::stat_inc( counters_.get(), & detail::scheduler_counters::fibers_created);
+    }
+}
+
+void
+scheduler::remote_migrate2ready_() noexcept {
+    context * ctx = nullptr;
+    // get context from remote migrate-queue
+    while ( nullptr != ( ctx = remote_migrate_queue_.pop() ) ) {
+        attach_worker_context( ctx);
+        detail::observe( event_type::steal, ctx, context::active() );
+        set_ready( ctx);
+    }
+}
+
+void
+scheduler::run_deferred_() noexcept {
+    context * active_ctx = context::active();
+    for (;;) {
+        detail::spinlock_lock lk( deferred_splk_);
+        if ( nullptr == deferred_head_) {
+            if ( shutdown_) {
+                deferred_running_ = false;
+                return;
+            }
+            // woken up by defer() or by the dispatcher at shutdown
+            deferred_waiting_ = active_ctx;
+            active_ctx->suspend( lk);
+            continue;
+        }
+        detail::deferred * d = deferred_head_;
+        deferred_head_ = nullptr;
+        deferred_tail_ = & deferred_head_;
+        lk.unlock();
+        while ( nullptr != d) {
+            // fn might release the node
+            detail::deferred * next = d->next;
+            d->fn( d);
+            d = next;
+        }
+    }
+}
+
+void
+scheduler::wake_deferred_() noexcept {
+    detail::spinlock_lock lk( deferred_splk_);
+    context * ctx = deferred_waiting_;
+    deferred_waiting_ = nullptr;
+    lk.unlock();
+    if ( nullptr != ctx) {
+        set_ready( ctx);
     }
 }
 #endif
@@ -70,8 +146,7 @@ scheduler::sleep2ready_() noexcept {
     // move context which the deadline has reached
     // to ready-queue
     // sleep-queue is sorted (ascending)
-    std::chrono::steady_clock::time_point now =
-        std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point now = algo_->now();
     sleep_queue_t::iterator e = sleep_queue_.end();
     for ( sleep_queue_t::iterator i = sleep_queue_.begin(); i != e;) {
         context * ctx = & ( * i);
@@ -88,22 +163,118 @@ scheduler::sleep2ready_() noexcept {
             i = sleep_queue_.erase( i);
             // reset sleep-tp
             ctx->tp_ = (std::chrono::steady_clock::time_point::max)();
+            ctx->wait_reason_ = block_reason::none;
+            detail::observe( event_type::ready, ctx, dispatcher_ctx_.get() );
+#if defined(BOOST_FIBERS_STATS)
+            ctx->ready_since_ = std::chrono::steady_clock::now();
+            ctx->remote_ready_ = false;
+#endif
             // push new context to ready-queue
             algo_->awakened( ctx);
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+            detail::stat_inc( counters_.get(), & detail::scheduler_counters::timers_fired);
+            detail::stat_inc( counters_.get(), & detail::scheduler_counters::enqueued);
+#endif
         } else {
             break; // first context with now < deadline
         }
     }
 }
 
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+std::mutex &
+scheduler::registry_mtx_() noexcept {
+    static std::mutex mtx;
+    return mtx;
+}
+
+scheduler::registry_t &
+scheduler::registry_() noexcept {
+    static registry_t registry;
+    return registry;
+}
+#endif
+
+// add_poller() requires that pollers do not throw; an exception escaping a
+// poller calls std::terminate()
+bool
+scheduler::poll_() noexcept {
+    bool did_work = false;
+    for ( std::list< poller_t >::iterator i = pollers_.begin(); i != pollers_.end();) {
+        if ( ! i->removed && i->fn() ) {
+            did_work = true;
+        }
+        if ( i->removed) {
+            i = pollers_.erase( i);
+        } else {
+            ++i;
+        }
+    }
+    return did_work;
+}
+
+void
+scheduler::idle_() noexcept {
+    // set deadline to highest value
+    std::chrono::steady_clock::time_point suspend_time =
+            (std::chrono::steady_clock::time_point::max)();
+    // get lowest deadline from sleep-queue
+    sleep_queue_t::iterator i = sleep_queue_.begin();
+    if ( sleep_queue_.end() != i) {
+        suspend_time = i->tp_;
+    }
+    if ( ! pollers_.empty() ) {
+        // event sources must be polled again after the poll interval
+        if ( std::chrono::steady_clock::duration::zero() == poll_interval_) {
+            // busy polling
+            return;
+        }
+        suspend_time = (std::min)( suspend_time,
+                                   algo_->now() + poll_interval_);
+    }
+    // no ready context, wait till signaled
+#if defined(BOOST_FIBERS_STATS) && ! defined(BOOST_FIBERS_NO_ATOMICS)
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    counters_->parked_since.store( start.time_since_epoch().count(), std::memory_order_relaxed);
+    algo_->suspend_until( suspend_time);
+    detail::stat_inc( counters_.get(), & detail::scheduler_counters::parks);
+    counters_->parked_ns.store(
+            counters_->parked_ns.load( std::memory_order_relaxed) +
+                std::chrono::duration_cast< std::chrono::nanoseconds >(
+                    std::chrono::steady_clock::now() - start).count(),
+            std::memory_order_relaxed);
+    counters_->parked_since.store( 0, std::memory_order_relaxed);
+#else
+    algo_->suspend_until( suspend_time);
+#endif
+}
+
 scheduler::scheduler() noexcept :
     algo_{ new algo::round_robin() } {
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    thread_id_ = std::this_thread::get_id();
+#if defined(BOOST_FIBERS_STATS)
+    counters_.reset( new detail::scheduler_counters{} );
+#endif
+#if defined(BOOST_FIBERS_HAS_PTHREAD_KILL)
+    native_thread_ = ::pthread_self();
+#endif
+    std::unique_lock< std::mutex > lk( registry_mtx_() );
+    registry_().push_back( * this);
+#endif
 }
 
 scheduler::~scheduler() {
     BOOST_ASSERT( nullptr != main_ctx_);
     BOOST_ASSERT( nullptr != dispatcher_ctx_.get() );
     BOOST_ASSERT( context::active() == main_ctx_);
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    {
+        // not monitored any longer
+        std::unique_lock< std::mutex > lk( registry_mtx_() );
+        registry_().erase( registry_().iterator_to( * this) );
+    }
+#endif
     // signal dispatcher-context termination
     shutdown_ = true;
     // resume pending fibers
@@ -129,10 +300,17 @@ void
 scheduler::dispatch() noexcept {
     BOOST_ASSERT( context::active() == dispatcher_ctx_);
     for (;;) {
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+        detail::stat_inc( counters_.get(), & detail::scheduler_counters::rounds);
+#endif
         bool no_worker = worker_queue_.empty();
         if ( shutdown_) {
             // notify sched-algorithm about termination
             algo_->notify();
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+            // let the deferred runner terminate
+            wake_deferred_();
+#endif
             if ( no_worker) {
                 break;
             }
@@ -142,9 +320,15 @@ scheduler::dispatch() noexcept {
 #if ! defined(BOOST_FIBERS_NO_ATOMICS)
         // get context' from remote ready-queue
         remote_ready2ready_();
+        // get new context' from remote post-queue
+        remote_post2ready_();
+        // get context' passed by other threads
+        remote_migrate2ready_();
 #endif
         // get sleeping context'
         sleep2ready_();
+        // poll user-defined event sources, might make context' ready
+        bool polled = poll_();
         // get next ready context
         context * ctx = get_next_();
         if ( nullptr != ctx) {
@@ -152,18 +336,9 @@ scheduler::dispatch() noexcept {
             // so that ready-queue never becomes empty
             ctx->resume( dispatcher_ctx_.get() );
             BOOST_ASSERT( context::active() == dispatcher_ctx_.get() );
-        } else {
-            // no ready context, wait till signaled
-            // set deadline to highest value
-            std::chrono::steady_clock::time_point suspend_time =
-                    (std::chrono::steady_clock::time_point::max)();
-            // get lowest deadline from sleep-queue
-            sleep_queue_t::iterator i = sleep_queue_.begin();
-            if ( sleep_queue_.end() != i) {
-                suspend_time = i->tp_;
-            }
-            // no ready context, wait till signaled
-            algo_->suspend_until( suspend_time);
+        } else if ( ! polled) {
+            // no ready context and no event source did work
+            idle_();
         }
     }
     // release termianted context'
@@ -176,10 +351,17 @@ boost::context::continuation
 scheduler::dispatch() noexcept {
     BOOST_ASSERT( context::active() == dispatcher_ctx_);
     for (;;) {
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+        detail::stat_inc( counters_.get(), & detail::scheduler_counters::rounds);
+#endif
         bool no_worker = worker_queue_.empty();
         if ( shutdown_) {
             // notify sched-algorithm about termination
             algo_->notify();
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+            // let the deferred runner terminate
+            wake_deferred_();
+#endif
             if ( no_worker) {
                 break;
             }
@@ -189,9 +371,15 @@ scheduler::dispatch() noexcept {
 #if ! defined(BOOST_FIBERS_NO_ATOMICS)
         // get context' from remote ready-queue
         remote_ready2ready_();
+        // get new context' from remote post-queue
+        remote_post2ready_();
+        // get context' passed by other threads
+        remote_migrate2ready_();
 #endif
         // get sleeping context'
         sleep2ready_();
+        // poll user-defined event sources, might make context' ready
+        bool polled = poll_();
         // get next ready context
         context * ctx = get_next_();
         if ( nullptr != ctx) {
@@ -199,18 +387,9 @@ scheduler::dispatch() noexcept {
             // so that ready-queue never becomes empty
             ctx->resume( dispatcher_ctx_.get() );
             BOOST_ASSERT( context::active() == dispatcher_ctx_.get() );
-        } else {
-            // no ready context, wait till signaled
-            // set deadline to highest value
-            std::chrono::steady_clock::time_point suspend_time =
-                    (std::chrono::steady_clock::time_point::max)();
-            // get lowest deadline from sleep-queue
-            sleep_queue_t::iterator i = sleep_queue_.begin();
-            if ( sleep_queue_.end() != i) {
-                suspend_time = i->tp_;
-            }
-            // no ready context, wait till signaled
-            algo_->suspend_until( suspend_time);
+        } else if ( ! polled) {
+            // no ready context and no event source did work
+            idle_();
         }
     }
     // release termianted context'
@@ -236,8 +415,12 @@ scheduler::set_ready( context * ctx) noexcept {
     }
     // for safety unlink it from ready-queue
     ctx->ready_unlink();
+    ctx->wait_reason_ = block_reason::none;
     // push new context to ready-queue
     algo_->awakened( ctx);
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    detail::stat_inc( counters_.get(), & detail::scheduler_counters::enqueued);
+#endif
 }
 
 #if ! defined(BOOST_FIBERS_NO_ATOMICS)
@@ -252,10 +435,94 @@ scheduler::set_remote_ready( context * ctx) noexcept {
     // context ctx might in wait-/ready-/sleep-queue
     // we do not test this in this function
     // scheduler::dispatcher() has to take care
+    // ctx might be resumed and terminated as soon as it is pushed
+    detail::observe( event_type::remote_ready, ctx, context::active() );
+#if defined(BOOST_FIBERS_STATS)
+    ctx->ready_since_ = std::chrono::steady_clock::now();
+    ctx->remote_ready_ = true;
+#endif
     // push new context to remote ready-queue
     remote_ready_queue_.push( ctx);
     // notify scheduler
     algo_->notify();
+    detail::stat_inc_shared( counters_.get(), & detail::scheduler_counters::unparks);
+}
+
+void
+scheduler::remote_post( context * first, context * last) noexcept {
+    BOOST_ASSERT( nullptr != first);
+    BOOST_ASSERT( nullptr != last);
+    // push new context' to remote post-queue
+    remote_post_queue_.push( first, last);
+    // notify scheduler
+    algo_->notify();
+    detail::stat_inc_shared( counters_.get(), & detail::scheduler_counters::unparks);
+}
+
+void
+scheduler::remote_migrate( context * ctx) noexcept {
+    BOOST_ASSERT( nullptr != ctx);
+    BOOST_ASSERT( ! ctx->is_context( type::pinned_context) );
+    // push context to remote migrate-queue
+    remote_migrate_queue_.push( ctx);
+    // notify scheduler
+    algo_->notify();
+    detail::stat_inc_shared( counters_.get(), & detail::scheduler_counters::unparks);
+}
+
+void
+scheduler::notify() noexcept {
+    algo_->notify();
+    detail::stat_inc_shared( counters_.get(), & detail::scheduler_counters::unparks);
+}
+
+void
+scheduler::defer( detail::deferred * d) {
+    BOOST_ASSERT( nullptr != d);
+    BOOST_ASSERT( nullptr != d->fn);
+    detail::spinlock_lock lk( deferred_splk_);
+    d->next = nullptr;
+    * deferred_tail_ = d;
+    deferred_tail_ = & d->next;
+    if ( nullptr != deferred_waiting_) {
+        context * ctx = deferred_waiting_;
+        deferred_waiting_ = nullptr;
+        lk.unlock();
+        if ( std::this_thread::get_id() == thread_id_) {
+            set_ready( ctx);
+        } else {
+            set_remote_ready( ctx);
+        }
+        return;
+    }
+    if ( deferred_running_) {
+        return;
+    }
+    deferred_running_ = true;
+    lk.unlock();
+    try {
+        intrusive_ptr< context > ctx{
+            make_worker_context( launch::post, default_stack(),
+                                 [this](){ run_deferred_(); }) };
+        // the runner accesses this scheduler only
+        ctx->pin();
+        // the remaining reference is owned by the scheduler,
+        // as for a detached fiber
+        remote_post( ctx.get(), ctx.get() );
+    } catch (...) {
+        lk.lock();
+        deferred_running_ = false;
+        // no function runs, d is unlinked
+        detail::deferred ** i = & deferred_head_;
+        while ( d != * i) {
+            i = & ( * i)->next;
+        }
+        * i = d->next;
+        if ( deferred_tail_ == & d->next) {
+            deferred_tail_ = i;
+        }
+        throw;
+    }
 }
 #endif
 
@@ -275,6 +542,10 @@ scheduler::set_terminated( context * active_ctx) noexcept {
     // the dispatcher-context will call 
     // intrusive_ptr_release( ctx);
     active_ctx->terminated_link( terminated_queue_);
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    detail::stat_inc( counters_.get(), & detail::scheduler_counters::fibers_terminated);
+#endif
+    detail::observe( event_type::terminate, active_ctx, active_ctx);
     // resume another fiber
     get_next_()->resume();
 }
@@ -294,6 +565,10 @@ scheduler::set_terminated( context * active_ctx) noexcept {
     // the dispatcher-context will call 
     // intrusive_ptr_release( ctx);
     active_ctx->terminated_link( terminated_queue_);
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    detail::stat_inc( counters_.get(), & detail::scheduler_counters::fibers_terminated);
+#endif
+    detail::observe( event_type::terminate, active_ctx, active_ctx);
     // resume another fiber
     return get_next_()->suspend_with_cc();
 }
@@ -342,9 +617,9 @@ scheduler::wait_until( context * active_ctx,
     active_ctx->sleep_link( sleep_queue_);
     // resume another context
     get_next_()->resume();
-    // context has been resumed
+    // context has been resumed, maybe by another thread (work-stealing)
     // check if deadline has reached
-    return std::chrono::steady_clock::now() < sleep_tp;
+    return active_ctx->get_scheduler()->algo_->now() < sleep_tp;
 }
 
 bool
@@ -372,9 +647,9 @@ scheduler::wait_until( context * active_ctx,
     active_ctx->sleep_link( sleep_queue_);
     // resume another context
     get_next_()->resume( lk);
-    // context has been resumed
+    // context has been resumed, maybe by another thread (work-stealing)
     // check if deadline has reached
-    return std::chrono::steady_clock::now() < sleep_tp;
+    return active_ctx->get_scheduler()->algo_->now() < sleep_tp;
 }
 
 void
@@ -394,12 +669,55 @@ scheduler::has_ready_fibers() const noexcept {
     return algo_->has_ready_fibers();
 }
 
+bool
+scheduler::has_user_fibers() noexcept {
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    // deferred_waiting_ is set only while no function is queued
+    detail::spinlock_lock lk( deferred_splk_);
+    for ( context const& ctx : worker_queue_) {
+        if ( & ctx != deferred_waiting_) {
+            return true;
+        }
+    }
+    return false;
+#else
+    return ! worker_queue_.empty();
+#endif
+}
+
+scheduler::poller_id
+scheduler::add_poller( std::function< bool() > fn) {
+    BOOST_ASSERT( fn);
+    pollers_.push_back( poller_t{ next_poller_id_, std::move( fn), false });
+    return next_poller_id_++;
+}
+
+void
+scheduler::remove_poller( poller_id id) noexcept {
+    for ( poller_t & p : pollers_) {
+        if ( id == p.id) {
+            // erased by poll_(), the poller might be running
+            p.removed = true;
+            return;
+        }
+    }
+}
+
+void
+scheduler::set_poll_interval( std::chrono::steady_clock::duration const& interval) noexcept {
+    poll_interval_ = interval;
+}
+
 void
 scheduler::set_algo( std::unique_ptr< algo::algorithm > algo) noexcept {
     // move remaining cotnext in current scheduler to new one
     while ( algo_->has_ready_fibers() ) {
         algo->awakened( algo_->pick_next() );
     }
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    // the monitor might steal from the algorithm
+    std::unique_lock< std::mutex > lk( registry_mtx_() );
+#endif
     algo_ = std::move( algo);
 }
 
@@ -438,6 +756,9 @@ scheduler::attach_dispatcher_context( intrusive_ptr< context > dispatcher_ctx) n
     dispatcher_ctx_->scheduler_ = this;
 #endif
     algo_->awakened( dispatcher_ctx_.get() );
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    detail::stat_inc( counters_.get(), & detail::scheduler_counters::enqueued);
+#endif
 }
 
 void
@@ -457,6 +778,9 @@ scheduler::attach_worker_context( context * ctx) noexcept {
     ctx->scheduler_ = this;
 #endif
     ctx->worker_link( worker_queue_);
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    add_workers_( 1);
+#endif
 }
 
 void
@@ -470,6 +794,7 @@ scheduler::detach_worker_context( context * ctx) noexcept {
     BOOST_ASSERT( ! ctx->is_context( type::pinned_context) );
     ctx->worker_unlink();
 #if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    add_workers_( -1);
     ctx->scheduler_.store( nullptr, std::memory_order_relaxed);
     std::atomic_thread_fence( std::memory_order_release);
 #else
@@ -477,6 +802,82 @@ scheduler::detach_worker_context( context * ctx) noexcept {
 #endif
 }
 
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+scheduler_stats
+scheduler::stats() const {
+    scheduler_stats s;
+    s.thread_id = thread_id_;
+    s.switches = activity_.switches.load( std::memory_order_relaxed);
+    s.worker_fibers = activity_.workers.load( std::memory_order_relaxed);
+    detail::scheduler_counters const* c = counters_.get();
+    if ( nullptr == c) {
+        // built without BOOST_FIBERS_STATS
+        return s;
+    }
+    s.enabled = true;
+    s.rounds = c->rounds.load( std::memory_order_relaxed);
+    s.remote_wakeups = c->remote_wakeups.load( std::memory_order_relaxed);
+    s.timers_fired = c->timers_fired.load( std::memory_order_relaxed);
+    s.fibers_created = c->fibers_created.load( std::memory_order_relaxed);
+    s.fibers_terminated = c->fibers_terminated.load( std::memory_order_relaxed);
+    s.steals = c->steals.load( std::memory_order_relaxed);
+    s.failed_steals = c->failed_steals.load( std::memory_order_relaxed);
+    s.stolen = c->stolen.load( std::memory_order_relaxed);
+    s.parks = c->parks.load( std::memory_order_relaxed);
+    s.unparks = c->unparks.load( std::memory_order_relaxed);
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    s.parked_time = std::chrono::nanoseconds{ c->parked_ns.load( std::memory_order_relaxed) };
+    std::chrono::steady_clock::rep since = c->parked_since.load( std::memory_order_relaxed);
+    if ( 0 != since) {
+        // the scheduler is parked right now
+        std::chrono::steady_clock::time_point start{ std::chrono::steady_clock::duration{ since } };
+        if ( start < now) {
+            s.parked_time += std::chrono::duration_cast< std::chrono::nanoseconds >( now - start);
+        }
+    }
+    std::chrono::nanoseconds total =
+        std::chrono::duration_cast< std::chrono::nanoseconds >( now - c->created);
+    s.running_time = s.parked_time < total ? total - s.parked_time : std::chrono::nanoseconds::zero();
+    // the counters are read one after the other
+    std::uint64_t enqueued = c->enqueued.load( std::memory_order_relaxed) + s.steals;
+    std::uint64_t dequeued = c->dequeued.load( std::memory_order_relaxed) + s.stolen;
+    s.ready_fibers = dequeued < enqueued ? static_cast< std::size_t >( enqueued - dequeued) : 0;
+    s.local_wakeup_latency = c->local_latency.snapshot();
+    s.remote_wakeup_latency = c->remote_latency.snapshot();
+    return s;
+}
+
+std::vector< scheduler_stats > all_scheduler_stats() {
+    std::vector< scheduler_stats > result;
+    std::unique_lock< std::mutex > lk( scheduler::registry_mtx_() );
+    for ( scheduler const& sched : scheduler::registry_() ) {
+        result.push_back( sched.stats() );
+    }
+    return result;
+}
+#endif
+
+void
+scheduler::dump( std::vector< fiber_info > & fibers, bool backtraces, context * skip) {
+    context * active_ctx = context::active();
+    if ( skip != main_ctx_) {
+        fibers.push_back( detail::describe( main_ctx_, active_ctx == main_ctx_, backtraces) );
+    }
+    for ( context & ctx : worker_queue_) {
+        if ( skip != & ctx && ! ctx.is_terminated() ) {
+            fibers.push_back( detail::describe( & ctx, active_ctx == & ctx, backtraces) );
+        }
+    }
+}
+
+namespace detail {
+
+std::chrono::steady_clock::time_point now() noexcept {
+    return context::active()->get_scheduler()->now();
+}
+
+}
+
 }}
 
 #ifdef BOOST_HAS_ABI_HEADERS
@@ -0,0 +1,302 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/sharded.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <system_error>
+
+#include <boost/predef.h>
+
+#if BOOST_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "boost/fiber/context.hpp"
+#include "boost/fiber/detail/cache_aligned.hpp"
+#include "boost/fiber/exceptions.hpp"
+#include "boost/fiber/fiber.hpp"
+#include "boost/fiber/future/promise.hpp"
+#include "boost/fiber/operations.hpp"
+#include "boost/fiber/scheduler.hpp"
+#include "boost/fiber/scheduler_handle.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+struct sharded::shard : public detail::cache_aligned {
+    // written only by the thread of the shard
+    alignas(cache_alignment) std::atomic< std::size_t >    submitted{ 0 };
+    std::atomic< std::size_t >                              completed{ 0 };
+    // tasks submitted by threads not belonging to this runtime
+    alignas(cache_alignment) std::atomic< std::size_t >    external{ 0 };
+    scheduler                                           *   sched{ nullptr };
+    promise< void >                                         stop{};
+    std::mutex                                              mtx{};
+    std::condition_variable                                 cnd{};
+    bool                                                    started{ false };
+    std::thread                                             thread{};
+};
+
+namespace {
+
+struct this_shard_t {
+    sharded     *   owner;
+    std::size_t     index;
+};
+
+thread_local this_shard_t this_shard_{ nullptr, sharded::npos };
+
+// without notification idle shards check their rings in this interval
+constexpr std::chrono::milliseconds idle_poll_interval{ 100 };
+
+void pin_thread( std::size_t index) noexcept {
+#if BOOST_OS_LINUX
+    // pin to the index-th CPU of the CPUs the thread is allowed to run on
+    cpu_set_t allowed;
+    CPU_ZERO( & allowed);
+    if ( 0 != ::sched_getaffinity( 0, sizeof( allowed), & allowed) ) {
+        return;
+    }
+    int count = CPU_COUNT( & allowed);
+    if ( 0 == count) {
+        return;
+    }
+    int n = static_cast< int >( index % static_cast< std::size_t >( count) );
+    for ( int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if ( CPU_ISSET( cpu, & allowed) && 0 == n--) {
+            cpu_set_t cpuset;
+            CPU_ZERO( & cpuset);
+            CPU_SET( cpu, & cpuset);
+            // pinning is a hint, the shard runs unpinned on failure
+            ::pthread_setaffinity_np( ::pthread_self(), sizeof( cpuset), & cpuset);
+            return;
+        }
+    }
+#else
+    (void)index;
+#endif
+}
+
+void increment( std::atomic< std::size_t > & counter) noexcept {
+    // single writer
+    counter.store( counter.load( std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+}
+
+constexpr std::size_t sharded::npos;
+
+void
+sharded::run_( std::size_t index) noexcept {
+    if ( pin_) {
+        pin_thread( index);
+    }
+    this_shard_ = this_shard_t{ this, index };
+    shard & s = * shards_[index];
+    future< void > stopped = s.stop.get_future();
+    scheduler * sched = context::active()->get_scheduler();
+    sched->add_poller( [this,index](){ return poll_( index); });
+    if ( ! busy_poll_) {
+        sched->set_poll_interval( idle_poll_interval);
+    }
+    {
+        std::unique_lock< std::mutex > lk( s.mtx);
+        s.sched = sched;
+        s.started = true;
+    }
+    s.cnd.notify_all();
+    stopped.wait();
+    // tasks still running might submit further tasks to this shard:
+    // wait till all tasks of the runtime have been completed
+    // the completed counters are read before the submitted counters, so
+    // that equal sums mean that no task was pending in between
+    for (;;) {
+        std::size_t completed = 0;
+        for ( std::unique_ptr< shard > const& other : shards_) {
+            completed += other->completed.load( std::memory_order_acquire);
+        }
+        std::size_t submitted = 0;
+        for ( std::unique_ptr< shard > const& other : shards_) {
+            submitted += other->submitted.load( std::memory_order_acquire);
+            submitted += other->external.load( std::memory_order_acquire);
+        }
+        if ( completed == submitted) {
+            break;
+        }
+        this_fiber::sleep_for( std::chrono::milliseconds( 1) );
+    }
+    // the poller remains registered, fibers still running are completed
+    // by the scheduler at thread exit
+}
+
+bool
+sharded::poll_( std::size_t index) noexcept {
+    bool did_work = false;
+    shard & s = * shards_[index];
+    for ( std::size_t from = 0; from < size_; ++from) {
+        if ( from == index) {
+            continue;
+        }
+        ring_type & ring = * rings_[from * size_ + index];
+        detail::shard_task * t = nullptr;
+        while ( ring.pop( t) ) {
+            did_work = true;
+            try {
+                fiber{ launch::post, [&s,t](){
+                    std::unique_ptr< detail::shard_task > guard{ t };
+                    t->run();
+                    increment( s.completed);
+                }}.detach();
+            } catch (...) {
+                // the waiting fiber gets broken_promise
+                delete t;
+                increment( s.completed);
+            }
+        }
+    }
+    return did_work;
+}
+
+void
+sharded::submit_( std::size_t index, detail::shard_task * t) {
+    std::unique_ptr< detail::shard_task > guard{ t };
+    if ( index >= size_) {
+        throw fiber_error{
+                std::make_error_code( std::errc::invalid_argument),
+                "boost fiber: shard index out of range" };
+    }
+    shard & to = * shards_[index];
+    if ( this != this_shard_.owner) {
+        // lock-free as well, but shared by all external threads
+        // counted before the task might complete
+        to.external.fetch_add( 1, std::memory_order_acq_rel);
+        try {
+            scheduler_handle{ to.sched }.post( [&to,t](){
+                std::unique_ptr< detail::shard_task > guard{ t };
+                t->run();
+                increment( to.completed);
+            });
+        } catch (...) {
+            to.external.fetch_sub( 1, std::memory_order_acq_rel);
+            throw;
+        }
+        guard.release();
+        return;
+    }
+    shard & from = * shards_[this_shard_.index];
+    increment( from.submitted);
+    if ( this_shard_.index == index) {
+        try {
+            fiber{ launch::post, [&to,t](){
+                std::unique_ptr< detail::shard_task > guard{ t };
+                t->run();
+                increment( to.completed);
+            }}.detach();
+        } catch (...) {
+            increment( to.completed);
+            throw;
+        }
+        guard.release();
+        return;
+    }
+    ring_type & ring = * rings_[this_shard_.index * size_ + index];
+    guard.release();
+    bool was_empty = false;
+    while ( ! ring.push( t, was_empty) ) {
+        // ring is full: let the dispatcher of this shard drain the rings
+        // it receives from, the target shard might wait for them
+        this_fiber::yield();
+    }
+    if ( was_empty && ! busy_poll_) {
+        // the target shard might wait for ready fibers
+        to.sched->notify();
+    }
+}
+
+void
+sharded::stop_() noexcept {
+    for ( std::unique_ptr< shard > & s : shards_) {
+        s->stop.set_value();
+    }
+    for ( std::unique_ptr< shard > & s : shards_) {
+        if ( s->thread.joinable() ) {
+            s->thread.join();
+        }
+    }
+    // tasks not executed (threads failed to start)
+    for ( std::unique_ptr< ring_type > & ring : rings_) {
+        detail::shard_task * t = nullptr;
+        while ( ring && ring->pop( t) ) {
+            delete t;
+        }
+    }
+}
+
+sharded::sharded( std::size_t size, bool pin, bool busy_poll, std::size_t capacity) :
+    size_{ size },
+    pin_{ pin },
+    busy_poll_{ busy_poll } {
+    if ( 0 == size_) {
+        throw fiber_error{
+                std::make_error_code( std::errc::invalid_argument),
+                "boost fiber: sharded runtime requires at least one shard" };
+    }
+    if ( 0 == capacity || 0 != ( capacity & ( capacity - 1) ) ) {
+        throw fiber_error{
+                std::make_error_code( std::errc::invalid_argument),
+                "boost fiber: ring capacity must be power of 2" };
+    }
+    rings_.resize( size_ * size_);
+    for ( std::size_t from = 0; from < size_; ++from) {
+        for ( std::size_t to = 0; to < size_; ++to) {
+            if ( from != to) {
+                rings_[from * size_ + to].reset( new ring_type{ capacity });
+            }
+        }
+    }
+    shards_.reserve( size_);
+    for ( std::size_t i = 0; i < size_; ++i) {
+        shards_.emplace_back( new shard{});
+    }
+    try {
+        for ( std::size_t i = 0; i < size_; ++i) {
+            shards_[i]->thread = std::thread{ & sharded::run_, this, i };
+        }
+    } catch (...) {
+        stop_();
+        throw;
+    }
+    // submit_to() requires the schedulers of all shards
+    for ( std::unique_ptr< shard > & s : shards_) {
+        std::unique_lock< std::mutex > lk( s->mtx);
+        s->cnd.wait( lk, [&s](){ return s->started; });
+    }
+}
+
+sharded::~sharded() {
+    BOOST_ASSERT( this != this_shard_.owner);
+    stop_();
+}
+
+std::size_t
+sharded::this_shard() noexcept {
+    return this_shard_.index;
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
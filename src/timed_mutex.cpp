@@ -10,6 +10,7 @@
 #include <functional>
 
 #include "boost/fiber/exceptions.hpp"
+#include "boost/fiber/observer.hpp"
 #include "boost/fiber/scheduler.hpp"
 
 #ifdef BOOST_HAS_ABI_HEADERS
@@ -21,7 +22,7 @@ namespace fibers {
 
 bool
 timed_mutex::try_lock_until_( std::chrono::steady_clock::time_point const& timeout_time) noexcept {
-    if ( std::chrono::steady_clock::now() > timeout_time) {
+    if ( detail::now() > timeout_time) {
         return false;
     }
     context * ctx = context::active();
@@ -33,6 +34,7 @@ timed_mutex::try_lock_until_( std::chrono::steady_clock::time_point const& timeo
     }
     BOOST_ASSERT( ! ctx->wait_is_linked() );
     ctx->wait_link( wait_queue_);
+    detail::observe( event_type::block, ctx, ctx, block_reason::mutex, this, BOOST_FIBERS_CALLER);
     // suspend this fiber until notified or timed-out
     if ( ! context::active()->wait_until( timeout_time, lk) ) {
         // remove fiber from wait-queue 
@@ -59,6 +61,7 @@ timed_mutex::lock() {
     }
     BOOST_ASSERT( ! ctx->wait_is_linked() );
     ctx->wait_link( wait_queue_);
+    detail::observe( event_type::block, ctx, ctx, block_reason::mutex, this, BOOST_FIBERS_CALLER);
     // suspend this fiber
     ctx->suspend( lk);
     BOOST_ASSERT( ! ctx->wait_is_linked() );
@@ -0,0 +1,361 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/tracer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <map>
+#include <new>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+struct tracer::buffer {
+    std::size_t                     index;
+    std::size_t                     mask;
+    std::unique_ptr< slot[] >       records;
+    std::atomic< std::uint64_t >    head{ 0 };
+
+    buffer( std::size_t index_, std::size_t capacity) :
+        index{ index_ },
+        mask{ capacity - 1 },
+        records{ new slot[capacity] } {
+    }
+};
+
+namespace {
+
+std::atomic< std::uint64_t > serials{ 0 };
+
+// buffer of the calling thread; serial identifies the tracer
+struct cache_t {
+    std::uint64_t       serial{ 0 };
+    void            *   buf{ nullptr };
+};
+
+thread_local cache_t cache{};
+
+// state of a fiber while the trace is written
+struct track {
+    std::size_t     tid;
+    bool            terminated{ false };
+    // start of the current slices, negative if none
+    double          running{ -1. };
+    std::size_t     thread{ 0 };
+    double          blocked{ -1. };
+    block_reason    reason{ block_reason::none };
+    void const  *   object{ nullptr };
+    double          ready{ -1. };
+    std::uint64_t   flow{ 0 };
+
+    explicit track( std::size_t tid_) noexcept :
+        tid{ tid_ } {
+    }
+};
+
+class writer {
+private:
+    std::ostream    &   os_;
+    bool                first_{ true };
+
+public:
+    explicit writer( std::ostream & os) :
+        os_{ os } {
+        os_ << std::fixed << std::setprecision( 3) << "{\"traceEvents\":[";
+    }
+
+    ~writer() {
+        os_ << "\n],\"displayTimeUnit\":\"ns\"}\n";
+    }
+
+    std::ostream & begin( char const* ph, std::size_t tid, double ts) {
+        os_ << ( first_ ? "\n" : ",\n") << "{\"ph\":\"" << ph << "\",\"pid\":1,\"tid\":" << tid
+            << ",\"ts\":" << ts;
+        first_ = false;
+        return os_;
+    }
+
+    void slice( std::size_t tid, double from, double to, std::string const& name, std::string const& args) {
+        begin( "X", tid, from) << ",\"dur\":" << ( std::max)( 0., to - from)
+            << ",\"name\":\"" << name << "\",\"args\":{" << args << "}}";
+    }
+
+    void flow( char const* ph, std::size_t tid, double ts, std::uint64_t id) {
+        begin( ph, tid, ts) << ",\"id\":" << id << ",\"name\":\"wake\",\"cat\":\"wake\""
+            << ( 'f' == ph[0] ? ",\"bp\":\"e\"" : "") << "}";
+    }
+
+    void instant( std::size_t tid, double ts, std::string const& name) {
+        begin( "i", tid, ts) << ",\"s\":\"t\",\"name\":\"" << name << "\"}";
+    }
+
+    void thread_name( std::size_t tid, std::string const& name) {
+        begin( "M", tid, 0.) << ",\"name\":\"thread_name\",\"args\":{\"name\":\"" << name << "\"}}";
+    }
+};
+
+std::string thread_args( std::size_t thread) {
+    std::ostringstream os;
+    os << "\"thread\":" << thread;
+    return os.str();
+}
+
+std::string object_args( void const* object) {
+    if ( nullptr == object) {
+        return std::string{};
+    }
+    std::ostringstream os;
+    os << "\"object\":\"" << object << "\"";
+    return os.str();
+}
+
+}
+
+tracer::buffer *
+tracer::register_() noexcept {
+    std::unique_lock< std::mutex > lk( mtx_);
+    buffer * b = nullptr;
+    try {
+        buffers_.emplace_back( new buffer{ buffers_.size(), capacity_ } );
+        b = buffers_.back().get();
+    } catch (...) {
+        return nullptr;
+    }
+    cache.serial = serial_;
+    cache.buf = b;
+    return b;
+}
+
+tracer::tracer( std::size_t capacity) :
+    observer{ false },
+    capacity_{ 1 },
+    serial_{ ++serials } {
+    while ( capacity_ < capacity) {
+        capacity_ <<= 1;
+    }
+}
+
+tracer::~tracer() {
+    stop();
+}
+
+void
+tracer::start() noexcept {
+    if ( ! running_) {
+        running_ = true;
+        started_ = detail::tsc_sample{};
+        previous_ = set_observer( this);
+    }
+}
+
+void
+tracer::stop() noexcept {
+    if ( running_) {
+        set_observer( previous_);
+        stopped_ = detail::tsc_sample{};
+        running_ = false;
+    }
+}
+
+// stores an event into the ring buffer of the calling thread, the TSC is
+// read only here
+void
+tracer::record_( event_type type, context::id id, context::id from,
+                 block_reason reason, void const * object) noexcept {
+    buffer * b = static_cast< buffer * >( cache.buf);
+    if ( BOOST_UNLIKELY( serial_ != cache.serial) ) {
+        b = register_();
+        if ( nullptr == b) {
+            return;
+        }
+    }
+    // single writer
+    std::uint64_t head = b->head.load( std::memory_order_relaxed);
+    slot & r = b->records[head & b->mask];
+    r.ticks = detail::tsc();
+    r.id = id;
+    r.from = from;
+    r.object = object;
+    r.type = type;
+    r.reason = reason;
+    b->head.store( head + 1, std::memory_order_release);
+}
+
+void
+tracer::record( event_type type, context * ctx, context * from,
+                block_reason reason, void const * object, void const *) noexcept {
+    record_( type, context::id{ ctx }, context::id{ from }, reason, object);
+}
+
+void
+tracer::on_event( event const& e) noexcept {
+    record_( e.type, e.id, e.from, e.reason, e.object);
+}
+
+std::size_t
+tracer::size() const noexcept {
+    std::unique_lock< std::mutex > lk( mtx_);
+    std::size_t n = 0;
+    for ( std::unique_ptr< buffer > const& b : buffers_) {
+        n += static_cast< std::size_t >( b->head.load( std::memory_order_acquire) );
+    }
+    return n;
+}
+
+std::size_t
+tracer::overwritten() const noexcept {
+    std::unique_lock< std::mutex > lk( mtx_);
+    std::size_t n = 0;
+    for ( std::unique_ptr< buffer > const& b : buffers_) {
+        std::uint64_t head = b->head.load( std::memory_order_acquire);
+        if ( capacity_ < head) {
+            n += static_cast< std::size_t >( head - capacity_);
+        }
+    }
+    return n;
+}
+
+void
+tracer::write( std::ostream & os) const {
+    typedef std::pair< std::size_t, slot >      entry_t;
+    std::vector< entry_t > entries;
+    {
+        std::unique_lock< std::mutex > lk( mtx_);
+        for ( std::unique_ptr< buffer > const& b : buffers_) {
+            std::uint64_t head = b->head.load( std::memory_order_acquire);
+            std::uint64_t first = capacity_ < head ? head - capacity_ : 0;
+            for ( std::uint64_t i = first; i < head; ++i) {
+                entries.emplace_back( b->index, b->records[i & b->mask]);
+            }
+        }
+    }
+    // the TSC is synchronized between the cores
+    std::stable_sort( entries.begin(), entries.end(),
+                      []( entry_t const& l, entry_t const& r){
+                          return l.second.ticks < r.second.ticks; });
+    double rate = detail::tsc_rate( started_, running_ ? detail::tsc_sample{} : stopped_);
+    std::uint64_t base = entries.empty() ? 0 : entries.front().second.ticks;
+    auto us = [rate,base]( std::uint64_t ticks){
+        return static_cast< double >( ticks - base) / rate / 1000.;
+    };
+    writer w{ os };
+    std::map< context::id, track > tracks;
+    std::size_t tids = 0;
+    std::uint64_t flows = 0;
+    auto get = [&]( context::id id, bool spawn) -> track & {
+        std::map< context::id, track >::iterator i = tracks.find( id);
+        if ( tracks.end() == i || ( spawn && i->second.terminated) ) {
+            // context addresses are reused by new fibers
+            track t{ ++tids };
+            std::ostringstream name;
+            name << "fiber " << t.tid << " (" << id << ")";
+            w.thread_name( t.tid, name.str() );
+            if ( tracks.end() != i) {
+                i->second = t;
+            } else {
+                i = tracks.emplace( id, t).first;
+            }
+        }
+        return i->second;
+    };
+    double end = 0.;
+    for ( entry_t const& entry : entries) {
+        slot const& r = entry.second;
+        double ts = us( r.ticks);
+        end = ts;
+        switch ( r.type) {
+        case event_type::resume: {
+            if ( r.from) {
+                track & prev = get( r.from, false);
+                if ( 0. <= prev.running) {
+                    std::ostringstream name;
+                    name << "thread " << prev.thread;
+                    w.slice( prev.tid, prev.running, ts, name.str(), thread_args( prev.thread) );
+                    prev.running = -1.;
+                }
+            }
+            track & t = get( r.id, false);
+            if ( 0. <= t.blocked) {
+                // the wakeup has been overwritten
+                w.slice( t.tid, t.blocked, ts, std::string{ "blocked: " } + detail::reason_name( t.reason),
+                         object_args( t.object) );
+                t.blocked = -1.;
+            }
+            if ( 0. <= t.ready) {
+                w.slice( t.tid, t.ready, ts, "ready", "");
+                if ( 0 != t.flow) {
+                    w.flow( "f", t.tid, ts, t.flow);
+                }
+                t.ready = -1.;
+            }
+            t.running = ts;
+            t.thread = entry.first;
+            break;
+        }
+        case event_type::spawn:
+        case event_type::ready:
+        case event_type::remote_ready: {
+            track & t = get( r.id, event_type::spawn == r.type);
+            if ( 0. <= t.blocked) {
+                w.slice( t.tid, t.blocked, ts, std::string{ "blocked: " } + detail::reason_name( t.reason),
+                         object_args( t.object) );
+                t.blocked = -1.;
+            }
+            t.ready = ts;
+            if ( r.from) {
+                track & waker = get( r.from, false);
+                t.flow = ++flows;
+                w.flow( "s", waker.tid, ts, t.flow);
+            } else {
+                t.flow = 0;
+            }
+            break;
+        }
+        case event_type::block: {
+            track & t = get( r.id, false);
+            t.blocked = ts;
+            t.reason = r.reason;
+            t.object = r.object;
+            break;
+        }
+        case event_type::terminate: {
+            get( r.id, false).terminated = true;
+            break;
+        }
+        case event_type::steal: {
+            std::ostringstream name;
+            name << "stolen by thread " << entry.first;
+            w.instant( get( r.id, false).tid, ts, name.str() );
+            break;
+        }
+        }
+    }
+    // close the slices still open
+    for ( std::map< context::id, track >::value_type & v : tracks) {
+        track & t = v.second;
+        if ( 0. <= t.running) {
+            std::ostringstream name;
+            name << "thread " << t.thread;
+            w.slice( t.tid, t.running, end, name.str(), thread_args( t.thread) );
+        }
+    }
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,171 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+void test_send() {
+    std::vector< int > values;
+    {
+        boost::fibers::actor< int > a( [&values]( int && i){
+            values.push_back( i);
+        });
+        for ( int i = 0; i < 10; ++i) {
+            a.send( i);
+        }
+    }
+    // destructor processes the pending messages
+    BOOST_REQUIRE_EQUAL( 10u, values.size() );
+    for ( int i = 0; i < 10; ++i) {
+        BOOST_CHECK_EQUAL( i, values[i]);
+    }
+}
+
+void test_move_only() {
+    int sum = 0;
+    {
+        boost::fibers::actor< std::unique_ptr< int > > a( [&sum]( std::unique_ptr< int > && p){
+            sum += * p;
+        });
+        a.send( std::unique_ptr< int >( new int( 3) ) );
+        a.emplace( new int( 4) );
+    }
+    BOOST_CHECK_EQUAL( 7, sum);
+}
+
+void test_batch() {
+    // the actor yields after each batch: the other fibers continue to run
+    std::vector< std::string > trace;
+    boost::fibers::actor< int > a( [&trace]( int &&){
+            trace.push_back( "a");
+        }, 2);
+    for ( int i = 0; i < 6; ++i) {
+        a.send( i);
+    }
+    boost::fibers::fiber f( [&trace](){
+        for ( int i = 0; i < 2; ++i) {
+            trace.push_back( "f");
+            boost::this_fiber::yield();
+        }
+    });
+    f.join();
+    a.close();
+    a.join();
+    BOOST_REQUIRE_EQUAL( 8u, trace.size() );
+    BOOST_CHECK_EQUAL( "a", trace[0]);
+    BOOST_CHECK_EQUAL( "a", trace[1]);
+    BOOST_CHECK_EQUAL( "f", trace[2]);
+    BOOST_CHECK_EQUAL( "a", trace[3]);
+}
+
+void test_closed() {
+    boost::fibers::actor< int > a( []( int &&){});
+    a.close();
+    BOOST_CHECK( a.is_closed() );
+    BOOST_CHECK_THROW( a.send( 1), boost::fibers::fiber_error);
+}
+
+void test_ping_pong() {
+    const int n = 1000;
+    int pongs = 0;
+    boost::fibers::actor< int > * pong_ptr = nullptr;
+    boost::fibers::actor< int > ping( [&pong_ptr,&pongs]( int && i){
+        ++pongs;
+        if ( 0 < i) {
+            pong_ptr->send( i - 1);
+        }
+    });
+    boost::fibers::actor< int > pong( [&ping]( int && i){
+        ping.send( i);
+    });
+    pong_ptr = & pong;
+    pong.send( n);
+    while ( pongs <= n) {
+        boost::this_fiber::yield();
+    }
+    BOOST_CHECK_EQUAL( n + 1, pongs);
+}
+
+void test_threads() {
+    // senders running in other threads, the actor waits for messages
+    const int n = 4, m = 10000;
+    long sum = 0;
+    {
+        boost::fibers::actor< int > a( [&sum]( int && i){
+            sum += i;
+        });
+        std::vector< std::thread > threads;
+        for ( int i = 0; i < n; ++i) {
+            threads.emplace_back([&a](){
+                for ( int j = 1; j <= m; ++j) {
+                    a.send( j);
+                    if ( 0 == j % 100) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        for ( std::thread & t : threads) {
+            t.join();
+        }
+    }
+    BOOST_CHECK_EQUAL( static_cast< long >( n) * m * ( m + 1) / 2, sum);
+}
+
+void test_pinned() {
+    // the actor runs in the thread of the scheduler it is pinned to
+    std::atomic< boost::fibers::scheduler * > sched{ nullptr };
+    std::atomic< bool > done{ false };
+    std::thread::id id;
+    std::thread t([&sched,&done,&id](){
+        id = std::this_thread::get_id();
+        sched = boost::fibers::context::active()->get_scheduler();
+        while ( ! done) {
+            boost::this_fiber::sleep_for( std::chrono::milliseconds( 1) );
+        }
+    });
+    while ( nullptr == sched.load() ) {
+        std::this_thread::yield();
+    }
+    std::vector< std::thread::id > ids;
+    {
+        boost::fibers::actor< int > a( boost::fibers::scheduler_handle{ sched.load() },
+                                       [&ids]( int &&){
+                                           ids.push_back( std::this_thread::get_id() );
+                                       });
+        for ( int i = 0; i < 10; ++i) {
+            a.send( i);
+        }
+    }
+    done = true;
+    t.join();
+    BOOST_REQUIRE_EQUAL( 10u, ids.size() );
+    for ( std::thread::id const& i : ids) {
+        BOOST_CHECK( id == i);
+    }
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: actor test suite");
+
+    test->add( BOOST_TEST_CASE( & test_send) );
+    test->add( BOOST_TEST_CASE( & test_move_only) );
+    test->add( BOOST_TEST_CASE( & test_batch) );
+    test->add( BOOST_TEST_CASE( & test_closed) );
+    test->add( BOOST_TEST_CASE( & test_ping_pong) );
+    test->add( BOOST_TEST_CASE( & test_threads) );
+    test->add( BOOST_TEST_CASE( & test_pinned) );
+
+    return test;
+}
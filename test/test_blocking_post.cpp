@@ -0,0 +1,150 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+int add( int a, int b) {
+    return a + b;
+}
+
+void test_value() {
+    int result = 0;
+    boost::fibers::fiber f( boost::fibers::launch::post, [&result](){
+        result = boost::fibers::blocking( add, 3, 4);
+    });
+    f.join();
+    BOOST_CHECK_EQUAL( 7, result);
+}
+
+void test_void() {
+    std::thread::id id;
+    boost::fibers::fiber f( boost::fibers::launch::post, [&id](){
+        boost::fibers::blocking( [&id](){ id = std::this_thread::get_id(); });
+    });
+    f.join();
+    BOOST_CHECK( std::thread::id() != id);
+    BOOST_CHECK( std::this_thread::get_id() != id);
+}
+
+void test_move_only() {
+    std::unique_ptr< int > result;
+    boost::fibers::fiber f( boost::fibers::launch::post, [&result](){
+        std::unique_ptr< int > p( new int( 3) );
+        result = boost::fibers::blocking(
+            []( std::unique_ptr< int > p) { * p += 1; return p; },
+            std::move( p) );
+    });
+    f.join();
+    BOOST_REQUIRE( result);
+    BOOST_CHECK_EQUAL( 4, * result);
+}
+
+void test_exception() {
+    bool thrown = false;
+    boost::fibers::fiber f( boost::fibers::launch::post, [&thrown](){
+        try {
+            boost::fibers::blocking( []() -> int { throw std::runtime_error("abc"); });
+        } catch ( std::runtime_error const& ex) {
+            thrown = std::string("abc") == ex.what();
+        }
+    });
+    f.join();
+    BOOST_CHECK( thrown);
+}
+
+void test_other_fibers_run() {
+    // while one fiber blocks in the pool, the other fibers of the thread
+    // continue to run
+    std::atomic< bool > released{ false };
+    int ticks = 0;
+    boost::fibers::fiber blocker( boost::fibers::launch::post, [&released](){
+        boost::fibers::blocking( [&released](){
+            while ( ! released) {
+                std::this_thread::sleep_for( std::chrono::milliseconds( 1) );
+            }
+        });
+    });
+    boost::fibers::fiber ticker( boost::fibers::launch::post, [&ticks,&released](){
+        for ( int i = 0; i < 10; ++i) {
+            ++ticks;
+            boost::this_fiber::sleep_for( std::chrono::milliseconds( 1) );
+        }
+        released = true;
+    });
+    ticker.join();
+    blocker.join();
+    BOOST_CHECK_EQUAL( 10, ticks);
+}
+
+void test_many() {
+    const int n = 100;
+    std::atomic< int > sum{ 0 };
+    std::vector< boost::fibers::fiber > fibers;
+    for ( int i = 0; i < n; ++i) {
+        fibers.emplace_back( boost::fibers::launch::post, [i,&sum](){
+            sum += boost::fibers::blocking( [i](){
+                std::this_thread::sleep_for( std::chrono::microseconds( 100) );
+                return i;
+            });
+        });
+    }
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    BOOST_CHECK_EQUAL( n * ( n - 1) / 2, sum.load() );
+}
+
+void test_grow() {
+    // an idle thread of the pool takes only one of the concurrent calls,
+    // the pool grows for the others; the first call leaves one idle thread
+    boost::fibers::blocking( [](){});
+    const int n = 8;
+    std::vector< boost::fibers::fiber > fibers;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for ( int i = 0; i < n; ++i) {
+        fibers.emplace_back( boost::fibers::launch::post, [](){
+            boost::fibers::blocking( [](){
+                std::this_thread::sleep_for( std::chrono::milliseconds( 50) );
+            });
+        });
+    }
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    // serialized the calls take 400ms
+    BOOST_CHECK( std::chrono::milliseconds( 200) > std::chrono::steady_clock::now() - start);
+}
+
+void test_max_threads() {
+    BOOST_CHECK_THROW( boost::fibers::set_blocking_max_threads( 0), boost::fibers::fiber_error);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: blocking test suite");
+
+    // first: requires a pool with a single idle thread
+    test->add( BOOST_TEST_CASE( & test_grow) );
+    test->add( BOOST_TEST_CASE( & test_value) );
+    test->add( BOOST_TEST_CASE( & test_void) );
+    test->add( BOOST_TEST_CASE( & test_move_only) );
+    test->add( BOOST_TEST_CASE( & test_exception) );
+    test->add( BOOST_TEST_CASE( & test_other_fibers_run) );
+    test->add( BOOST_TEST_CASE( & test_many) );
+    test->add( BOOST_TEST_CASE( & test_max_threads) );
+
+    return test;
+}
@@ -5,8 +5,11 @@
 //          http://www.boost.org/LICENSE_1_0.txt)
 
 #include <chrono>
+#include <cstdint>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <boost/assert.hpp>
@@ -230,6 +233,35 @@ void test_try_pop_success() {
     BOOST_CHECK_EQUAL( v1, v2);
 }
 
+void test_try_push_wakes_consumer() {
+    boost::fibers::buffered_channel< int > c( 16);
+    int v = 0;
+    boost::fibers::fiber f1( boost::fibers::launch::post, [&c,&v](){
+        BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop( v) );
+    });
+    boost::fibers::fiber f2( boost::fibers::launch::post, [&c](){
+        BOOST_CHECK( boost::fibers::channel_op_status::success == c.try_push( 7) );
+    });
+    f1.join();
+    f2.join();
+    BOOST_CHECK_EQUAL( 7, v);
+}
+
+void test_try_pop_wakes_producer() {
+    boost::fibers::buffered_channel< int > c( 2);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( 1) );
+    int v = 0;
+    boost::fibers::fiber f1( boost::fibers::launch::post, [&c](){
+        BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( 2) );
+    });
+    boost::fibers::fiber f2( boost::fibers::launch::post, [&c,&v](){
+        BOOST_CHECK( boost::fibers::channel_op_status::success == c.try_pop( v) );
+    });
+    f1.join();
+    f2.join();
+    BOOST_CHECK_EQUAL( 1, v);
+}
+
 void test_pop_wait_for() {
     boost::fibers::buffered_channel< int > c( 16);
     int v1 = 2, v2 = 0;
@@ -491,6 +523,91 @@ void test_rangefor() {
     BOOST_CHECK_EQUAL( 12, vec[6]);
 }
 
+void test_inline() {
+    boost::fibers::buffered_channel< int, 2 > c;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.try_push( 1) );
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.try_push( 2) );
+    BOOST_CHECK( boost::fibers::channel_op_status::full == c.try_push( 3) );
+    BOOST_CHECK_EQUAL( 1, c.value_pop() );
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( 3) );
+    int value = 0;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop( value) );
+    BOOST_CHECK_EQUAL( 2, value);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop( value) );
+    BOOST_CHECK_EQUAL( 3, value);
+    c.close();
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == c.pop( value) );
+}
+
+void test_inline_wm() {
+    boost::fibers::buffered_channel< int, 4 > c;
+    int sum = 0;
+    boost::fibers::fiber f1( boost::fibers::launch::post, [&c](){
+        for ( int i = 1; i <= 100; ++i) {
+            BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( i) );
+        }
+        c.close();
+    });
+    boost::fibers::fiber f2( boost::fibers::launch::post, [&c,&sum](){
+        for ( int value : c) {
+            sum += value;
+        }
+    });
+    f1.join();
+    f2.join();
+    BOOST_CHECK_EQUAL( 5050, sum);
+}
+
+void test_inline_destroys_values() {
+    std::shared_ptr< int > p = std::make_shared< int >( 7);
+    {
+        boost::fibers::buffered_channel< std::shared_ptr< int >, 4 > c;
+        BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( p) );
+        BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( p) );
+        BOOST_CHECK_EQUAL( 3, p.use_count() );
+    }
+    BOOST_CHECK_EQUAL( 1, p.use_count() );
+}
+
+void test_dense() {
+    typedef boost::fibers::buffered_channel<
+        std::uint64_t, 16, boost::fibers::slot_layout::dense
+    >                                                       dense_type;
+    typedef boost::fibers::buffered_channel< std::uint64_t, 16 >   padded_type;
+    BOOST_CHECK( sizeof( dense_type) < sizeof( padded_type) );
+    dense_type c;
+    std::uint64_t sum = 0;
+    // producer in another thread
+    std::thread t([&c](){
+        for ( std::uint64_t i = 1; i <= 10000; ++i) {
+            c.push( i);
+        }
+        c.close();
+    });
+    std::uint64_t value = 0;
+    while ( boost::fibers::channel_op_status::success == c.pop( value) ) {
+        sum += value;
+    }
+    t.join();
+    BOOST_CHECK_EQUAL( 50005000u, sum);
+}
+
+void test_dense_runtime_capacity() {
+    boost::fibers::buffered_channel< int, 0, boost::fibers::slot_layout::dense > c( 2);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.try_push( 1) );
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.try_push( 2) );
+    BOOST_CHECK( boost::fibers::channel_op_status::full == c.try_push( 3) );
+    BOOST_CHECK_EQUAL( 1, c.value_pop() );
+    BOOST_CHECK_EQUAL( 2, c.value_pop() );
+    bool thrown = false;
+    try {
+        boost::fibers::buffered_channel< int, 0, boost::fibers::slot_layout::dense > c( 3);
+    } catch ( boost::fibers::fiber_error const&) {
+        thrown = true;
+    }
+    BOOST_CHECK( thrown);
+}
+
 boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
     boost::unit_test::test_suite * test =
         BOOST_TEST_SUITE("Boost.Fiber: buffered_channel test suite");
@@ -516,6 +633,8 @@ boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
      test->add( BOOST_TEST_CASE( & test_try_pop) );
      test->add( BOOST_TEST_CASE( & test_try_pop_closed) );
      test->add( BOOST_TEST_CASE( & test_try_pop_success) );
+     test->add( BOOST_TEST_CASE( & test_try_push_wakes_consumer) );
+     test->add( BOOST_TEST_CASE( & test_try_pop_wakes_producer) );
      test->add( BOOST_TEST_CASE( & test_pop_wait_for) );
      test->add( BOOST_TEST_CASE( & test_pop_wait_for_closed) );
      test->add( BOOST_TEST_CASE( & test_pop_wait_for_success) );
@@ -528,6 +647,11 @@ boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
      test->add( BOOST_TEST_CASE( & test_wm_2) );
      test->add( BOOST_TEST_CASE( & test_moveable) );
      test->add( BOOST_TEST_CASE( & test_rangefor) );
+     test->add( BOOST_TEST_CASE( & test_inline) );
+     test->add( BOOST_TEST_CASE( & test_inline_wm) );
+     test->add( BOOST_TEST_CASE( & test_inline_destroys_values) );
+     test->add( BOOST_TEST_CASE( & test_dense) );
+     test->add( BOOST_TEST_CASE( & test_dense_runtime_capacity) );
 
     return test;
 }
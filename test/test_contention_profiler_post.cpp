@@ -0,0 +1,152 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+typedef std::vector< boost::fibers::contention_record > records_t;
+
+boost::fibers::contention_record const* find( records_t const& records, void const* object) {
+    for ( boost::fibers::contention_record const& r : records) {
+        if ( object == r.object) {
+            return & r;
+        }
+    }
+    return nullptr;
+}
+
+void test_empty() {
+    boost::fibers::contention_profiler p;
+    BOOST_CHECK( p.top().empty() );
+    std::ostringstream os;
+    p.report( os);
+    BOOST_CHECK( std::string::npos != os.str().find("total[us]") );
+}
+
+void test_mutex() {
+    boost::fibers::contention_profiler p;
+    boost::fibers::mutex mtx;
+    p.name( & mtx, "mtx");
+    p.start();
+    boost::fibers::fiber f( [&mtx](){
+        for ( int i = 0; i < 5; ++i) {
+            std::unique_lock< boost::fibers::mutex > lk( mtx);
+            boost::this_fiber::sleep_for( std::chrono::milliseconds( 1) );
+        }
+    });
+    boost::this_fiber::yield();
+    {
+        // f holds the mutex while sleeping
+        std::unique_lock< boost::fibers::mutex > lk( mtx);
+    }
+    f.join();
+    p.stop();
+    records_t records = p.top();
+    // waits are recorded only if the library is built with BOOST_FIBERS_HOOKS
+#if defined(BOOST_FIBERS_HOOKS)
+    BOOST_REQUIRE( ! records.empty() );
+#else
+    if ( records.empty() ) {
+        return;
+    }
+#endif
+    boost::fibers::contention_record const* r = find( records, & mtx);
+    BOOST_REQUIRE( nullptr != r);
+    BOOST_CHECK( boost::fibers::block_reason::mutex == r->reason);
+    BOOST_CHECK_EQUAL( std::string{ "mtx" }, r->name);
+    BOOST_CHECK( 1u <= r->count);
+    BOOST_CHECK( std::chrono::microseconds( 500) <= r->total);
+    BOOST_CHECK( r->max <= r->total);
+    // sleeping is not contention
+    for ( boost::fibers::contention_record const& rec : records) {
+        BOOST_CHECK( boost::fibers::block_reason::sleep != rec.reason);
+    }
+    std::ostringstream os;
+    p.report( os);
+    BOOST_CHECK( std::string::npos != os.str().find("(mtx)") );
+    p.reset();
+    BOOST_CHECK( p.top().empty() );
+}
+
+void test_call_sites() {
+    boost::fibers::contention_profiler p;
+    boost::fibers::buffered_channel< int > chan{ 2 };
+    p.start();
+    boost::fibers::fiber f1( [&chan](){
+        int value = 0;
+        chan.pop( value);
+    });
+    boost::fibers::fiber f2( [&chan](){
+        int value = 0;
+        chan.pop( value);
+        chan.pop( value);
+    });
+    boost::this_fiber::yield();
+    chan.push( 1);
+    chan.push( 2);
+    chan.push( 3);
+    f1.join();
+    f2.join();
+    p.stop();
+    records_t records = p.top();
+    if ( records.empty() ) {
+        return;
+    }
+    std::size_t pops = 0, sites = 0;
+    for ( boost::fibers::contention_record const& r : records) {
+        // main might block in push()
+        if ( & chan == r.object && boost::fibers::block_reason::channel_pop == r.reason) {
+            pops += r.count;
+            ++sites;
+        }
+    }
+    BOOST_CHECK( 2u <= pops);
+#if defined(BOOST_GCC) || defined(BOOST_CLANG) || defined(BOOST_MSVC)
+    // the lambdas of f1 and f2 are different call sites
+    BOOST_CHECK( 2u <= sites);
+    for ( boost::fibers::contention_record const& r : records) {
+        BOOST_CHECK( nullptr != r.caller);
+    }
+#endif
+    // top( n) keeps the n longest waits
+    BOOST_CHECK( 1u == p.top( 1).size() );
+}
+
+void test_join() {
+    boost::fibers::contention_profiler p;
+    p.start();
+    boost::fibers::fiber f( [](){
+        boost::this_fiber::sleep_for( std::chrono::milliseconds( 1) );
+    });
+    f.join();
+    p.stop();
+    records_t records = p.top();
+    if ( records.empty() ) {
+        return;
+    }
+    BOOST_REQUIRE_EQUAL( 1u, records.size() );
+    BOOST_CHECK( boost::fibers::block_reason::join == records[0].reason);
+    BOOST_CHECK_EQUAL( 1u, records[0].count);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: contention profiler test suite");
+
+    test->add( BOOST_TEST_CASE( & test_empty) );
+    test->add( BOOST_TEST_CASE( & test_mutex) );
+    test->add( BOOST_TEST_CASE( & test_call_sites) );
+    test->add( BOOST_TEST_CASE( & test_join) );
+
+    return test;
+}
@@ -0,0 +1,241 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+#include <boost/fiber/coroutine.hpp>
+
+#if defined(BOOST_FIBERS_HAS_COROUTINES)
+
+boost::fibers::task< int > add( int a, int b) {
+    co_return a + b;
+}
+
+boost::fibers::task< int > nested() {
+    int x = co_await add( 1, 2);
+    int y = co_await add( x, 3);
+    co_return y;
+}
+
+boost::fibers::task<> throws() {
+    throw std::runtime_error("abc");
+    co_return;
+}
+
+boost::fibers::task< int > await_future( boost::fibers::future< int > f) {
+    co_return co_await std::move( f);
+}
+
+void test_spawn() {
+    BOOST_CHECK_EQUAL( 3, boost::fibers::spawn( add( 1, 2) ).get() );
+    BOOST_CHECK_EQUAL( 6, boost::fibers::spawn( nested() ).get() );
+}
+
+void test_exception() {
+    boost::fibers::future< void > f = boost::fibers::spawn( throws() );
+    BOOST_CHECK_THROW( f.get(), std::runtime_error);
+}
+
+void test_move_only() {
+    auto make = []() -> boost::fibers::task< std::unique_ptr< int > > {
+        co_return std::unique_ptr< int >{ new int( 7) };
+    };
+    std::unique_ptr< int > p = boost::fibers::spawn( make() ).get();
+    BOOST_REQUIRE( p);
+    BOOST_CHECK_EQUAL( 7, * p);
+}
+
+void test_await_future_local() {
+    // the future is made ready by a fiber of the same thread
+    boost::fibers::promise< int > p;
+    boost::fibers::future< int > f = boost::fibers::spawn( await_future( p.get_future() ) );
+    boost::fibers::fiber( [&p](){
+        boost::this_fiber::sleep_for( std::chrono::milliseconds( 10) );
+        p.set_value( 5);
+    }).join();
+    BOOST_CHECK_EQUAL( 5, f.get() );
+}
+
+void test_await_future_ready() {
+    boost::fibers::promise< int > p;
+    p.set_value( 9);
+    BOOST_CHECK_EQUAL( 9, boost::fibers::spawn( await_future( p.get_future() ) ).get() );
+}
+
+void test_await_future_remote() {
+    // the coroutine is resumed through the remote ready-queue
+    boost::fibers::promise< int > p;
+    boost::fibers::future< int > f = boost::fibers::spawn( await_future( p.get_future() ) );
+    std::thread t( [&p](){
+        std::this_thread::sleep_for( std::chrono::milliseconds( 10) );
+        p.set_value( 11);
+    });
+    BOOST_CHECK_EQUAL( 11, f.get() );
+    t.join();
+}
+
+void test_await_future_exception() {
+    boost::fibers::promise< int > p;
+    boost::fibers::future< int > f = boost::fibers::spawn( await_future( p.get_future() ) );
+    p.set_exception( std::make_exception_ptr( std::runtime_error("abc") ) );
+    BOOST_CHECK_THROW( f.get(), std::runtime_error);
+}
+
+boost::fibers::task< int > consume( boost::fibers::buffered_channel< int > & chan) {
+    int sum = 0, value = 0;
+    while ( boost::fibers::channel_op_status::success ==
+            co_await boost::fibers::async_pop( chan, value) ) {
+        sum += value;
+    }
+    co_return sum;
+}
+
+boost::fibers::task< std::string > consume_unbuffered( boost::fibers::unbuffered_channel< std::string > & chan) {
+    std::string result, value;
+    while ( boost::fibers::channel_op_status::success ==
+            co_await boost::fibers::async_pop( chan, value) ) {
+        result += value;
+    }
+    co_return result;
+}
+
+void test_channel() {
+    boost::fibers::buffered_channel< int > chan{ 4 };
+    boost::fibers::future< int > f = boost::fibers::spawn( consume( chan) );
+    boost::fibers::fiber( [&chan](){
+        for ( int i = 1; i <= 100; ++i) {
+            chan.push( i);
+        }
+        chan.close();
+    }).join();
+    BOOST_CHECK_EQUAL( 5050, f.get() );
+}
+
+void test_channel_remote() {
+    // the values are passed to the parked coroutine by another thread
+    boost::fibers::buffered_channel< int > chan{ 2 };
+    boost::fibers::future< int > f = boost::fibers::spawn( consume( chan) );
+    std::thread t( [&chan](){
+        for ( int i = 1; i <= 1000; ++i) {
+            chan.push( i);
+        }
+        chan.close();
+    });
+    BOOST_CHECK_EQUAL( 500500, f.get() );
+    t.join();
+}
+
+// started at once, destroyed by its owner
+struct eager {
+    struct promise_type {
+        eager get_return_object() noexcept {
+            return eager{ std::coroutine_handle< promise_type >::from_promise( * this) };
+        }
+
+        std::suspend_never initial_suspend() const noexcept {
+            return {};
+        }
+
+        std::suspend_always final_suspend() const noexcept {
+            return {};
+        }
+
+        void return_void() noexcept {
+        }
+
+        void unhandled_exception() noexcept {
+            std::terminate();
+        }
+    };
+
+    std::coroutine_handle< promise_type >   handle;
+};
+
+eager pop_one( boost::fibers::buffered_channel< int > & chan, int & value) {
+    co_await boost::fibers::async_pop( chan, value);
+}
+
+void test_channel_destroy_suspended() {
+    // a coroutine destroyed while parked in the channel does not get the
+    // value pushed afterwards
+    boost::fibers::buffered_channel< int > chan{ 2 };
+    int value = 0;
+    eager e = pop_one( chan, value);
+    BOOST_CHECK( ! e.handle.done() );
+    e.handle.destroy();
+    BOOST_CHECK( boost::fibers::channel_op_status::success == chan.push( 3) );
+    BOOST_CHECK_EQUAL( 0, value);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == chan.try_pop( value) );
+    BOOST_CHECK_EQUAL( 3, value);
+}
+
+void test_unbuffered_channel() {
+    boost::fibers::unbuffered_channel< std::string > chan;
+    boost::fibers::future< std::string > f = boost::fibers::spawn( consume_unbuffered( chan) );
+    std::thread t( [&chan](){
+        chan.push( "a");
+        chan.push( "b");
+        chan.push( "c");
+        chan.close();
+    });
+    BOOST_CHECK_EQUAL( std::string("abc"), f.get() );
+    t.join();
+}
+
+void test_spawn_remote() {
+    // a coroutine spawned onto the scheduler of another thread
+    boost::fibers::promise< boost::fibers::scheduler_handle > ph;
+    boost::fibers::future< boost::fibers::scheduler_handle > fh = ph.get_future();
+    boost::fibers::promise< void > done;
+    boost::fibers::future< void > fdone = done.get_future();
+    std::thread t( [&ph,&fdone](){
+        ph.set_value( boost::fibers::scheduler_handle::current() );
+        fdone.wait();
+    });
+    boost::fibers::scheduler_handle h = fh.get();
+    auto where = []() -> boost::fibers::task< std::thread::id > {
+        co_return std::this_thread::get_id();
+    };
+    std::thread::id id = boost::fibers::spawn( h, where() ).get();
+    BOOST_CHECK( t.get_id() == id);
+    done.set_value();
+    t.join();
+}
+
+#endif
+
+void test_dummy() {}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: coroutine test suite");
+
+#if defined(BOOST_FIBERS_HAS_COROUTINES)
+    test->add( BOOST_TEST_CASE( & test_spawn) );
+    test->add( BOOST_TEST_CASE( & test_exception) );
+    test->add( BOOST_TEST_CASE( & test_move_only) );
+    test->add( BOOST_TEST_CASE( & test_await_future_local) );
+    test->add( BOOST_TEST_CASE( & test_await_future_ready) );
+    test->add( BOOST_TEST_CASE( & test_await_future_remote) );
+    test->add( BOOST_TEST_CASE( & test_await_future_exception) );
+    test->add( BOOST_TEST_CASE( & test_channel) );
+    test->add( BOOST_TEST_CASE( & test_channel_remote) );
+    test->add( BOOST_TEST_CASE( & test_channel_destroy_suspended) );
+    test->add( BOOST_TEST_CASE( & test_unbuffered_channel) );
+    test->add( BOOST_TEST_CASE( & test_spawn_remote) );
+#endif
+    test->add( BOOST_TEST_CASE( & test_dummy) );
+
+    return test;
+}
@@ -0,0 +1,217 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <thread>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+// waits till pred() or the timeout
+template< typename Pred >
+bool wait_for( Pred pred) {
+    std::chrono::steady_clock::time_point deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds( 10);
+    while ( ! pred() ) {
+        if ( std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1) );
+    }
+    return true;
+}
+
+void test_post() {
+    std::atomic< int > count{ 0 };
+    {
+        boost::fibers::elastic_pool pool{ 2, 2, std::chrono::steady_clock::duration::zero() };
+        BOOST_CHECK_EQUAL( std::size_t( 2), pool.size() );
+        for ( int i = 0; i < 100; ++i) {
+            pool.post( [&count](){
+                boost::this_fiber::yield();
+                ++count;
+            });
+        }
+        BOOST_CHECK( wait_for( [&count](){ return 100 == count; }) );
+    }
+    BOOST_CHECK_EQUAL( 100, count.load() );
+}
+
+void test_destructor_completes() {
+    // the destructor waits for fibers posted before
+    std::atomic< int > count{ 0 };
+    {
+        boost::fibers::elastic_pool pool{ 2, 2, std::chrono::steady_clock::duration::zero() };
+        for ( int i = 0; i < 10; ++i) {
+            pool.post( [&count](){
+                boost::this_fiber::sleep_for( std::chrono::milliseconds( 10) );
+                ++count;
+            });
+        }
+    }
+    BOOST_CHECK_EQUAL( 10, count.load() );
+}
+
+void test_grow_shrink() {
+    boost::fibers::elastic_pool pool{ 1, 3, std::chrono::steady_clock::duration::zero() };
+    BOOST_CHECK( pool.grow() );
+    BOOST_CHECK( pool.grow() );
+    BOOST_CHECK( ! pool.grow() );
+    BOOST_CHECK_EQUAL( std::size_t( 3), pool.size() );
+    // fibers waiting while threads retire are resumed by the remaining thread
+    boost::fibers::promise< void > p;
+    boost::fibers::shared_future< void > f{ p.get_future().share() };
+    std::atomic< int > waiting{ 0 };
+    std::atomic< int > done{ 0 };
+    for ( int i = 0; i < 30; ++i) {
+        pool.post( [f,&waiting,&done](){
+            ++waiting;
+            f.wait();
+            ++done;
+        });
+    }
+    BOOST_CHECK( wait_for( [&waiting](){ return 30 == waiting; }) );
+    BOOST_CHECK( pool.shrink() );
+    BOOST_CHECK( pool.shrink() );
+    BOOST_CHECK( ! pool.shrink() );
+    BOOST_CHECK_EQUAL( std::size_t( 1), pool.size() );
+    p.set_value();
+    BOOST_CHECK( wait_for( [&done](){ return 30 == done; }) );
+}
+
+void test_retire_drains() {
+    // a retiring thread passes its ready fibers to the remaining thread
+    boost::fibers::elastic_pool pool{ 1, 2, std::chrono::steady_clock::duration::zero() };
+    BOOST_CHECK( pool.grow() );
+    std::atomic< bool > release{ false };
+    std::atomic< int > done{ 0 };
+    for ( int i = 0; i < 20; ++i) {
+        pool.post( [&release,&done](){
+            while ( ! release) {
+                boost::this_fiber::yield();
+            }
+            ++done;
+        });
+    }
+    BOOST_CHECK( pool.shrink() );
+    release = true;
+    BOOST_CHECK( wait_for( [&done](){ return 20 == done; }) );
+}
+
+void test_retire_after_dump() {
+    // dump_fibers() starts the pinned runner of deferred functions on the
+    // threads of the pool; it must not keep a retiring thread alive
+    std::atomic< bool > done{ false };
+    {
+        boost::fibers::elastic_pool pool{ 1, 2, std::chrono::steady_clock::duration::zero() };
+        BOOST_CHECK( pool.grow() );
+        boost::fibers::dump_fibers();
+        BOOST_CHECK( pool.shrink() );
+        pool.post( [&done](){ done = true; });
+        BOOST_CHECK( wait_for( [&done](){ return done.load(); }) );
+    }
+}
+
+void test_adapt() {
+    boost::fibers::elastic_pool pool{ 1, 4, std::chrono::milliseconds( 5) };
+    // many ready fibers and no idle thread: the pool grows
+    std::atomic< bool > stop{ false };
+    std::atomic< int > running{ 0 };
+    for ( int i = 0; i < 32; ++i) {
+        pool.post( [&stop,&running](){
+            ++running;
+            while ( ! stop) {
+                std::chrono::steady_clock::time_point t =
+                    std::chrono::steady_clock::now() + std::chrono::microseconds( 100);
+                while ( std::chrono::steady_clock::now() < t) {
+                }
+                boost::this_fiber::yield();
+            }
+            --running;
+        });
+    }
+    BOOST_CHECK( wait_for( [&pool](){ return 1 < pool.size(); }) );
+    stop = true;
+    BOOST_CHECK( wait_for( [&running](){ return 0 == running; }) );
+    // idle threads are retired
+    BOOST_CHECK( wait_for( [&pool](){ return 1 == pool.size(); }) );
+}
+
+void test_groups() {
+    typedef boost::fibers::algo::work_stealing work_stealing;
+    std::shared_ptr< work_stealing::group > g1 = work_stealing::make_group();
+    std::shared_ptr< work_stealing::group > g2 = work_stealing::make_group();
+    work_stealing a{ g1, false };
+    BOOST_CHECK_EQUAL( std::size_t( 0), a.index() );
+    // index 0 of another group is free
+    work_stealing b{ g2, 1, 0 };
+    // index 0 of g1 has been claimed by a
+    BOOST_CHECK_THROW( ( work_stealing{ g1, 1, 0 }), boost::fibers::fiber_error);
+    work_stealing c{ g1, 1, 1 };
+    work_stealing d{ g1, false };
+    BOOST_CHECK_EQUAL( std::size_t( 2), d.index() );
+}
+
+void test_isolated() {
+    // fibers are not stolen by work_stealing threads outside of the pool
+    boost::fibers::elastic_pool pool{ 1, 1, std::chrono::steady_clock::duration::zero() };
+    std::atomic< bool > release{ false };
+    std::atomic< bool > stealing{ false };
+    std::atomic< int > foreign{ 0 };
+    std::atomic< int > done{ 0 };
+    std::thread t( [&release,&stealing](){
+        boost::fibers::use_scheduling_algorithm< boost::fibers::algo::work_stealing >( false);
+        stealing = true;
+        // the dispatcher of this thread looks for fibers to steal
+        while ( ! release) {
+            boost::this_fiber::sleep_for( std::chrono::milliseconds( 1) );
+        }
+    });
+    BOOST_CHECK( wait_for( [&stealing](){ return stealing.load(); }) );
+    pool.post( [&release,&foreign,&done](){
+        std::thread::id id = std::this_thread::get_id();
+        for ( int i = 0; i < 20; ++i) {
+            boost::fibers::fiber( boost::fibers::launch::post, [id,&foreign,&done](){
+                if ( id != std::this_thread::get_id() ) {
+                    ++foreign;
+                }
+                ++done;
+            }).detach();
+        }
+        // keeps the thread of the pool busy
+        std::this_thread::sleep_for( std::chrono::milliseconds( 50) );
+        release = true;
+    });
+    BOOST_CHECK( wait_for( [&done](){ return 20 == done; }) );
+    t.join();
+    BOOST_CHECK_EQUAL( 0, foreign.load() );
+}
+
+void test_invalid() {
+    BOOST_CHECK_THROW( boost::fibers::elastic_pool( 0, 1), boost::fibers::fiber_error);
+    BOOST_CHECK_THROW( boost::fibers::elastic_pool( 2, 1), boost::fibers::fiber_error);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: elastic pool test suite");
+
+    test->add( BOOST_TEST_CASE( & test_post) );
+    test->add( BOOST_TEST_CASE( & test_destructor_completes) );
+    test->add( BOOST_TEST_CASE( & test_grow_shrink) );
+    test->add( BOOST_TEST_CASE( & test_retire_drains) );
+    test->add( BOOST_TEST_CASE( & test_retire_after_dump) );
+    test->add( BOOST_TEST_CASE( & test_adapt) );
+    test->add( BOOST_TEST_CASE( & test_groups) );
+    test->add( BOOST_TEST_CASE( & test_isolated) );
+    test->add( BOOST_TEST_CASE( & test_invalid) );
+
+    return test;
+}
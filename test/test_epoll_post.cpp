@@ -0,0 +1,173 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+void set_nonblocking( int fd) {
+    ::fcntl( fd, F_SETFL, ::fcntl( fd, F_GETFL) | O_NONBLOCK);
+}
+
+void test_read_pipe() {
+    boost::fibers::use_scheduling_algorithm< boost::fibers::algo::epoll >();
+    int fds[2];
+    BOOST_REQUIRE_EQUAL( 0, ::pipe( fds) );
+    set_nonblocking( fds[0]);
+    set_nonblocking( fds[1]);
+    std::string result;
+    boost::fibers::fiber reader( boost::fibers::launch::post, [&result,&fds](){
+        char buf[16];
+        ::ssize_t n = boost::fibers::read( fds[0], buf, sizeof( buf) );
+        if ( 0 < n) {
+            result.assign( buf, n);
+        }
+    });
+    boost::fibers::fiber writer( boost::fibers::launch::post, [&fds](){
+        boost::this_fiber::sleep_for( std::chrono::milliseconds( 10) );
+        boost::fibers::write( fds[1], "abc", 3);
+    });
+    reader.join();
+    writer.join();
+    BOOST_CHECK_EQUAL( std::string("abc"), result);
+    boost::fibers::close( fds[0]);
+    boost::fibers::close( fds[1]);
+}
+
+void test_wait_readable_timeout() {
+    boost::fibers::use_scheduling_algorithm< boost::fibers::algo::epoll >();
+    int fds[2];
+    BOOST_REQUIRE_EQUAL( 0, ::pipe( fds) );
+    set_nonblocking( fds[0]);
+    bool ready = true;
+    std::chrono::steady_clock::duration elapsed;
+    boost::fibers::fiber f( boost::fibers::launch::post, [&](){
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        ready = boost::this_fiber::wait_readable(
+                fds[0], std::chrono::steady_clock::now() + std::chrono::milliseconds( 50) );
+        elapsed = std::chrono::steady_clock::now() - start;
+    });
+    f.join();
+    BOOST_CHECK( ! ready);
+    BOOST_CHECK( std::chrono::milliseconds( 50) <= elapsed);
+    boost::fibers::close( fds[0]);
+    boost::fibers::close( fds[1]);
+}
+
+void test_echo_socketpair() {
+    boost::fibers::use_scheduling_algorithm< boost::fibers::algo::epoll >();
+    const std::size_t pairs = 8, messages = 100;
+    std::vector< boost::fibers::fiber > fibers;
+    std::vector< int > fds;
+    std::size_t received = 0;
+    for ( std::size_t i = 0; i < pairs; ++i) {
+        int sv[2];
+        BOOST_REQUIRE_EQUAL( 0, ::socketpair( AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv) );
+        fds.push_back( sv[0]);
+        fds.push_back( sv[1]);
+        fibers.emplace_back( boost::fibers::launch::post, [sv](){
+            char buf[64];
+            for (;;) {
+                ::ssize_t n = boost::fibers::read( sv[1], buf, sizeof( buf) );
+                if ( 0 >= n) {
+                    break;
+                }
+                boost::fibers::write( sv[1], buf, n);
+            }
+        });
+        fibers.emplace_back( boost::fibers::launch::post, [sv,&received](){
+            char buf[8];
+            for ( std::size_t j = 0; j < messages; ++j) {
+                boost::fibers::write( sv[0], "ping", 4);
+                std::size_t got = 0;
+                while ( 4 > got) {
+                    ::ssize_t n = boost::fibers::read( sv[0], buf + got, 4 - got);
+                    if ( 0 >= n) {
+                        return;
+                    }
+                    got += n;
+                }
+                if ( 0 == std::memcmp( buf, "ping", 4) ) {
+                    ++received;
+                }
+            }
+            ::shutdown( sv[0], SHUT_WR);
+        });
+    }
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    BOOST_CHECK_EQUAL( pairs * messages, received);
+    for ( int fd : fds) {
+        boost::fibers::close( fd);
+    }
+}
+
+void test_accept() {
+    boost::fibers::use_scheduling_algorithm< boost::fibers::algo::epoll >();
+    int l = ::socket( AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    BOOST_REQUIRE( -1 != l);
+    ::sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    BOOST_REQUIRE_EQUAL( 0, ::bind( l, reinterpret_cast< ::sockaddr * >( & addr), sizeof( addr) ) );
+    BOOST_REQUIRE_EQUAL( 0, ::listen( l, 4) );
+    ::socklen_t len = sizeof( addr);
+    ::getsockname( l, reinterpret_cast< ::sockaddr * >( & addr), & len);
+    int accepted = -1;
+    boost::fibers::fiber server( boost::fibers::launch::post, [&](){
+        accepted = boost::fibers::accept( l, nullptr, nullptr);
+    });
+    boost::fibers::fiber client( boost::fibers::launch::post, [&](){
+        boost::this_fiber::sleep_for( std::chrono::milliseconds( 10) );
+        int s = ::socket( AF_INET, SOCK_STREAM, 0);
+        ::connect( s, reinterpret_cast< ::sockaddr * >( & addr), sizeof( addr) );
+        ::close( s);
+    });
+    server.join();
+    client.join();
+    BOOST_CHECK( -1 != accepted);
+    BOOST_CHECK( 0 != ( ::fcntl( accepted, F_GETFL) & O_NONBLOCK) );
+    boost::fibers::close( accepted);
+    boost::fibers::close( l);
+}
+
+void test_remote_notify() {
+    boost::fibers::use_scheduling_algorithm< boost::fibers::algo::epoll >();
+    boost::fibers::promise< int > p;
+    boost::fibers::future< int > f( p.get_future() );
+    std::thread t([&p](){
+        std::this_thread::sleep_for( std::chrono::milliseconds( 10) );
+        p.set_value( 7);
+    });
+    BOOST_CHECK_EQUAL( 7, f.get() );
+    t.join();
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: epoll test suite");
+
+    test->add( BOOST_TEST_CASE( & test_read_pipe) );
+    test->add( BOOST_TEST_CASE( & test_wait_readable_timeout) );
+    test->add( BOOST_TEST_CASE( & test_echo_socketpair) );
+    test->add( BOOST_TEST_CASE( & test_accept) );
+    test->add( BOOST_TEST_CASE( & test_remote_notify) );
+
+    return test;
+}
@@ -0,0 +1,167 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+boost::fibers::scheduler_dump const* find( std::vector< boost::fibers::scheduler_dump > const& dumps, std::thread::id id) {
+    for ( boost::fibers::scheduler_dump const& d : dumps) {
+        if ( id == d.thread_id) {
+            return & d;
+        }
+    }
+    return nullptr;
+}
+
+boost::fibers::fiber_info const* find( boost::fibers::scheduler_dump const& d, boost::fibers::fiber::id id) {
+    for ( boost::fibers::fiber_info const& f : d.fibers) {
+        if ( id == f.id) {
+            return & f;
+        }
+    }
+    return nullptr;
+}
+
+void test_local() {
+    boost::fibers::mutex mtx;
+    std::unique_lock< boost::fibers::mutex > lk( mtx);
+    boost::fibers::fiber f1( [&mtx](){
+        std::unique_lock< boost::fibers::mutex > lk( mtx);
+    });
+    boost::fibers::fiber f2( [](){
+        boost::this_fiber::sleep_for( std::chrono::milliseconds( 50) );
+    });
+    bool done = false;
+    boost::fibers::fiber f3( [&done](){
+        while ( ! done) {
+            boost::this_fiber::yield();
+        }
+    });
+    boost::this_fiber::yield();
+    std::vector< boost::fibers::scheduler_dump > dumps = boost::fibers::dump_fibers();
+    boost::fibers::scheduler_dump const* d = find( dumps, std::this_thread::get_id() );
+    BOOST_REQUIRE( nullptr != d);
+    BOOST_CHECK( d->complete);
+    boost::fibers::fiber_info const* main = find( * d, boost::this_fiber::get_id() );
+    BOOST_REQUIRE( nullptr != main);
+    BOOST_CHECK( main->main);
+    BOOST_CHECK( boost::fibers::fiber_state::running == main->state);
+    boost::fibers::fiber_info const* i1 = find( * d, f1.get_id() );
+    BOOST_REQUIRE( nullptr != i1);
+    BOOST_CHECK( boost::fibers::fiber_state::blocked == i1->state);
+    BOOST_CHECK( boost::fibers::block_reason::mutex == i1->reason);
+    BOOST_CHECK( & mtx == i1->object);
+    BOOST_CHECK( 0u < i1->stack_used);
+    BOOST_CHECK( i1->stack_used < i1->stack_size);
+    boost::fibers::fiber_info const* i2 = find( * d, f2.get_id() );
+    BOOST_REQUIRE( nullptr != i2);
+    BOOST_CHECK( boost::fibers::fiber_state::sleeping == i2->state);
+    BOOST_CHECK( std::chrono::steady_clock::now() < i2->deadline);
+    boost::fibers::fiber_info const* i3 = find( * d, f3.get_id() );
+    BOOST_REQUIRE( nullptr != i3);
+    BOOST_CHECK( boost::fibers::fiber_state::ready == i3->state);
+    BOOST_CHECK( (std::chrono::steady_clock::time_point::max)() == i3->deadline);
+    std::ostringstream os;
+    os << * d;
+    BOOST_CHECK( std::string::npos != os.str().find("blocked on mutex") );
+    BOOST_CHECK( std::string::npos != os.str().find("sleeping, deadline in") );
+    done = true;
+    lk.unlock();
+    f1.join();
+    f2.join();
+    f3.join();
+}
+
+void test_remote() {
+    boost::fibers::buffered_channel< int > chan{ 2 };
+    std::atomic< bool > waiting{ false };
+    boost::fibers::fiber::id id;
+    std::thread t( [&chan,&waiting,&id](){
+        boost::fibers::fiber f( [&chan](){
+            int value = 0;
+            chan.pop( value);
+        });
+        id = f.get_id();
+        boost::this_fiber::yield();
+        waiting = true;
+        f.join();
+    });
+    while ( ! waiting) {
+        std::this_thread::yield();
+    }
+    std::vector< boost::fibers::scheduler_dump > dumps =
+        boost::fibers::dump_fibers( std::chrono::seconds( 10), true);
+    boost::fibers::scheduler_dump const* d = find( dumps, t.get_id() );
+    BOOST_REQUIRE( nullptr != d);
+    BOOST_CHECK( d->complete);
+    // main fiber joining and f
+    BOOST_CHECK_EQUAL( 2u, d->fibers.size() );
+    boost::fibers::fiber_info const* f = find( * d, id);
+    BOOST_REQUIRE( nullptr != f);
+    BOOST_CHECK( boost::fibers::fiber_state::blocked == f->state);
+    BOOST_CHECK( boost::fibers::block_reason::channel_pop == f->reason);
+    BOOST_CHECK( & chan == f->object);
+#if ( defined(BOOST_GCC) || defined(BOOST_CLANG) ) && defined(__x86_64__)
+    BOOST_CHECK( ! f->backtrace.empty() );
+#endif
+    for ( boost::fibers::fiber_info const& info : d->fibers) {
+        if ( info.main) {
+            BOOST_CHECK( boost::fibers::fiber_state::blocked == info.state);
+            BOOST_CHECK( boost::fibers::block_reason::join == info.reason);
+        }
+    }
+    chan.push( 1);
+    t.join();
+}
+
+void test_not_responding() {
+    std::atomic< bool > spinning{ false }, done{ false };
+    std::thread t( [&spinning,&done](){
+        boost::fibers::fiber f( [&spinning,&done](){
+            spinning = true;
+            // does not yield
+            while ( ! done) {
+                std::this_thread::yield();
+            }
+        });
+        f.join();
+    });
+    while ( ! spinning) {
+        std::this_thread::yield();
+    }
+    std::vector< boost::fibers::scheduler_dump > dumps =
+        boost::fibers::dump_fibers( std::chrono::milliseconds( 10) );
+    std::thread::id tid = t.get_id();
+    done = true;
+    t.join();
+    boost::fibers::scheduler_dump const* d = find( dumps, tid);
+    BOOST_REQUIRE( nullptr != d);
+    BOOST_CHECK( ! d->complete);
+    BOOST_REQUIRE_EQUAL( 1u, d->fibers.size() );
+    BOOST_CHECK( boost::fibers::fiber_state::running == d->fibers[0].state);
+    std::ostringstream os;
+    os << * d;
+    BOOST_CHECK( std::string::npos != os.str().find("not responding") );
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: fiber dump test suite");
+
+    test->add( BOOST_TEST_CASE( & test_local) );
+    test->add( BOOST_TEST_CASE( & test_remote) );
+    test->add( BOOST_TEST_CASE( & test_not_responding) );
+
+    return test;
+}
@@ -0,0 +1,185 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+#if defined(BOOST_FIBERS_HAS_PTHREAD_KILL)
+# include <signal.h>
+#endif
+
+struct reports {
+    std::mutex                                      mtx;
+    std::vector< boost::fibers::blocked_fiber >     items;
+
+    void operator()( boost::fibers::blocked_fiber const& info) {
+        std::unique_lock< std::mutex > lk( mtx);
+        items.push_back( info);
+    }
+
+    std::vector< boost::fibers::blocked_fiber > get() {
+        std::unique_lock< std::mutex > lk( mtx);
+        return items;
+    }
+};
+
+void test_report() {
+    reports r;
+    boost::fibers::fiber::id id;
+    {
+        boost::fibers::monitor m( std::chrono::milliseconds( 20), std::ref( r) );
+        boost::fibers::fiber f( boost::fibers::launch::post, [](){
+            // deliberately block the thread
+            std::this_thread::sleep_for( std::chrono::milliseconds( 200) );
+        });
+        id = f.get_id();
+        f.join();
+    }
+    std::vector< boost::fibers::blocked_fiber > items = r.get();
+    BOOST_REQUIRE_EQUAL( 1u, items.size() );
+    BOOST_CHECK( id == items[0].fiber_id);
+    BOOST_CHECK( std::this_thread::get_id() == items[0].thread_id);
+    BOOST_CHECK( std::chrono::milliseconds( 20) <= items[0].duration);
+    BOOST_CHECK_EQUAL( 0u, items[0].handed_off);
+}
+
+void test_no_report() {
+    reports r;
+    {
+        boost::fibers::monitor m( std::chrono::milliseconds( 20), std::ref( r) );
+        boost::fibers::fiber f1( boost::fibers::launch::post, [](){
+            // gives up the thread
+            boost::this_fiber::sleep_for( std::chrono::milliseconds( 100) );
+        });
+        boost::fibers::fiber f2( boost::fibers::launch::post, [](){
+            for ( int i = 0; i < 100; ++i) {
+                std::this_thread::sleep_for( std::chrono::milliseconds( 1) );
+                boost::this_fiber::yield();
+            }
+        });
+        f1.join();
+        f2.join();
+    }
+    BOOST_CHECK( r.get().empty() );
+}
+
+void test_handoff() {
+    reports r;
+    boost::fibers::fiber::id id;
+    std::thread::id worker;
+    std::vector< std::thread::id > ids( 4);
+    {
+        boost::fibers::monitor m( std::chrono::milliseconds( 20), std::ref( r), true);
+        std::thread t([&id,&worker,&ids](){
+            worker = std::this_thread::get_id();
+            boost::fibers::use_scheduling_algorithm< boost::fibers::algo::work_stealing >( 0, 0);
+            boost::fibers::fiber blocker( boost::fibers::launch::post, [](){
+                // deliberately block the thread
+                std::this_thread::sleep_for( std::chrono::milliseconds( 500) );
+            });
+            id = blocker.get_id();
+            std::vector< boost::fibers::fiber > fibers;
+            for ( std::size_t i = 0; i < ids.size(); ++i) {
+                fibers.emplace_back( boost::fibers::launch::post, [&ids,i](){
+                    ids[i] = std::this_thread::get_id();
+                });
+            }
+            blocker.join();
+            for ( boost::fibers::fiber & f : fibers) {
+                f.join();
+            }
+        });
+        t.join();
+    }
+    std::vector< boost::fibers::blocked_fiber > items = r.get();
+    BOOST_REQUIRE_EQUAL( 1u, items.size() );
+    BOOST_CHECK( id == items[0].fiber_id);
+    BOOST_CHECK( worker == items[0].thread_id);
+    BOOST_CHECK_EQUAL( ids.size(), items[0].handed_off);
+    for ( std::thread::id const& i : ids) {
+        // executed by the spare thread
+        BOOST_CHECK( std::thread::id() != i);
+        BOOST_CHECK( worker != i);
+    }
+}
+
+void test_spawn_site() {
+    reports r;
+    {
+        boost::fibers::monitor m( std::chrono::milliseconds( 20), std::ref( r) );
+        boost::fibers::fiber f( boost::fibers::launch::post, [](){
+            std::this_thread::sleep_for( std::chrono::milliseconds( 200) );
+        });
+        f.join();
+    }
+    std::vector< boost::fibers::blocked_fiber > items = r.get();
+    BOOST_REQUIRE_EQUAL( 1u, items.size() );
+#if defined(BOOST_GCC) || defined(BOOST_CLANG) || defined(BOOST_MSVC)
+    BOOST_CHECK( nullptr != items[0].spawn_site);
+#endif
+    // not sampled
+    BOOST_CHECK( items[0].backtrace.empty() );
+}
+
+#if defined(BOOST_FIBERS_HAS_PTHREAD_KILL)
+void test_sample() {
+    reports r;
+    {
+        boost::fibers::monitor m( std::chrono::milliseconds( 20), std::ref( r), false, SIGURG);
+        boost::fibers::fiber f( boost::fibers::launch::post, [](){
+            // spins without yielding
+            std::chrono::steady_clock::time_point end =
+                std::chrono::steady_clock::now() + std::chrono::milliseconds( 200);
+            while ( std::chrono::steady_clock::now() < end) {
+            }
+        });
+        f.join();
+    }
+    std::vector< boost::fibers::blocked_fiber > items = r.get();
+    BOOST_REQUIRE_EQUAL( 1u, items.size() );
+#if BOOST_OS_LINUX && defined(__x86_64__)
+    // at least the interrupted instruction
+    BOOST_CHECK( ! items[0].backtrace.empty() );
+#endif
+}
+
+void test_sample_signals() {
+    boost::fibers::monitor m( std::chrono::milliseconds( 20), {}, false, SIGURG);
+    BOOST_CHECK_THROW(
+        boost::fibers::monitor( std::chrono::milliseconds( 20), {}, false, SIGPROF),
+        boost::fibers::fiber_error);
+}
+#endif
+
+void test_threshold() {
+    BOOST_CHECK_THROW(
+        boost::fibers::monitor( std::chrono::steady_clock::duration::zero() ),
+        boost::fibers::fiber_error);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: monitor test suite");
+
+    test->add( BOOST_TEST_CASE( & test_report) );
+    test->add( BOOST_TEST_CASE( & test_no_report) );
+    test->add( BOOST_TEST_CASE( & test_handoff) );
+    test->add( BOOST_TEST_CASE( & test_spawn_site) );
+#if defined(BOOST_FIBERS_HAS_PTHREAD_KILL)
+    test->add( BOOST_TEST_CASE( & test_sample) );
+    test->add( BOOST_TEST_CASE( & test_sample_signals) );
+#endif
+    test->add( BOOST_TEST_CASE( & test_threshold) );
+
+    return test;
+}
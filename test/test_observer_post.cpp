@@ -0,0 +1,208 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+class recorder : public boost::fibers::observer {
+private:
+    std::mutex                                  mtx_{};
+    std::vector< boost::fibers::event >         events_{};
+
+public:
+    recorder() {
+        boost::fibers::set_observer( this);
+    }
+
+    ~recorder() {
+        boost::fibers::set_observer( nullptr);
+    }
+
+    void on_event( boost::fibers::event const& e) noexcept {
+        std::unique_lock< std::mutex > lk( mtx_);
+        events_.push_back( e);
+    }
+
+    std::vector< boost::fibers::event > events() {
+        std::unique_lock< std::mutex > lk( mtx_);
+        return events_;
+    }
+
+    std::size_t count( boost::fibers::event_type type, boost::fibers::context::id id) {
+        std::vector< boost::fibers::event > v = events();
+        return std::count_if( v.begin(), v.end(),
+                              [type,id]( boost::fibers::event const& e){
+                                  return type == e.type && id == e.id; });
+    }
+
+    std::size_t count( boost::fibers::block_reason reason, void const * object) {
+        std::vector< boost::fibers::event > v = events();
+        return std::count_if( v.begin(), v.end(),
+                              [reason,object]( boost::fibers::event const& e){
+                                  return boost::fibers::event_type::block == e.type &&
+                                         reason == e.reason && object == e.object; });
+    }
+};
+
+// events are reported only if the library is built with BOOST_FIBERS_HOOKS
+bool enabled() {
+    recorder r;
+    boost::fibers::fiber f( [](){});
+    boost::fibers::context::id id = f.get_id();
+    f.join();
+    bool enabled = 0 < r.count( boost::fibers::event_type::spawn, id);
+#if defined(BOOST_FIBERS_HOOKS)
+    BOOST_CHECK( enabled);
+#endif
+    return enabled;
+}
+
+void test_lifecycle() {
+    if ( ! enabled() ) {
+        return;
+    }
+    recorder r;
+    boost::fibers::context::id main_id = boost::this_fiber::get_id();
+    boost::fibers::fiber f( [](){
+        boost::this_fiber::yield();
+    });
+    boost::fibers::context::id id = f.get_id();
+    f.join();
+    BOOST_CHECK_EQUAL( 1u, r.count( boost::fibers::event_type::spawn, id) );
+    BOOST_CHECK_EQUAL( 1u, r.count( boost::fibers::event_type::terminate, id) );
+    BOOST_CHECK( 2u <= r.count( boost::fibers::event_type::resume, id) );
+    // the joining main fiber is blocked and made ready by the terminating fiber
+    std::vector< boost::fibers::event > v = r.events();
+    BOOST_CHECK( v.end() != std::find_if( v.begin(), v.end(),
+                    [main_id]( boost::fibers::event const& e){
+                        return boost::fibers::event_type::block == e.type &&
+                               boost::fibers::block_reason::join == e.reason &&
+                               main_id == e.id; }) );
+    BOOST_CHECK( v.end() != std::find_if( v.begin(), v.end(),
+                    [main_id,id]( boost::fibers::event const& e){
+                        return boost::fibers::event_type::ready == e.type &&
+                               main_id == e.id && id == e.from; }) );
+    // timestamps are ordered
+    for ( std::size_t i = 1; i < v.size(); ++i) {
+        BOOST_CHECK( v[i - 1].timestamp <= v[i].timestamp);
+    }
+    // all events of this thread refer to its scheduler
+    boost::fibers::scheduler * sched = boost::fibers::context::active()->get_scheduler();
+    for ( boost::fibers::event const& e : v) {
+        BOOST_CHECK( sched == e.sched);
+    }
+}
+
+void test_block_reasons() {
+    if ( ! enabled() ) {
+        return;
+    }
+    recorder r;
+    boost::fibers::mutex mtx;
+    boost::fibers::condition_variable cnd;
+    boost::fibers::buffered_channel< int > chan{ 2 };
+    bool flag = false;
+    std::unique_lock< boost::fibers::mutex > lk( mtx);
+    boost::fibers::fiber f( [&](){
+        // blocks on the mutex
+        std::unique_lock< boost::fibers::mutex > lk( mtx);
+        flag = true;
+        cnd.notify_one();
+        lk.unlock();
+        // the main fiber blocks on the channel
+        boost::this_fiber::yield();
+        chan.push( 1);
+    });
+    boost::this_fiber::yield();
+    // blocks on the condition variable, releases the mutex
+    cnd.wait( lk, [&flag](){ return flag; });
+    lk.unlock();
+    int value = 0;
+    chan.pop( value);
+    f.join();
+    boost::this_fiber::sleep_for( std::chrono::milliseconds( 1) );
+    BOOST_CHECK_EQUAL( 1u, r.count( boost::fibers::block_reason::mutex, & mtx) );
+    BOOST_CHECK_EQUAL( 1u, r.count( boost::fibers::block_reason::condition_variable, & cnd) );
+    BOOST_CHECK_EQUAL( 1u, r.count( boost::fibers::block_reason::channel_pop, & chan) );
+    BOOST_CHECK_EQUAL( 1u, r.count( boost::fibers::block_reason::sleep, nullptr) );
+}
+
+void test_remote_ready() {
+    if ( ! enabled() ) {
+        return;
+    }
+    recorder r;
+    boost::fibers::context::id main_id = boost::this_fiber::get_id();
+    boost::fibers::promise< void > p;
+    boost::fibers::future< void > f = p.get_future();
+    std::thread t( [&p](){
+        std::this_thread::sleep_for( std::chrono::milliseconds( 10) );
+        p.set_value();
+    });
+    f.wait();
+    t.join();
+    BOOST_CHECK_EQUAL( 1u, r.count( boost::fibers::event_type::remote_ready, main_id) );
+}
+
+void test_migrate_not_spawned() {
+    if ( ! enabled() ) {
+        return;
+    }
+    recorder r;
+    std::mutex mtx;
+    std::vector< boost::fibers::context::id > ids;
+    std::atomic< int > started{ 0 };
+    std::atomic< bool > release{ false };
+    std::atomic< int > done{ 0 };
+    {
+        boost::fibers::elastic_pool pool{ 1, 2, std::chrono::steady_clock::duration::zero() };
+        BOOST_CHECK( pool.grow() );
+        for ( int i = 0; i < 20; ++i) {
+            pool.post( [&mtx,&ids,&started,&release,&done](){
+                {
+                    std::unique_lock< std::mutex > lk( mtx);
+                    ids.push_back( boost::this_fiber::get_id() );
+                }
+                ++started;
+                while ( ! release) {
+                    boost::this_fiber::sleep_for( std::chrono::milliseconds( 1) );
+                }
+                ++done;
+            });
+        }
+        while ( 20 != started) {
+            std::this_thread::sleep_for( std::chrono::milliseconds( 1) );
+        }
+        // the retiring thread passes its ready fibers to the other thread
+        BOOST_CHECK( pool.shrink() );
+        std::this_thread::sleep_for( std::chrono::milliseconds( 50) );
+        release = true;
+    }
+    BOOST_CHECK_EQUAL( 20, done.load() );
+    for ( boost::fibers::context::id id : ids) {
+        BOOST_CHECK_EQUAL( 1u, r.count( boost::fibers::event_type::spawn, id) );
+    }
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: observer test suite");
+
+    test->add( BOOST_TEST_CASE( & test_lifecycle) );
+    test->add( BOOST_TEST_CASE( & test_block_reasons) );
+    test->add( BOOST_TEST_CASE( & test_remote_ready) );
+    test->add( BOOST_TEST_CASE( & test_migrate_not_spawned) );
+
+    return test;
+}
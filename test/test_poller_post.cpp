@@ -0,0 +1,107 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+void test_wakeup() {
+    // an event source written by another thread, polled by the dispatcher
+    std::atomic< int > source{ 0 };
+    boost::fibers::promise< int > p;
+    boost::fibers::future< int > f = p.get_future();
+    bool done = false;
+    boost::fibers::scheduler::poller_id id = boost::fibers::add_poller(
+        [&source,&p,&done](){
+            if ( done) {
+                return false;
+            }
+            int value = source.exchange( 0);
+            if ( 0 == value) {
+                return false;
+            }
+            p.set_value( value);
+            done = true;
+            return true;
+        });
+    std::thread t([&source](){
+        std::this_thread::sleep_for( std::chrono::milliseconds( 10) );
+        source = 7;
+    });
+    BOOST_CHECK_EQUAL( 7, f.get() );
+    t.join();
+    boost::fibers::remove_poller( id);
+}
+
+void test_remove() {
+    int count = 0;
+    boost::fibers::scheduler::poller_id id = 0;
+    // removes itself after three rounds
+    id = boost::fibers::add_poller( [&count,&id](){
+        if ( 3 == ++count) {
+            boost::fibers::remove_poller( id);
+        }
+        return false;
+    });
+    for ( int i = 0; i < 10; ++i) {
+        boost::this_fiber::yield();
+    }
+    BOOST_CHECK_EQUAL( 3, count);
+}
+
+void test_poll_interval() {
+    int busy = 0;
+    boost::fibers::scheduler::poller_id id = boost::fibers::add_poller( [&busy](){
+        ++busy;
+        return false;
+    });
+    // no fiber is ready: the dispatcher polls continuously
+    boost::this_fiber::sleep_for( std::chrono::milliseconds( 50) );
+    boost::fibers::remove_poller( id);
+    int parked = 0;
+    id = boost::fibers::add_poller( [&parked](){
+        ++parked;
+        return false;
+    });
+    // the dispatcher parks for the poll interval between the rounds
+    boost::fibers::set_poll_interval( std::chrono::milliseconds( 20) );
+    boost::this_fiber::sleep_for( std::chrono::milliseconds( 50) );
+    boost::fibers::remove_poller( id);
+    boost::fibers::set_poll_interval( std::chrono::steady_clock::duration::zero() );
+    BOOST_CHECK( 100 < busy);
+    BOOST_CHECK( 0 < parked);
+    BOOST_CHECK( parked < 20);
+}
+
+void test_did_work() {
+    // a poller doing work keeps the dispatcher from parking
+    int rounds = 0;
+    boost::fibers::set_poll_interval( std::chrono::milliseconds( 50) );
+    boost::fibers::scheduler::poller_id id = boost::fibers::add_poller( [&rounds](){
+        ++rounds;
+        return true;
+    });
+    boost::this_fiber::sleep_for( std::chrono::milliseconds( 20) );
+    boost::fibers::remove_poller( id);
+    boost::fibers::set_poll_interval( std::chrono::steady_clock::duration::zero() );
+    BOOST_CHECK( 100 < rounds);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: poller test suite");
+
+    test->add( BOOST_TEST_CASE( & test_wakeup) );
+    test->add( BOOST_TEST_CASE( & test_remove) );
+    test->add( BOOST_TEST_CASE( & test_poll_interval) );
+    test->add( BOOST_TEST_CASE( & test_did_work) );
+
+    return test;
+}
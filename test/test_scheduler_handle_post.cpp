@@ -0,0 +1,135 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+void test_post() {
+    boost::fibers::scheduler_handle h = boost::fibers::scheduler_handle::current();
+    BOOST_CHECK( h);
+    boost::fibers::promise< std::thread::id > p;
+    boost::fibers::future< std::thread::id > f = p.get_future();
+    std::thread t([h,&p]() mutable {
+        h.post([&p](){
+            p.set_value( std::this_thread::get_id() );
+        });
+    });
+    // the fiber runs in this thread
+    BOOST_CHECK( std::this_thread::get_id() == f.get() );
+    t.join();
+}
+
+void test_post_args() {
+    boost::fibers::scheduler_handle h = boost::fibers::scheduler_handle::current();
+    boost::fibers::promise< int > p;
+    boost::fibers::future< int > f = p.get_future();
+    std::thread t([h,&p]() mutable {
+        h.post( []( boost::fibers::promise< int > & p, int i, int j){
+                    p.set_value( i + j);
+                },
+                std::ref( p), 3, 4);
+    });
+    BOOST_CHECK_EQUAL( 7, f.get() );
+    t.join();
+}
+
+void test_post_bulk() {
+    boost::fibers::scheduler_handle h = boost::fibers::scheduler_handle::current();
+    std::vector< int > order;
+    boost::fibers::mutex mtx;
+    boost::fibers::condition_variable cnd;
+    std::thread t([h,&order,&mtx,&cnd]() mutable {
+        std::vector< std::function< void() > > fns;
+        for ( int i = 0; i < 100; ++i) {
+            fns.push_back([i,&order,&mtx,&cnd](){
+                std::unique_lock< boost::fibers::mutex > lk( mtx);
+                order.push_back( i);
+                cnd.notify_all();
+            });
+        }
+        h.post_bulk( fns.begin(), fns.end() );
+    });
+    {
+        std::unique_lock< boost::fibers::mutex > lk( mtx);
+        cnd.wait( lk, [&order](){ return 100 == order.size(); });
+    }
+    t.join();
+    // launched in order
+    for ( int i = 0; i < 100; ++i) {
+        BOOST_CHECK_EQUAL( i, order[i]);
+    }
+}
+
+void test_post_many_threads() {
+    boost::fibers::scheduler_handle h = boost::fibers::scheduler_handle::current();
+    const int n = 4, m = 1000;
+    int count = 0;
+    boost::fibers::mutex mtx;
+    boost::fibers::condition_variable cnd;
+    std::vector< std::thread > threads;
+    for ( int i = 0; i < n; ++i) {
+        threads.emplace_back([h,&count,&mtx,&cnd]() mutable {
+            for ( int j = 0; j < m; ++j) {
+                h.post([&count,&mtx,&cnd](){
+                    std::unique_lock< boost::fibers::mutex > lk( mtx);
+                    ++count;
+                    cnd.notify_all();
+                });
+            }
+        });
+    }
+    {
+        std::unique_lock< boost::fibers::mutex > lk( mtx);
+        cnd.wait( lk, [&count](){ return n * m == count; });
+    }
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    BOOST_CHECK_EQUAL( n * m, count);
+}
+
+void test_post_suspended() {
+    // the target thread blocks in the scheduling algorithm: posting wakes it
+    std::atomic< boost::fibers::scheduler * > sched{ nullptr };
+    std::atomic< bool > done{ false };
+    std::thread t([&sched,&done](){
+        boost::fibers::mutex mtx;
+        boost::fibers::condition_variable_any cnd;
+        sched = boost::fibers::context::active()->get_scheduler();
+        std::unique_lock< boost::fibers::mutex > lk( mtx);
+        while ( ! done) {
+            cnd.wait_for( lk, std::chrono::milliseconds( 10) );
+        }
+    });
+    while ( nullptr == sched.load() ) {
+        std::this_thread::yield();
+    }
+    boost::fibers::scheduler_handle h{ sched.load() };
+    h.post([&done](){ done = true; });
+    t.join();
+    BOOST_CHECK( done);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: scheduler_handle test suite");
+
+    test->add( BOOST_TEST_CASE( & test_post) );
+    test->add( BOOST_TEST_CASE( & test_post_args) );
+    test->add( BOOST_TEST_CASE( & test_post_bulk) );
+    test->add( BOOST_TEST_CASE( & test_post_many_threads) );
+    test->add( BOOST_TEST_CASE( & test_post_suspended) );
+
+    return test;
+}
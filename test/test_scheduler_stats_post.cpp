@@ -0,0 +1,262 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+void test_enabled() {
+    // the Jamfile builds this test and the library with <fiber-stats>on
+    boost::fibers::scheduler_stats s = boost::fibers::scheduler_handle::current().stats();
+#if defined(BOOST_FIBERS_STATS)
+    BOOST_CHECK( s.enabled);
+#else
+    BOOST_CHECK( ! s.enabled);
+#endif
+}
+
+void test_fibers() {
+    std::thread t( [](){
+        boost::fibers::scheduler_handle h = boost::fibers::scheduler_handle::current();
+        boost::fibers::scheduler_stats before = h.stats();
+        BOOST_CHECK( std::this_thread::get_id() == before.thread_id);
+        std::vector< boost::fibers::fiber > fs;
+        for ( int i = 0; i < 10; ++i) {
+            fs.emplace_back( [](){
+                boost::this_fiber::yield();
+            });
+        }
+        for ( boost::fibers::fiber & f : fs) {
+            f.join();
+        }
+        boost::fibers::scheduler_stats after = h.stats();
+        BOOST_CHECK( before.switches + 20 <= after.switches);
+        if ( after.enabled) {
+            BOOST_CHECK_EQUAL( before.fibers_created + 10, after.fibers_created);
+            BOOST_CHECK_EQUAL( before.fibers_terminated + 10, after.fibers_terminated);
+            BOOST_CHECK( before.rounds < after.rounds);
+        } else {
+            BOOST_CHECK_EQUAL( 0u, after.fibers_created);
+            BOOST_CHECK_EQUAL( 0u, after.rounds);
+            BOOST_CHECK( std::chrono::nanoseconds::zero() == after.running_time);
+        }
+    });
+    t.join();
+}
+
+void test_timers() {
+    std::thread t( [](){
+        boost::fibers::scheduler_handle h = boost::fibers::scheduler_handle::current();
+        boost::fibers::scheduler_stats before = h.stats();
+        for ( int i = 0; i < 3; ++i) {
+            boost::this_fiber::sleep_for( std::chrono::milliseconds( 10) );
+        }
+        boost::fibers::scheduler_stats after = h.stats();
+        if ( after.enabled) {
+            BOOST_CHECK_EQUAL( before.timers_fired + 3, after.timers_fired);
+            // the thread has been parked while the main fiber slept
+            BOOST_CHECK( before.parks < after.parks);
+            BOOST_CHECK( std::chrono::milliseconds( 20) <= after.parked_time - before.parked_time);
+            BOOST_CHECK( 1. > after.utilization() );
+        } else {
+            BOOST_CHECK_EQUAL( 0u, after.timers_fired);
+            BOOST_CHECK( std::chrono::nanoseconds::zero() == after.parked_time);
+        }
+    });
+    t.join();
+}
+
+void test_remote() {
+    boost::fibers::promise< boost::fibers::scheduler_handle > ph;
+    boost::fibers::future< boost::fibers::scheduler_handle > fh = ph.get_future();
+    boost::fibers::promise< void > p;
+    boost::fibers::future< void > f = p.get_future();
+    std::thread t( [&ph,&f](){
+        ph.set_value( boost::fibers::scheduler_handle::current() );
+        f.wait();
+    });
+    boost::fibers::scheduler_handle h = fh.get();
+    std::this_thread::sleep_for( std::chrono::milliseconds( 10) );
+    boost::fibers::scheduler_stats parked = h.stats();
+    p.set_value();
+    t.join();
+    if ( parked.enabled) {
+        // read while the other thread is parked
+        BOOST_CHECK( std::chrono::milliseconds( 5) <= parked.parked_time);
+        BOOST_CHECK_EQUAL( 0u, parked.ready_fibers);
+    }
+}
+
+void test_histogram() {
+    typedef boost::fibers::latency_histogram histogram_t;
+    // the buckets are contiguous and ordered
+    for ( std::uint64_t ns = 1; ns < ( std::uint64_t{ 1 } << 36); ns = ns * 3 / 2 + 1) {
+        std::size_t idx = histogram_t::index( ns);
+        BOOST_CHECK( idx < histogram_t::buckets);
+        BOOST_CHECK( histogram_t::index( ns - 1) <= idx);
+        BOOST_CHECK( idx <= histogram_t::index( ns - 1) + 1);
+        // relative error < 1/64
+        std::uint64_t v = histogram_t::value( idx);
+        BOOST_CHECK( ( v < ns ? ns - v : v - ns) * 64 <= ns);
+    }
+    histogram_t h;
+    BOOST_CHECK( std::chrono::nanoseconds::zero() == h.p99() );
+    for ( int i = 1; i <= 1000; ++i) {
+        h.record( std::chrono::microseconds( i) );
+    }
+    BOOST_CHECK_EQUAL( 1000u, h.count() );
+    BOOST_CHECK( std::chrono::microseconds( 1000) == h.max() );
+    BOOST_CHECK( std::chrono::microseconds( 492) <= h.p50() && h.p50() <= std::chrono::microseconds( 508) );
+    BOOST_CHECK( std::chrono::microseconds( 975) <= h.p99() && h.p99() <= std::chrono::microseconds( 1000) );
+    BOOST_CHECK( h.p99() <= h.p999() && h.p999() <= h.max() );
+    histogram_t other;
+    other.record( std::chrono::seconds( 1) );
+    h.merge( other);
+    BOOST_CHECK_EQUAL( 1001u, h.count() );
+    BOOST_CHECK( std::chrono::seconds( 1) == h.max() );
+    BOOST_CHECK( std::chrono::microseconds( 1000) >= h.p99() );
+}
+
+void test_wakeup_latency() {
+    std::thread t( [](){
+        boost::fibers::scheduler_handle h = boost::fibers::scheduler_handle::current();
+        boost::fibers::buffered_channel< int > chan{ 2 };
+        boost::fibers::fiber f( [&chan](){
+            int value = 0;
+            while ( boost::fibers::channel_op_status::success == chan.pop( value) ) {
+            }
+        });
+        for ( int i = 0; i < 100; ++i) {
+            boost::this_fiber::yield();
+            chan.push( i);
+        }
+        boost::fibers::promise< void > p;
+        std::thread remote( [&p](){
+            std::this_thread::sleep_for( std::chrono::milliseconds( 1) );
+            p.set_value();
+        });
+        p.get_future().wait();
+        remote.join();
+        chan.close();
+        f.join();
+        boost::fibers::scheduler_stats s = h.stats();
+        if ( s.enabled) {
+            // f woken up by push()
+            BOOST_CHECK( 100u <= s.local_wakeup_latency.count() );
+            BOOST_CHECK( 1u <= s.remote_wakeup_latency.count() );
+            for ( boost::fibers::latency_histogram const* l : { & s.local_wakeup_latency, & s.remote_wakeup_latency }) {
+                BOOST_CHECK( l->p50() <= l->p99() );
+                BOOST_CHECK( l->p99() <= l->p999() );
+                BOOST_CHECK( l->p999() <= l->max() );
+            }
+        } else {
+            BOOST_CHECK_EQUAL( 0u, s.local_wakeup_latency.count() );
+            BOOST_CHECK_EQUAL( 0u, s.remote_wakeup_latency.count() );
+        }
+    });
+    t.join();
+}
+
+void test_footprint() {
+    // the counters and histograms are not embedded in the scheduler, they
+    // are allocated only with BOOST_FIBERS_STATS
+    BOOST_CHECK( sizeof( boost::fibers::scheduler) <
+                 boost::fibers::latency_histogram::buckets * sizeof( std::uint64_t) );
+}
+
+void test_fiber_stats() {
+    std::thread t( [](){
+        boost::fibers::fiber_stats own;
+        boost::fibers::fiber hog( [&own](){
+            // busy for ~5ms in two runs
+            for ( int i = 0; i < 2; ++i) {
+                std::chrono::steady_clock::time_point end =
+                    std::chrono::steady_clock::now() + std::chrono::microseconds( 2500);
+                while ( std::chrono::steady_clock::now() < end) {
+                }
+                boost::this_fiber::yield();
+            }
+            own = boost::this_fiber::stats();
+        });
+        boost::fibers::fiber idle( [](){
+            boost::this_fiber::yield();
+        });
+        boost::this_fiber::yield();
+        boost::fibers::fiber_stats s = hog.stats();
+        hog.join();
+        idle.join();
+        if ( own.enabled) {
+            BOOST_CHECK( s.enabled);
+            BOOST_CHECK_EQUAL( 1u, s.switches);
+            BOOST_CHECK( std::chrono::microseconds( 2000) <= s.cpu_time);
+            // resumed three times, the current run included
+            BOOST_CHECK_EQUAL( 3u, own.switches);
+            BOOST_CHECK( std::chrono::microseconds( 4000) <= own.cpu_time);
+            BOOST_CHECK( own.cpu_time < std::chrono::seconds( 5) );
+            BOOST_CHECK( s.cpu_time <= own.cpu_time);
+            BOOST_CHECK( s.ready_time <= own.ready_time);
+        } else {
+            BOOST_CHECK_EQUAL( 0u, own.switches);
+            BOOST_CHECK( std::chrono::nanoseconds::zero() == own.cpu_time);
+        }
+    });
+    t.join();
+}
+
+void test_all() {
+    std::vector< boost::fibers::scheduler_stats > all = boost::fibers::all_scheduler_stats();
+    std::thread::id id = std::this_thread::get_id();
+    BOOST_CHECK( std::any_of( all.begin(), all.end(),
+                              [id]( boost::fibers::scheduler_stats const& s){
+                                  return id == s.thread_id; }) );
+}
+
+void test_work_stealing() {
+    std::vector< boost::fibers::scheduler_stats > stats;
+    std::thread t( [&stats](){
+        boost::fibers::use_scheduling_algorithm< boost::fibers::algo::work_stealing >( 0, 0);
+        std::vector< boost::fibers::fiber > fs;
+        for ( int i = 0; i < 10; ++i) {
+            fs.emplace_back( [](){
+                boost::this_fiber::yield();
+            });
+        }
+        for ( boost::fibers::fiber & f : fs) {
+            f.join();
+        }
+        stats.push_back( boost::fibers::scheduler_handle::current().stats() );
+    });
+    t.join();
+    BOOST_REQUIRE_EQUAL( 1u, stats.size() );
+    // the only thread of the group has no victim
+    BOOST_CHECK_EQUAL( 0u, stats[0].steals);
+    BOOST_CHECK_EQUAL( 0u, stats[0].failed_steals);
+    BOOST_CHECK_EQUAL( 0u, stats[0].stolen);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: scheduler stats test suite");
+
+    test->add( BOOST_TEST_CASE( & test_enabled) );
+    test->add( BOOST_TEST_CASE( & test_fibers) );
+    test->add( BOOST_TEST_CASE( & test_timers) );
+    test->add( BOOST_TEST_CASE( & test_remote) );
+    test->add( BOOST_TEST_CASE( & test_histogram) );
+    test->add( BOOST_TEST_CASE( & test_wakeup_latency) );
+    test->add( BOOST_TEST_CASE( & test_footprint) );
+    test->add( BOOST_TEST_CASE( & test_fiber_stats) );
+    test->add( BOOST_TEST_CASE( & test_all) );
+    test->add( BOOST_TEST_CASE( & test_work_stealing) );
+
+    return test;
+}
@@ -0,0 +1,146 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+void test_submit_external() {
+    boost::fibers::sharded rt{ 2 };
+    BOOST_CHECK_EQUAL( std::size_t( 2), rt.size() );
+    BOOST_CHECK_EQUAL( boost::fibers::sharded::npos, boost::fibers::sharded::this_shard() );
+    boost::fibers::future< std::size_t > f0 = rt.submit_to( 0, [](){
+        return boost::fibers::sharded::this_shard();
+    });
+    boost::fibers::future< std::size_t > f1 = rt.submit_to( 1, [](){
+        return boost::fibers::sharded::this_shard();
+    });
+    BOOST_CHECK_EQUAL( std::size_t( 0), f0.get() );
+    BOOST_CHECK_EQUAL( std::size_t( 1), f1.get() );
+}
+
+void test_submit_cross_shard() {
+    // every shard submits to every shard
+    const std::size_t n = 3;
+    boost::fibers::sharded rt{ n, false };
+    std::vector< boost::fibers::future< std::size_t > > results;
+    for ( std::size_t i = 0; i < n; ++i) {
+        results.push_back( rt.submit_to( i, [&rt,n,i](){
+            std::vector< boost::fibers::future< std::size_t > > fs;
+            for ( std::size_t j = 0; j < n; ++j) {
+                fs.push_back( rt.submit_to( j, [i,j](){
+                    // executed on the target shard
+                    return j == boost::fibers::sharded::this_shard() ? i * 10 + j : 1000;
+                }) );
+            }
+            std::size_t sum = 0;
+            for ( boost::fibers::future< std::size_t > & f : fs) {
+                sum += f.get();
+            }
+            return sum;
+        }) );
+    }
+    for ( std::size_t i = 0; i < n; ++i) {
+        BOOST_CHECK_EQUAL( i * 10 * n + n * ( n - 1) / 2, results[i].get() );
+    }
+}
+
+void test_void_and_exception() {
+    boost::fibers::sharded rt{ 2 };
+    std::atomic< int > value{ 0 };
+    rt.submit_to( 1, [&value](){ value = 3; }).get();
+    BOOST_CHECK_EQUAL( 3, value.load() );
+    boost::fibers::future< int > f = rt.submit_to( 0, []() -> int {
+        throw std::runtime_error("abc");
+    });
+    BOOST_CHECK_THROW( f.get(), std::runtime_error);
+}
+
+void test_move_only() {
+    boost::fibers::sharded rt{ 2 };
+    boost::fibers::future< std::unique_ptr< int > > f = rt.submit_to( 1, [](){
+        return std::unique_ptr< int >{ new int( 8) };
+    });
+    std::unique_ptr< int > r = f.get();
+    BOOST_REQUIRE( r);
+    BOOST_CHECK_EQUAL( 8, * r);
+}
+
+void test_ring_full() {
+    // more messages in flight than the rings can hold
+    const std::size_t count = 1000;
+    boost::fibers::sharded rt{ 2, false, false, 4 };
+    std::size_t sum = rt.submit_to( 0, [&rt,count](){
+        std::vector< boost::fibers::future< std::size_t > > fs;
+        for ( std::size_t i = 0; i < count; ++i) {
+            fs.push_back( rt.submit_to( 1, [i](){ return i; }) );
+        }
+        std::size_t sum = 0;
+        for ( boost::fibers::future< std::size_t > & f : fs) {
+            sum += f.get();
+        }
+        return sum;
+    }).get();
+    BOOST_CHECK_EQUAL( count * ( count - 1) / 2, sum);
+}
+
+void test_busy_poll() {
+    boost::fibers::sharded rt{ 2, false, true };
+    int value = rt.submit_to( 0, [&rt](){
+        return rt.submit_to( 1, [](){ return 5; }).get();
+    }).get();
+    BOOST_CHECK_EQUAL( 5, value);
+}
+
+void test_shutdown_pending() {
+    // tasks submitted by tasks still running are completed before the
+    // shards terminate
+    std::atomic< int > done{ 0 };
+    {
+        boost::fibers::sharded rt{ 2, false };
+        rt.submit_to( 0, [&rt,&done](){
+            boost::this_fiber::sleep_for( std::chrono::milliseconds( 20) );
+            rt.submit_to( 1, [&done](){
+                boost::this_fiber::sleep_for( std::chrono::milliseconds( 20) );
+                ++done;
+            });
+            ++done;
+        });
+    }
+    BOOST_CHECK_EQUAL( 2, done.load() );
+}
+
+void test_invalid() {
+    BOOST_CHECK_THROW( boost::fibers::sharded( 0), boost::fibers::fiber_error);
+    BOOST_CHECK_THROW( boost::fibers::sharded( 2, false, false, 3), boost::fibers::fiber_error);
+    boost::fibers::sharded rt{ 1 };
+    BOOST_CHECK_THROW( rt.submit_to( 1, [](){}), boost::fibers::fiber_error);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: sharded test suite");
+
+    test->add( BOOST_TEST_CASE( & test_submit_external) );
+    test->add( BOOST_TEST_CASE( & test_submit_cross_shard) );
+    test->add( BOOST_TEST_CASE( & test_void_and_exception) );
+    test->add( BOOST_TEST_CASE( & test_move_only) );
+    test->add( BOOST_TEST_CASE( & test_ring_full) );
+    test->add( BOOST_TEST_CASE( & test_busy_poll) );
+    test->add( BOOST_TEST_CASE( & test_shutdown_pending) );
+    test->add( BOOST_TEST_CASE( & test_invalid) );
+
+    return test;
+}
@@ -0,0 +1,202 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+typedef std::chrono::steady_clock   clock_type;
+
+// runs fn in a new thread with its own (simulating) scheduler
+template< typename Fn >
+void simulate( std::uint64_t seed, Fn fn) {
+    std::thread t( [seed,&fn](){
+        boost::fibers::use_scheduling_algorithm< boost::fibers::algo::simulation >( seed);
+        fn();
+    });
+    t.join();
+}
+
+void test_sleep() {
+    clock_type::time_point real = clock_type::now();
+    clock_type::duration elapsed{ 0 };
+    simulate( 0, [&elapsed](){
+        clock_type::time_point start = boost::fibers::now();
+        boost::fibers::fiber f( [](){
+            boost::this_fiber::sleep_for( std::chrono::hours( 2) );
+        });
+        boost::this_fiber::sleep_for( std::chrono::hours( 1) );
+        BOOST_CHECK( std::chrono::hours( 1) == boost::fibers::now() - start);
+        f.join();
+        elapsed = boost::fibers::now() - start;
+    });
+    BOOST_CHECK( std::chrono::hours( 2) == elapsed);
+    BOOST_CHECK( std::chrono::seconds( 10) > clock_type::now() - real);
+}
+
+void test_deadline_order() {
+    std::vector< int > order;
+    simulate( 7, [&order](){
+        std::vector< boost::fibers::fiber > fs;
+        for ( int i = 5; i > 0; --i) {
+            fs.emplace_back( [i,&order](){
+                boost::this_fiber::sleep_for( std::chrono::minutes( i) );
+                order.push_back( i);
+            });
+        }
+        for ( boost::fibers::fiber & f : fs) {
+            f.join();
+        }
+    });
+    BOOST_CHECK( ( std::vector< int >{ 1, 2, 3, 4, 5 }) == order);
+}
+
+void test_timeouts() {
+    simulate( 0, [](){
+        clock_type::time_point start = boost::fibers::now();
+        boost::fibers::mutex mtx;
+        boost::fibers::condition_variable cnd;
+        std::unique_lock< boost::fibers::mutex > lk( mtx);
+        BOOST_CHECK( boost::fibers::cv_status::timeout == cnd.wait_for( lk, std::chrono::minutes( 30) ) );
+        lk.unlock();
+        boost::fibers::buffered_channel< int > chan{ 2 };
+        int value = 0;
+        BOOST_CHECK( boost::fibers::channel_op_status::timeout ==
+                     chan.pop_wait_for( value, std::chrono::minutes( 30) ) );
+        boost::fibers::timed_mutex tmtx;
+        tmtx.lock();
+        boost::fibers::fiber f( [&tmtx](){
+            BOOST_CHECK( ! tmtx.try_lock_for( std::chrono::minutes( 30) ) );
+        });
+        f.join();
+        tmtx.unlock();
+        BOOST_CHECK( std::chrono::minutes( 90) == boost::fibers::now() - start);
+    });
+}
+
+void test_notify_before_deadline() {
+    simulate( 0, [](){
+        clock_type::time_point start = boost::fibers::now();
+        boost::fibers::promise< void > p;
+        boost::fibers::future< void > fu = p.get_future();
+        boost::fibers::fiber f( [&p](){
+            boost::this_fiber::sleep_for( std::chrono::seconds( 5) );
+            p.set_value();
+        });
+        BOOST_CHECK( boost::fibers::future_status::ready == fu.wait_for( std::chrono::hours( 1) ) );
+        BOOST_CHECK( std::chrono::seconds( 5) == boost::fibers::now() - start);
+        f.join();
+    });
+}
+
+void test_computation_takes_no_time() {
+    simulate( 0, [](){
+        clock_type::time_point start = boost::fibers::now();
+        for ( int i = 0; i < 100; ++i) {
+            boost::this_fiber::yield();
+        }
+        BOOST_CHECK( start == boost::fibers::now() );
+    });
+}
+
+void test_advance() {
+    simulate( 0, [](){
+        boost::fibers::algo::simulation algo{ 0 };
+        clock_type::time_point start = algo.now();
+        algo.advance( std::chrono::minutes( 3) );
+        BOOST_CHECK( std::chrono::minutes( 3) == algo.now() - start);
+    });
+}
+
+std::string trace( std::uint64_t seed) {
+    std::string result;
+    simulate( seed, [&result](){
+        std::vector< boost::fibers::fiber > fs;
+        for ( char c = 'a'; c < 'f'; ++c) {
+            fs.emplace_back( [c,&result](){
+                for ( int i = 0; i < 4; ++i) {
+                    result.push_back( c);
+                    boost::this_fiber::yield();
+                }
+            });
+        }
+        for ( boost::fibers::fiber & f : fs) {
+            f.join();
+        }
+    });
+    return result;
+}
+
+void test_deterministic() {
+    // a seed reproduces the order of execution
+    for ( std::uint64_t seed = 0; seed < 8; ++seed) {
+        BOOST_CHECK_EQUAL( trace( seed), trace( seed) );
+    }
+    // different seeds give different orders
+    bool differs = false;
+    for ( std::uint64_t seed = 1; seed < 8; ++seed) {
+        if ( trace( 0) != trace( seed) ) {
+            differs = true;
+        }
+    }
+    BOOST_CHECK( differs);
+}
+
+void test_remote_wakeup() {
+    // fibers blocked without a deadline wait for other threads
+    simulate( 0, [](){
+        boost::fibers::promise< int > p;
+        boost::fibers::future< int > f = p.get_future();
+        std::thread t( [&p](){
+            std::this_thread::sleep_for( std::chrono::milliseconds( 10) );
+            p.set_value( 3);
+        });
+        BOOST_CHECK_EQUAL( 3, f.get() );
+        t.join();
+    });
+}
+
+void test_many_ready() {
+    // more ready fibers than a preallocated queue would hold
+    std::size_t done = 0;
+    simulate( 3, [&done](){
+        std::vector< boost::fibers::fiber > fs;
+        for ( int i = 0; i < 4096; ++i) {
+            fs.emplace_back( [&done](){
+                boost::this_fiber::yield();
+                ++done;
+            });
+        }
+        for ( boost::fibers::fiber & f : fs) {
+            f.join();
+        }
+    });
+    BOOST_CHECK_EQUAL( 4096u, done);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: simulation test suite");
+
+    test->add( BOOST_TEST_CASE( & test_sleep) );
+    test->add( BOOST_TEST_CASE( & test_deadline_order) );
+    test->add( BOOST_TEST_CASE( & test_timeouts) );
+    test->add( BOOST_TEST_CASE( & test_notify_before_deadline) );
+    test->add( BOOST_TEST_CASE( & test_computation_takes_no_time) );
+    test->add( BOOST_TEST_CASE( & test_advance) );
+    test->add( BOOST_TEST_CASE( & test_deterministic) );
+    test->add( BOOST_TEST_CASE( & test_remote_wakeup) );
+    test->add( BOOST_TEST_CASE( & test_many_ready) );
+
+    return test;
+}
@@ -0,0 +1,118 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+void ping_pong() {
+    boost::fibers::buffered_channel< int > ping{ 2 }, pong{ 2 };
+    boost::fibers::fiber f( [&ping,&pong](){
+        int value = 0;
+        while ( boost::fibers::channel_op_status::success == ping.pop( value) ) {
+            pong.push( value);
+        }
+        pong.close();
+    });
+    for ( int i = 0; i < 10; ++i) {
+        int value = 0;
+        ping.push( i);
+        pong.pop( value);
+    }
+    ping.close();
+    f.join();
+}
+
+void test_empty() {
+    boost::fibers::tracer t;
+    BOOST_CHECK_EQUAL( 0u, t.size() );
+    std::ostringstream os;
+    t.write( os);
+    BOOST_CHECK( 0 == os.str().find("{\"traceEvents\":[") );
+    BOOST_CHECK( std::string::npos == os.str().find("\"ph\"") );
+}
+
+void test_trace() {
+    boost::fibers::tracer t;
+    t.start();
+    ping_pong();
+    t.stop();
+    // events are recorded only if the library is built with BOOST_FIBERS_HOOKS
+#if defined(BOOST_FIBERS_HOOKS)
+    BOOST_REQUIRE( 0 < t.size() );
+#else
+    if ( 0 == t.size() ) {
+        return;
+    }
+#endif
+    BOOST_CHECK_EQUAL( 0u, t.overwritten() );
+    std::ostringstream os;
+    t.write( os);
+    std::string json = os.str();
+    BOOST_CHECK( std::string::npos != json.find("\"name\":\"thread_name\"") );
+    BOOST_CHECK( std::string::npos != json.find("\"name\":\"thread 0\"") );
+    BOOST_CHECK( std::string::npos != json.find("\"name\":\"blocked: channel_pop\"") );
+    BOOST_CHECK( std::string::npos != json.find("\"name\":\"blocked: join\"") );
+    // wake chains
+    BOOST_CHECK( std::string::npos != json.find("{\"ph\":\"s\"") );
+    BOOST_CHECK( std::string::npos != json.find("{\"ph\":\"f\"") );
+    // no further events after stop()
+    std::size_t size = t.size();
+    ping_pong();
+    BOOST_CHECK_EQUAL( size, t.size() );
+}
+
+void test_threads() {
+    boost::fibers::tracer t;
+    t.start();
+    std::vector< std::thread > threads;
+    for ( int i = 0; i < 3; ++i) {
+        threads.emplace_back( ping_pong);
+    }
+    for ( std::thread & thrd : threads) {
+        thrd.join();
+    }
+    t.stop();
+    if ( 0 == t.size() ) {
+        return;
+    }
+    std::ostringstream os;
+    t.write( os);
+    for ( char const* name : { "\"name\":\"thread 0\"", "\"name\":\"thread 1\"", "\"name\":\"thread 2\"" }) {
+        BOOST_CHECK( std::string::npos != os.str().find( name) );
+    }
+}
+
+void test_overwrite() {
+    boost::fibers::tracer t{ 16 };
+    t.start();
+    ping_pong();
+    t.stop();
+    if ( 0 == t.size() ) {
+        return;
+    }
+    BOOST_CHECK_EQUAL( t.size() - 16, t.overwritten() );
+    std::ostringstream os;
+    t.write( os);
+    BOOST_CHECK( std::string::npos != os.str().find("\"ph\":\"X\"") );
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: tracer test suite");
+
+    test->add( BOOST_TEST_CASE( & test_empty) );
+    test->add( BOOST_TEST_CASE( & test_trace) );
+    test->add( BOOST_TEST_CASE( & test_threads) );
+    test->add( BOOST_TEST_CASE( & test_overwrite) );
+
+    return test;
+}